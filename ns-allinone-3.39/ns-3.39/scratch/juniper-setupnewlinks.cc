@@ -101,6 +101,11 @@
             // Don't close the file here; it will be automatically closed in the destructor
         }
 
+        void TxTracerPlane(Ptr<const Packet> pkt, uint8_t plane) {
+            std::ofstream& file = plane == OfhFleetApplication::U_PLANE ? TxFileUser : TxFileControl;
+            file << pkt->GetUid() << " " << Simulator::Now().GetFemtoSeconds() << " " << pkt->GetSize() <<std::endl;
+        }
+
 
     private:
         std::ofstream TxFileUser;
@@ -112,6 +117,11 @@
        
     };
 
+    // Dispatch the packets of a fleet of RUs to the tracer of their RU
+    void FleetTxTracer(std::vector<std::unique_ptr<TxTracerHelper>>* tracers, Ptr<const Packet> pkt, uint32_t ru, uint8_t plane) {
+        (*tracers)[ru]->TxTracerPlane(pkt, plane);
+    }
+
     // Function to print total received bytes
     void PrintTotalRx(Ptr<PacketSink> serverSink) {
         std::cout << MAGENTA << "INFO: " << RESET << "Sink: Total RX - " << serverSink->GetTotalRx() << " bytes in t = " << Simulator::Now().GetSeconds() << std::endl;
@@ -119,6 +129,32 @@
     }
 
 
+    // Function to convert a JSON HQoS tree into the Tree attribute of HqosQueueDisc
+    std::string HqosTreeSpec(const json& node) {
+        std::string type = node.at("type");
+        std::string spec = type + "(";
+        if (type == "leaf") {
+            for (const auto& dscp : node.value("dscp", json::array())) {
+                spec += std::to_string(dscp.get<int>()) + " ";
+            }
+            if (node.value("default", false)) {
+                spec += "* ";
+            }
+        } else {
+            if (type == "shaper") {
+                spec += node.at("rate").get<std::string>() + " " + std::to_string(node.at("burst").get<int>()) + " ";
+            }
+            for (const auto& child : node.at("children")) {
+                if (type == "wdrr" || type == "wfq") {
+                    spec += std::to_string(child.at("weight").get<int>()) + ":";
+                }
+                spec += HqosTreeSpec(child) + " ";
+            }
+        }
+        return spec + ")";
+    }
+
+
     int
     main(int argc, char* argv[])
     {
@@ -225,6 +261,10 @@
 
 
 
+        // Binary log of the scheduler decisions, off unless SchedLogSampling > 0
+        Ptr<SchedulingDecisionLogger> schedLogger;
+        QueueDiscContainer hqosQdiscs; // the queue discs whose statistics are saved at the end
+
         if(enablehqos){
 
             //// MARKING 
@@ -238,17 +278,37 @@
             // tch1.Install(R4R9.Get(0));
 
             //// Policies
-            TrafficControlHelper tch2;
-            // Set up the root queue disc with PrioQueueDisc
-            uint16_t rootHandle = tch2.SetRootQueueDisc("ns3::PrioQueueDscpDisc");
-            // Get ClassIdList for the second-level queues
-            TrafficControlHelper::ClassIdList cid = tch2.AddQueueDiscClasses(rootHandle, 2, "ns3::QueueDiscClass");
-            tch2.AddChildQueueDisc(rootHandle, cid[0], "ns3::FifoQueueDisc");
-            std::string qsd_type = data.at("QSD");
-            qsd_type.erase(std::remove(qsd_type.begin(), qsd_type.end(), '"'), qsd_type.end()); // Remove double quotes
-            tch2.AddChildQueueDisc(rootHandle, cid[1], "ns3::"+ qsd_type + "QueueDisc", "Quantum", StringValue(data.at("Weights")), "MapQueue", StringValue(data.at("MapQueue")));
-            // tch2.AddChildQueueDisc(rootHandle, cid[1], "ns3::WfqQueueDisc", "Quantum", StringValue(data.at("Weights")), "MapQueue", StringValue(data.at()));
-            tch2.Install(R1R2.Get(0));
+            if (data.contains("HqosTree")) {
+                // The whole hierarchy as a single queue disc
+                std::string tree = HqosTreeSpec(data.at("HqosTree"));
+                std::cout << MAGENTA << "INFO: " << RESET << "HQoS tree: " << tree << std::endl;
+                TrafficControlHelper tchHqos;
+                tchHqos.SetRootQueueDisc("ns3::HqosQueueDisc", "Tree", StringValue(tree));
+                hqosQdiscs = tchHqos.Install(R1R2.Get(0));
+            } else {
+                TrafficControlHelper tch2;
+                // Set up the root queue disc with PrioQueueDisc
+                uint16_t rootHandle = tch2.SetRootQueueDisc("ns3::PrioQueueDscpDisc");
+                // Get ClassIdList for the second-level queues
+                TrafficControlHelper::ClassIdList cid = tch2.AddQueueDiscClasses(rootHandle, 2, "ns3::QueueDiscClass");
+                tch2.AddChildQueueDisc(rootHandle, cid[0], "ns3::FifoQueueDisc");
+                std::string qsd_type = data.at("QSD");
+                qsd_type.erase(std::remove(qsd_type.begin(), qsd_type.end(), '"'), qsd_type.end()); // Remove double quotes
+                tch2.AddChildQueueDisc(rootHandle, cid[1], "ns3::"+ qsd_type + "QueueDisc", "Quantum", StringValue(data.at("Weights")), "MapQueue", StringValue(data.at("MapQueue")));
+                // tch2.AddChildQueueDisc(rootHandle, cid[1], "ns3::WfqQueueDisc", "Quantum", StringValue(data.at("Weights")), "MapQueue", StringValue(data.at()));
+                QueueDiscContainer qdiscs = tch2.Install(R1R2.Get(0));
+                hqosQdiscs.Add(qdiscs.Get(0));
+                hqosQdiscs.Add(qdiscs.Get(0)->GetQueueDiscClass(1)->GetQueueDisc());
+
+                uint32_t schedLogSampling = data.value("SchedLogSampling", 0);
+                if (schedLogSampling > 0)
+                {
+                    schedLogger = CreateObjectWithAttributes<SchedulingDecisionLogger>(
+                        "FileName", StringValue(resultsPathname + "sched-decision.bin"),
+                        "SamplingInterval", UintegerValue(schedLogSampling));
+                    schedLogger->ConnectQueueDisc(qdiscs.Get(0)->GetQueueDiscClass(1)->GetQueueDisc());
+                }
+            }
 
         }
 
@@ -295,6 +355,15 @@
        double time_ia = double(1)/((double(data.at("URatenum"))*double(1e9)/double(8))/double(data.at("RuFeatures")[0]["UPacketSize"]));
        double sep_app = time_ia/double(data.at("NumRuflows"));
        // std::cout << sep_app << std::endl;
+       // "Fleet" drives all the RUs from one OfhFleetApplication instead of one OfhApplication each
+       bool useFleet = data.value("Fleet", false);
+       NS_ABORT_MSG_IF(useFleet && data.at("Poisson"), "The RU fleet only supports constant On/Off times");
+       Ptr<OfhFleetApplication> fleet;
+       if (useFleet){
+            fleet = CreateObject<OfhFleetApplication>();
+            nodes.Get(3)->AddApplication(fleet);
+            Client_app.Add(fleet);
+       }
        for (int i = 0; i < num_RU; i++){
             // Create a packet sink on the end of the chain
             InetSocketAddress Server_Address(InetSocketAddress("10.0.5.2", port1 + i));
@@ -304,6 +373,25 @@
             PacketSinkHelper packetSinkHelper2("ns3::UdpSocketFactory", Address(Server_Address2));  
             Server_app.Add(packetSinkHelper.Install(nodes.Get(6))); // Last node server
             Server_app.Add(packetSinkHelper2.Install(nodes.Get(6))); // Last node server
+            if (useFleet){
+                const json& ru = data.at("RuFeatures")[i];
+                OfhFleetApplication::PlaneConfig uPlane;
+                uPlane.peer = Server_Address;
+                uPlane.rate = DataRate(std::string(ru["URate"]));
+                uPlane.packetSize = ru["UPacketSize"];
+                uPlane.maxBytes = ru["UMaxBytes"];
+                uPlane.onTime = Seconds(double(ru["UOnTime"]));
+                uPlane.offTime = Seconds(double(ru["UOffTime"]));
+                OfhFleetApplication::PlaneConfig cPlane;
+                cPlane.peer = Server_Address2;
+                cPlane.rate = DataRate(std::string(ru["CRate"]));
+                cPlane.packetSize = ru["CPacketSize"];
+                cPlane.maxBytes = ru["CMaxBytes"];
+                cPlane.onTime = Seconds(double(ru["COnTime"]));
+                cPlane.offTime = Seconds(double(ru["COffTime"]));
+                fleet->AddRu(uPlane, cPlane, NanoSeconds(sep_app*double(i)));
+                continue;
+            }
             // Create the Ofh APP to send TCP to the server
             OfhHelper clientHelper("ns3::UdpSocketFactory");
             clientHelper.SetAttribute("U-Plane",AddressValue(Server_Address));
@@ -366,10 +454,15 @@
         
         if (enabletracing){
         
+            if (useFleet){
+                fleet->TraceConnectWithoutContext("TxWithRu", MakeBoundCallback(&FleetTxTracer, &txTracersRU));
+            }
             for (int i = 0; i < num_RU; ++i) {
+                if (!useFleet){
                     // Construct the callback paths
                     std::string txCallbackPath = "/NodeList/3/ApplicationList/" + std::to_string(i) + "/$ns3::OfhApplication/TxWithAddresses";
                     Config::ConnectWithoutContext(txCallbackPath, MakeCallback(&TxTracerHelper::TxTracer, txTracersRU[i].get()));
+                }
                 for (int j = 0; j < 2; ++j) {
                     std::string rxCallbackPath = "/NodeList/6/ApplicationList/" + std::to_string(i * 2 + j) + "/$ns3::PacketSink/Rx";
                     // Connect the RxTracerHelper callback
@@ -416,6 +509,20 @@
         Simulator::Stop(Seconds(data.at("Seconds_sim")));
         Simulator::Schedule(Seconds(0.001), &PrintTotalRx, Server_trace1);
         Simulator::Run();
+        if (hqosQdiscs.GetN() > 0)
+        {
+            // per class sojourn times, instead of matching the Tx/Rx logs afterwards
+            std::ofstream statsFile(resultsPathname + "queue-disc-stats.txt");
+            for (uint32_t i = 0; i < hqosQdiscs.GetN(); i++)
+            {
+                statsFile << hqosQdiscs.Get(i)->GetInstanceTypeId().GetName()
+                          << hqosQdiscs.Get(i)->GetStats() << std::endl;
+            }
+        }
+        if (schedLogger)
+        {
+            schedLogger->Dispose();
+        }
         Simulator::Destroy();
         
         std::cout << GREEN << "Simulation has finished" <<  RESET << std::endl;
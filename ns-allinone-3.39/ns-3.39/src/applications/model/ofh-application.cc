@@ -31,6 +31,7 @@
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/nstime.h"
+#include "ns3/ofh-timing-header.h"
 #include "ns3/packet-socket-address.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
@@ -43,6 +44,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -141,6 +144,61 @@ OfhApplication::GetTypeId()
                           MakeTypeIdAccessor(&OfhApplication::m_tid),
                           // This should check for SocketFactory as a parent
                           MakeTypeIdChecker())
+            .AddAttribute("SymbolAligned",
+                          "Send one burst of packets per symbol instead of CBR traffic",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OfhApplication::m_symbolAligned),
+                          MakeBooleanChecker())
+            .AddAttribute("Numerology",
+                          "The numerology (mu) of the symbol grid: a slot lasts 1 ms / 2^mu",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&OfhApplication::m_numerology),
+                          MakeUintegerChecker<uint32_t>(0, 6))
+            .AddAttribute("SymbolsPerSlot",
+                          "The number of symbols per slot",
+                          UintegerValue(14),
+                          MakeUintegerAccessor(&OfhApplication::m_symbolsPerSlot),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Prbs",
+                          "The number of PRBs carried by a U-plane burst, used when "
+                          "U-PacketsPerSymbol is zero",
+                          UintegerValue(273),
+                          MakeUintegerAccessor(&OfhApplication::m_prbs),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("U-PacketsPerSymbol",
+                          "The number of U-plane packets per symbol. The value zero means "
+                          "enough packets to carry the 16-bit IQ samples of the PRBs",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&OfhApplication::m_u_pktsPerSymbol),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("C-PacketsPerSymbol",
+                          "The number of C-plane packets per symbol",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&OfhApplication::m_c_pktsPerSymbol),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("C-Advance",
+                          "The time a C-plane burst is sent ahead of the U-plane burst "
+                          "of the same symbol",
+                          TimeValue(MicroSeconds(125)),
+                          MakeTimeAccessor(&OfhApplication::m_c_advance),
+                          MakeTimeChecker(Time(0)))
+            .AddAttribute("PrototypePackets",
+                          "Send copies of a prototype payload, built once per plane, instead of "
+                          "creating every packet. The copies share the uid of their prototype",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OfhApplication::m_prototypePackets),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableTimingHeader",
+                          "Stamp every packet with an OfhTimingHeader, carrying RuId, the "
+                          "plane and the symbol time of the packet",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OfhApplication::m_enableTimingHeader),
+                          MakeBooleanChecker())
+            .AddAttribute("RuId",
+                          "The radio unit identifier carried by the OfhTimingHeader",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&OfhApplication::m_ruId),
+                          MakeUintegerChecker<uint16_t>())
             .AddAttribute("EnableSeqTsSizeHeader",
                           "Enable use of SeqTsSizeHeader for sequence number and timestamp",
                           BooleanValue(false),
@@ -173,7 +231,10 @@ OfhApplication::OfhApplication()
       m_c_residualBits(0),
       m_c_lastStartTime(Seconds(0)),
       m_c_totBytes(0),
-      m_c_unsentPacket(nullptr)
+      m_c_unsentPacket(nullptr),
+      m_u_burstSize(0),
+      m_u_symbol(0),
+      m_c_symbol(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -217,6 +278,8 @@ OfhApplication::UserDoDispose()
     UserCancelEvents();
     m_u_socket = nullptr;
     m_u_unsentPacket = nullptr;
+    m_u_prototype = nullptr;
+    m_c_prototype = nullptr;
     // chain up
     Application::DoDispose();
 }
@@ -229,6 +292,8 @@ OfhApplication::ControlDoDispose()
     ControlCancelEvents();
     m_u_socket = nullptr;
     m_u_unsentPacket = nullptr;
+    m_u_prototype = nullptr;
+    m_c_prototype = nullptr;
     // chain up
     Application::DoDispose();
 }
@@ -323,6 +388,24 @@ OfhApplication::StartApplication() // Called at time specified by Start
     m_u_cbrRateFailSafe = m_u_cbrRate;
     m_c_cbrRateFailSafe = m_c_cbrRate;
 
+    // The symbol grid starts with the C-plane burst of symbol 0
+    m_u_symbolOrigin = Simulator::Now() + m_c_advance;
+    m_u_symbol = 0;
+    m_c_symbol = 0;
+    // 12 subcarriers per PRB, 16-bit I and Q samples
+    m_u_burstSize = m_u_pktsPerSymbol ? m_u_pktsPerSymbol
+                                      : (m_prbs * 12 * 4 + m_u_pktSize - 1) / m_u_pktSize;
+
+    // The payloads are constant, build them once and send copies of them
+    m_u_prototype = nullptr;
+    m_c_prototype = nullptr;
+    NS_ABORT_IF(m_u_pktSize < GetHeadersSize() || m_c_pktSize < GetHeadersSize());
+    if (m_prototypePackets)
+    {
+        m_u_prototype = Create<Packet>(m_u_pktSize - GetHeadersSize());
+        m_c_prototype = Create<Packet>(m_c_pktSize - GetHeadersSize());
+    }
+
     // Ensure no pending event
     UserCancelEvents();
     ControlCancelEvents();
@@ -364,7 +447,7 @@ OfhApplication::UserCancelEvents()
 {
     NS_LOG_FUNCTION(this);
 
-    if (m_u_sendEvent.IsRunning() && m_u_cbrRateFailSafe == m_u_cbrRate)
+    if (m_u_sendEvent.IsRunning() && m_u_cbrRateFailSafe == m_u_cbrRate && !m_symbolAligned)
     { // Cancel the pending send packet event
         // Calculate residual bits since last packet sent
         Time delta(Simulator::Now() - m_u_lastStartTime);
@@ -410,6 +493,14 @@ OfhApplication::UserScheduleNextTx()
 
     if (m_u_maxBytes == 0 || m_u_totBytes < m_u_maxBytes)
     {
+        if (m_symbolAligned)
+        {
+            m_u_symbol = std::max(m_u_symbol, GetNextSymbol(m_u_symbolOrigin));
+            Time nextTime = m_u_symbolOrigin + GetSymbolOffset(m_u_symbol) - Simulator::Now();
+            NS_LOG_LOGIC("symbol " << m_u_symbol << " at " << nextTime.As(Time::S));
+            m_u_sendEvent = Simulator::Schedule(nextTime, &OfhApplication::UserSendBurst, this);
+            return;
+        }
         NS_ABORT_MSG_IF(m_u_residualBits > m_u_pktSize * 8,
                         "Calculation to compute next send time will overflow");
         uint32_t bits = m_u_pktSize * 8 - m_u_residualBits;
@@ -454,29 +545,70 @@ OfhApplication::UserSendPacket()
 
     NS_ASSERT(m_u_sendEvent.IsExpired());
 
+    UserTransmit();
+    m_u_residualBits = 0;
+    m_u_lastStartTime = Simulator::Now();
+    UserScheduleNextTx();
+}
+
+void
+OfhApplication::UserSendBurst()
+{
+    NS_LOG_FUNCTION(this);
+
+    NS_ASSERT(m_u_sendEvent.IsExpired());
+
+    uint32_t burstSize = m_u_burstSize;
+    NS_LOG_LOGIC("U-plane burst of symbol " << m_u_symbol << ": " << burstSize << " packets");
+    for (uint32_t i = 0; i < burstSize; i++)
+    {
+        // stop at the byte limit or when the socket cannot take more packets
+        if ((m_u_maxBytes > 0 && m_u_totBytes >= m_u_maxBytes) || !UserTransmit())
+        {
+            break;
+        }
+    }
+    m_u_symbol++;
+    UserScheduleNextTx();
+}
+
+bool
+OfhApplication::UserTransmit()
+{
+    NS_LOG_FUNCTION(this);
+
     Ptr<Packet> packet;
     if (m_u_unsentPacket)
     {
         packet = m_u_unsentPacket;
     }
-    else if (m_enableSeqTsSizeHeader)
-    {
-        Address from;
-        Address to;
-        m_u_socket->GetSockName(from);
-        m_u_socket->GetPeerName(to);
-        SeqTsSizeHeader header;
-        header.SetSeq(m_u_seq++);
-        header.SetSize(m_u_pktSize);
-        NS_ABORT_IF(m_u_pktSize < header.GetSerializedSize());
-        packet = Create<Packet>(m_u_pktSize - header.GetSerializedSize());
-        // Trace before adding header, for consistency with PacketSink
-        m_txTraceWithSeqTsSize(packet, from, to, header);
-        packet->AddHeader(header);
-    }
     else
     {
-        packet = Create<Packet>(m_u_pktSize);
+        packet = m_u_prototype ? m_u_prototype->Copy()
+                               : Create<Packet>(m_u_pktSize - GetHeadersSize());
+        if (m_enableSeqTsSizeHeader)
+        {
+            Address from;
+            Address to;
+            m_u_socket->GetSockName(from);
+            m_u_socket->GetPeerName(to);
+            SeqTsSizeHeader header;
+            header.SetSeq(m_u_seq++);
+            header.SetSize(m_u_pktSize);
+            // Trace before adding header, for consistency with PacketSink
+            m_txTraceWithSeqTsSize(packet, from, to, header);
+            packet->AddHeader(header);
+        }
+        if (m_enableTimingHeader)
+        {
+            // a burst carries its symbol, a CBR packet the time it is sent
+            OfhTimingHeader timing;
+            timing.SetRu(m_ruId);
+            timing.SetPlane(OfhTimingHeader::U_PLANE);
+            timing.SetSymbolTime(m_symbolAligned ? m_u_symbolOrigin + GetSymbolOffset(m_u_symbol)
+                                                 : Simulator::Now());
+            packet->AddHeader(timing);
+        }
     }
 
     int actual = m_u_socket->Send(packet);
@@ -511,10 +643,39 @@ OfhApplication::UserSendPacket()
         NS_LOG_DEBUG("Unable to send packet; actual " << actual << " size " << m_u_pktSize
                                                       << "; caching for later attempt");
         m_u_unsentPacket = packet;
+        return false;
     }
-    m_u_residualBits = 0;
-    m_u_lastStartTime = Simulator::Now();
-    UserScheduleNextTx();
+    return true;
+}
+
+uint32_t
+OfhApplication::GetHeadersSize() const
+{
+    return (m_enableSeqTsSizeHeader ? SeqTsSizeHeader().GetSerializedSize() : 0) +
+           (m_enableTimingHeader ? OfhTimingHeader().GetSerializedSize() : 0);
+}
+
+Time
+OfhApplication::GetSymbolOffset(uint64_t symbol) const
+{
+    // symbols are spread over the slot to the nanosecond, so the grid does not drift
+    int64_t slotNs = 1000000 >> m_numerology;
+    return NanoSeconds((symbol / m_symbolsPerSlot) * slotNs +
+                       (symbol % m_symbolsPerSlot) * slotNs / m_symbolsPerSlot);
+}
+
+uint64_t
+OfhApplication::GetNextSymbol(Time origin) const
+{
+    int64_t elapsed = (Simulator::Now() - origin).GetNanoSeconds();
+    if (elapsed <= 0)
+    {
+        return 0;
+    }
+    int64_t slotNs = 1000000 >> m_numerology;
+    int64_t within = elapsed % slotNs;
+    return (elapsed / slotNs) * m_symbolsPerSlot +
+           (within * m_symbolsPerSlot + slotNs - 1) / slotNs;
 }
 
 void
@@ -555,7 +716,7 @@ OfhApplication::ControlCancelEvents()
 {
     NS_LOG_FUNCTION(this);
 
-    if (m_c_sendEvent.IsRunning() && m_c_cbrRateFailSafe == m_c_cbrRate)
+    if (m_c_sendEvent.IsRunning() && m_c_cbrRateFailSafe == m_c_cbrRate && !m_symbolAligned)
     { // Cancel the pending send packet event
         // Calculate residual bits since last packet sent
         Time delta(Simulator::Now() - m_c_lastStartTime);
@@ -601,6 +762,15 @@ OfhApplication::ControlScheduleNextTx()
 
     if (m_c_maxBytes == 0 || m_c_totBytes < m_c_maxBytes || tx_finished == false)
     {
+        if (m_symbolAligned)
+        {
+            Time origin = m_u_symbolOrigin - m_c_advance;
+            m_c_symbol = std::max(m_c_symbol, GetNextSymbol(origin));
+            Time nextTime = origin + GetSymbolOffset(m_c_symbol) - Simulator::Now();
+            NS_LOG_LOGIC("symbol " << m_c_symbol << " at " << nextTime.As(Time::S));
+            m_c_sendEvent = Simulator::Schedule(nextTime, &OfhApplication::ControlSendBurst, this);
+            return;
+        }
         NS_ABORT_MSG_IF(m_c_residualBits > m_c_pktSize * 8,
                         "Calculation to compute next send time will overflow");
         uint32_t bits = m_c_pktSize * 8 - m_c_residualBits;
@@ -643,29 +813,70 @@ OfhApplication::ControlSendPacket()
 
     NS_ASSERT(m_c_sendEvent.IsExpired());
 
+    ControlTransmit();
+    m_c_residualBits = 0;
+    m_c_lastStartTime = Simulator::Now();
+    ControlScheduleNextTx();
+}
+
+void
+OfhApplication::ControlSendBurst()
+{
+    NS_LOG_FUNCTION(this);
+
+    NS_ASSERT(m_c_sendEvent.IsExpired());
+
+    uint32_t burstSize = m_c_pktsPerSymbol;
+    NS_LOG_LOGIC("C-plane burst of symbol " << m_c_symbol << ": " << burstSize << " packets");
+    for (uint32_t i = 0; i < burstSize; i++)
+    {
+        // stop at the byte limit or when the socket cannot take more packets
+        if ((m_c_maxBytes > 0 && m_c_totBytes >= m_c_maxBytes) || !ControlTransmit())
+        {
+            break;
+        }
+    }
+    m_c_symbol++;
+    ControlScheduleNextTx();
+}
+
+bool
+OfhApplication::ControlTransmit()
+{
+    NS_LOG_FUNCTION(this);
+
     Ptr<Packet> packet;
     if (m_c_unsentPacket)
     {
         packet = m_c_unsentPacket;
     }
-    else if (m_enableSeqTsSizeHeader)
-    {
-        Address from;
-        Address to;
-        m_c_socket->GetSockName(from);
-        m_c_socket->GetPeerName(to);
-        SeqTsSizeHeader header;
-        header.SetSeq(m_c_seq++);
-        header.SetSize(m_c_pktSize);
-        NS_ABORT_IF(m_c_pktSize < header.GetSerializedSize());
-        packet = Create<Packet>(m_c_pktSize - header.GetSerializedSize());
-        // Trace before adding header, for consistency with PacketSink
-        m_txTraceWithSeqTsSize(packet, from, to, header);
-        packet->AddHeader(header);
-    }
     else
     {
-        packet = Create<Packet>(m_c_pktSize);
+        packet = m_c_prototype ? m_c_prototype->Copy()
+                               : Create<Packet>(m_c_pktSize - GetHeadersSize());
+        if (m_enableSeqTsSizeHeader)
+        {
+            Address from;
+            Address to;
+            m_c_socket->GetSockName(from);
+            m_c_socket->GetPeerName(to);
+            SeqTsSizeHeader header;
+            header.SetSeq(m_c_seq++);
+            header.SetSize(m_c_pktSize);
+            // Trace before adding header, for consistency with PacketSink
+            m_txTraceWithSeqTsSize(packet, from, to, header);
+            packet->AddHeader(header);
+        }
+        if (m_enableTimingHeader)
+        {
+            // a burst carries its symbol, a CBR packet the time it is sent
+            OfhTimingHeader timing;
+            timing.SetRu(m_ruId);
+            timing.SetPlane(OfhTimingHeader::C_PLANE);
+            timing.SetSymbolTime(m_symbolAligned ? m_u_symbolOrigin + GetSymbolOffset(m_c_symbol)
+                                                 : Simulator::Now());
+            packet->AddHeader(timing);
+        }
     }
 
     int actual = m_c_socket->Send(packet);
@@ -700,10 +911,9 @@ OfhApplication::ControlSendPacket()
         NS_LOG_DEBUG("Unable to send packet; actual " << actual << " size " << m_c_pktSize
                                                       << "; caching for later attempt");
         m_c_unsentPacket = packet;
+        return false;
     }
-    m_c_residualBits = 0;
-    m_c_lastStartTime = Simulator::Now();
-    ControlScheduleNextTx();
+    return true;
 }
 
 void
@@ -28,6 +28,7 @@
 #include "ns3/application.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
+#include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/seq-ts-size-header.h"
 #include "ns3/traced-callback.h"
@@ -91,6 +92,28 @@ class Socket;
  * (enable its "EnableSeqTsSizeHeader" attribute), or users may extract
  * the header via trace sources.  Note that the continuity of the sequence
  * number may be disrupted across On/Off cycles.
+ *
+ * If the attribute "SymbolAligned" is enabled, the CBR rates are not used:
+ * during the "On" state, the application sends one burst of packets per OFDM
+ * symbol, from a single event per symbol and plane, as an O-RAN radio unit
+ * does. The symbol grid is given by the numerology (a slot lasts 1 ms / 2^mu)
+ * and the number of symbols per slot. A U-plane burst holds U-PacketsPerSymbol
+ * packets or, if it is zero, enough U-PacketSize packets to carry the 16-bit
+ * IQ samples of the 12 subcarriers of each of the Prbs PRBs. A C-plane burst
+ * of C-PacketsPerSymbol packets is sent C-Advance ahead of the U-plane burst
+ * of the same symbol.
+ *
+ * If the attribute "PrototypePackets" is enabled, the payload of each plane is
+ * created once when the application starts, and every packet sent is a
+ * copy-on-write copy of it, which only allocates the Packet object. The copies
+ * share the uid of their prototype, so packets can no longer be matched by uid
+ * between the Tx and Rx traces (the SeqTsSizeHeader sequence number can be
+ * used instead).
+ *
+ * If the attribute "EnableTimingHeader" is enabled, every packet starts with
+ * an OfhTimingHeader carrying RuId, its plane and its symbol time (the time
+ * of its symbol in symbol-aligned mode, the time it is sent otherwise), from
+ * which an OfhSink checks the reception window of the packet.
  */
 class OfhApplication : public Application
 {
@@ -158,6 +181,15 @@ class OfhApplication : public Application
      * \brief Send a packet
      */
     void ControlSendPacket();
+    /**
+     * \brief Send the C-plane burst of a symbol
+     */
+    void ControlSendBurst();
+    /**
+     * \brief Send a C-plane packet, or the cached one
+     * \return true if the packet was sent
+     */
+    bool ControlTransmit();
 
 
 
@@ -188,6 +220,33 @@ class OfhApplication : public Application
      * \brief Send a packet
      */
     void UserSendPacket();
+    /**
+     * \brief Send the U-plane burst of a symbol
+     */
+    void UserSendBurst();
+    /**
+     * \brief Send a U-plane packet, or the cached one
+     * \return true if the packet was sent
+     */
+    bool UserTransmit();
+
+    /**
+     * \brief Get the size of the headers added to the payload of the packets
+     * \return the size of the headers
+     */
+    uint32_t GetHeadersSize() const;
+    /**
+     * \brief Get the time of a symbol of the symbol grid
+     * \param symbol the index of the symbol
+     * \return the time of the symbol, relative to symbol 0
+     */
+    Time GetSymbolOffset(uint64_t symbol) const;
+    /**
+     * \brief Get the first symbol of a symbol grid not before the current time
+     * \param origin the time of symbol 0 of the grid
+     * \return the index of the symbol
+     */
+    uint64_t GetNextSymbol(Time origin) const;
 
     // USER-Plane 
 
@@ -208,6 +267,7 @@ class OfhApplication : public Application
     EventId m_u_sendEvent;                 //!< Event id of pending "send packet" event
     uint32_t m_u_seq{0};                   //!< Sequence
     Ptr<Packet> m_u_unsentPacket;          //!< Unsent packet cached for future attempt
+    Ptr<Packet> m_u_prototype;             //!< Payload copied by every packet, if any
     bool tx_finished = false;
 
    // USER-Plane 
@@ -229,10 +289,28 @@ class OfhApplication : public Application
     EventId m_c_sendEvent;                 //!< Event id of pending "send packet" event
     uint32_t m_c_seq{0};                   //!< Sequence
     Ptr<Packet> m_c_unsentPacket;          //!< Unsent packet cached for future attempt
+    Ptr<Packet> m_c_prototype;             //!< Payload copied by every packet, if any
+
+
+    // Symbol-aligned bursts
 
+    bool m_symbolAligned;       //!< True to send one burst per symbol instead of CBR traffic
+    uint32_t m_numerology;      //!< Numerology (mu) of the symbol grid
+    uint32_t m_symbolsPerSlot;  //!< Number of symbols per slot
+    uint32_t m_prbs;            //!< Number of PRBs carried by a U-plane burst
+    uint32_t m_u_pktsPerSymbol; //!< U-plane packets per symbol (0 to derive from the PRBs)
+    uint32_t m_c_pktsPerSymbol; //!< C-plane packets per symbol
+    Time m_c_advance;           //!< Advance of a C-plane burst on its U-plane burst
+    uint32_t m_u_burstSize;     //!< U-plane packets per symbol in use
+    Time m_u_symbolOrigin;      //!< Time of the U-plane burst of symbol 0
+    uint64_t m_u_symbol;        //!< Symbol of the next U-plane burst
+    uint64_t m_c_symbol;        //!< Symbol of the next C-plane burst
 
     // Global things
     bool m_enableSeqTsSizeHeader{false}; //!< Enable or disable the use of SeqTsSizeHeader
+    bool m_prototypePackets;             //!< Send copies of a prototype payload
+    bool m_enableTimingHeader;           //!< Stamp the packets with an OfhTimingHeader
+    uint16_t m_ruId;                     //!< Radio unit identifier of the OfhTimingHeader
     TypeId m_tid;                        //!< Type of the socket used
     /// Traced Callback: transmitted packets.
     TracedCallback<Ptr<const Packet>> m_txTrace;
@@ -0,0 +1,287 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ofh-fleet-application.h"
+
+#include "ns3/address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("OfhFleetApplication");
+
+NS_OBJECT_ENSURE_REGISTERED(OfhFleetApplication);
+
+TypeId
+OfhFleetApplication::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::OfhFleetApplication")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddConstructor<OfhFleetApplication>()
+            .AddAttribute("Local",
+                          "The Address on which to bind the socket. If not set, it is generated "
+                          "automatically.",
+                          AddressValue(),
+                          MakeAddressAccessor(&OfhFleetApplication::m_local),
+                          MakeAddressChecker())
+            .AddAttribute("Protocol",
+                          "The type of protocol to use. This should be "
+                          "a subclass of ns3::SocketFactory",
+                          TypeIdValue(UdpSocketFactory::GetTypeId()),
+                          MakeTypeIdAccessor(&OfhFleetApplication::m_tid),
+                          // This should check for SocketFactory as a parent
+                          MakeTypeIdChecker())
+            .AddTraceSource("Tx",
+                            "A new packet is created and is sent",
+                            MakeTraceSourceAccessor(&OfhFleetApplication::m_txTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("TxWithAddresses",
+                            "A new packet is created and is sent",
+                            MakeTraceSourceAccessor(&OfhFleetApplication::m_txTraceWithAddresses),
+                            "ns3::Packet::TwoAddressTracedCallback")
+            .AddTraceSource("TxWithRu",
+                            "A new packet is created and is sent by a plane of a radio unit",
+                            MakeTraceSourceAccessor(&OfhFleetApplication::m_txTraceWithRu),
+                            "ns3::OfhFleetApplication::TxWithRuTracedCallback");
+    return tid;
+}
+
+OfhFleetApplication::OfhFleetApplication()
+    : m_socket(nullptr)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+OfhFleetApplication::~OfhFleetApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+OfhFleetApplication::AddRu(const PlaneConfig& uPlane, const PlaneConfig& cPlane, Time start)
+{
+    NS_LOG_FUNCTION(this << start);
+
+    for (const PlaneConfig* config : {&uPlane, &cPlane})
+    {
+        PlaneState state;
+        state.config = *config;
+        state.interval = config->rate.GetBitRate() > 0
+                             ? config->rate.CalculateBytesTxTime(config->packetSize)
+                             : Time::Max();
+        state.totBytes = 0;
+        m_planes.push_back(state);
+    }
+    m_ruStart.push_back(start);
+    return m_ruStart.size() - 1;
+}
+
+uint32_t
+OfhFleetApplication::GetNRus() const
+{
+    return m_ruStart.size();
+}
+
+uint64_t
+OfhFleetApplication::GetTotalTx(uint32_t ru, Plane plane) const
+{
+    NS_ASSERT(ru < m_ruStart.size());
+    return m_planes[2 * ru + plane].totBytes;
+}
+
+Ptr<Socket>
+OfhFleetApplication::GetSocket() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_socket;
+}
+
+void
+OfhFleetApplication::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_socket = nullptr;
+    m_planes.clear();
+    m_heap.clear();
+    // chain up
+    Application::DoDispose();
+}
+
+void
+OfhFleetApplication::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_ruStart.empty())
+    {
+        return;
+    }
+
+    if (!m_socket)
+    {
+        const Address& peer = m_planes[0].config.peer;
+        m_socket = Socket::CreateSocket(GetNode(), m_tid);
+        int ret = -1;
+        if (!m_local.IsInvalid())
+        {
+            ret = m_socket->Bind(m_local);
+        }
+        else if (Inet6SocketAddress::IsMatchingType(peer))
+        {
+            ret = m_socket->Bind6();
+        }
+        else if (InetSocketAddress::IsMatchingType(peer) ||
+                 PacketSocketAddress::IsMatchingType(peer))
+        {
+            ret = m_socket->Bind();
+        }
+        if (ret == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+        m_socket->SetAllowBroadcast(true);
+        m_socket->ShutdownRecv();
+    }
+
+    m_heap.clear();
+    m_heap.reserve(m_planes.size());
+    for (uint32_t index = 0; index < m_planes.size(); index++)
+    {
+        PlaneState& state = m_planes[index];
+        if (state.interval == Time::Max() || state.config.peer.IsInvalid() ||
+            (state.config.maxBytes > 0 && state.totBytes >= state.config.maxBytes))
+        {
+            continue;
+        }
+        // the first packet is sent one interval into the first On period
+        Time onStart = Simulator::Now() + m_ruStart[index / 2];
+        state.onEnd = onStart + state.config.onTime;
+        Push(index, GetNextTx(state, onStart));
+    }
+    NS_LOG_LOGIC(m_heap.size() << " active planes for " << m_ruStart.size() << " radio units");
+    ScheduleNextTx();
+}
+
+void
+OfhFleetApplication::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_sendEvent.Cancel();
+    m_heap.clear();
+}
+
+void
+OfhFleetApplication::Push(uint32_t index, Time time)
+{
+    m_heap.push_back({time, index});
+    std::push_heap(m_heap.begin(), m_heap.end(), Later());
+}
+
+Time
+OfhFleetApplication::GetNextTx(PlaneState& state, Time time)
+{
+    Time next = time + state.interval;
+    if (state.config.offTime.IsStrictlyPositive() && next > state.onEnd)
+    {
+        // the next packet is sent one interval into the next On period
+        Time onStart = state.onEnd + state.config.offTime;
+        state.onEnd = onStart + state.config.onTime;
+        next = onStart + state.interval;
+    }
+    return next;
+}
+
+void
+OfhFleetApplication::ScheduleNextTx()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_heap.empty())
+    {
+        NS_LOG_LOGIC("All the planes are done");
+        return;
+    }
+    m_sendEvent = Simulator::Schedule(m_heap.front().time - Simulator::Now(),
+                                      &OfhFleetApplication::SendDue,
+                                      this);
+}
+
+void
+OfhFleetApplication::SendDue()
+{
+    NS_LOG_FUNCTION(this);
+
+    Time now = Simulator::Now();
+    while (!m_heap.empty() && m_heap.front().time <= now)
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+        TxEntry entry = m_heap.back();
+        m_heap.pop_back();
+
+        PlaneState& state = m_planes[entry.index];
+        SendPacket(entry.index);
+        if (state.config.maxBytes == 0 || state.totBytes < state.config.maxBytes)
+        {
+            Push(entry.index, GetNextTx(state, entry.time));
+        }
+    }
+    ScheduleNextTx();
+}
+
+void
+OfhFleetApplication::SendPacket(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+
+    PlaneState& state = m_planes[index];
+    Ptr<Packet> packet = Create<Packet>(state.config.packetSize);
+    int actual = m_socket->SendTo(packet, 0, state.config.peer);
+    if ((unsigned)actual != state.config.packetSize)
+    {
+        NS_LOG_DEBUG("Unable to send packet of radio unit " << index / 2 << "; dropped");
+        return;
+    }
+    state.totBytes += state.config.packetSize;
+
+    m_txTrace(packet);
+    Address localAddress;
+    m_socket->GetSockName(localAddress);
+    m_txTraceWithAddresses(packet, localAddress, state.config.peer);
+    m_txTraceWithRu(packet, index / 2, index % 2);
+    NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " radio unit " << index / 2
+                           << (index % 2 == U_PLANE ? " U-plane" : " C-plane") << " sent "
+                           << packet->GetSize() << " bytes, total Tx " << state.totBytes
+                           << " bytes");
+}
+
+} // Namespace ns3
@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OFH_FLEET_APPLICATION_H
+#define OFH_FLEET_APPLICATION_H
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class Socket;
+
+/**
+ * \ingroup onoff
+ *
+ * \brief Generate the U-plane and C-plane traffic of a fleet of radio units
+ *        from a single application.
+ *
+ * Each radio unit (RU) added with AddRu has a U-plane and a C-plane, each
+ * sending CBR traffic of fixed-size packets to its own peer, with constant
+ * On and Off periods (no Off period if the Off time is zero) and an optional
+ * byte limit, like a pair of OfhApplication instances would.
+ *
+ * Rather than one event chain per plane, the application keeps a min-heap of
+ * the next transmission time of every active plane and a single pending
+ * simulator event, for the earliest of them. When it expires, every plane
+ * which is due sends its packet and is pushed back with its next transmission
+ * time; a plane which reached its byte limit leaves the heap. All the packets
+ * are sent from a single socket, to the peer of their plane.
+ */
+class OfhFleetApplication : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    OfhFleetApplication();
+
+    ~OfhFleetApplication() override;
+
+    /// The planes of a radio unit
+    enum Plane : uint8_t
+    {
+        U_PLANE = 0,
+        C_PLANE = 1
+    };
+
+    /**
+     * \brief The traffic of a plane of a radio unit
+     */
+    struct PlaneConfig
+    {
+        Address peer;             //!< the destination of the packets
+        DataRate rate;            //!< the rate during the On periods
+        uint32_t packetSize{512}; //!< the size of the packets
+        uint64_t maxBytes{0};     //!< the bytes to send, 0 for no limit
+        Time onTime{Seconds(1)};  //!< the duration of the On periods
+        Time offTime{Seconds(0)}; //!< the duration of the Off periods
+    };
+
+    /**
+     * TracedCallback signature for the packets sent by a plane of a radio unit.
+     *
+     * \param [in] packet The packet sent.
+     * \param [in] ru The index of the radio unit.
+     * \param [in] plane The plane of the packet.
+     */
+    typedef void (*TxWithRuTracedCallback)(Ptr<const Packet> packet, uint32_t ru, uint8_t plane);
+
+    /**
+     * \brief Add a radio unit to the fleet.
+     *
+     * The radio units must be added before the application starts.
+     *
+     * \param uPlane the U-plane traffic of the radio unit
+     * \param cPlane the C-plane traffic of the radio unit
+     * \param start the delay of the first On period from the application start
+     * \return the index of the radio unit
+     */
+    uint32_t AddRu(const PlaneConfig& uPlane, const PlaneConfig& cPlane, Time start = Seconds(0));
+
+    /**
+     * \brief Get the number of radio units of the fleet.
+     * \return the number of radio units
+     */
+    uint32_t GetNRus() const;
+
+    /**
+     * \brief Get the bytes sent by a plane of a radio unit.
+     * \param ru the index of the radio unit
+     * \param plane the plane
+     * \return the bytes sent so far
+     */
+    uint64_t GetTotalTx(uint32_t ru, Plane plane) const;
+
+    /**
+     * \brief Return a pointer to the socket of the fleet.
+     * \return pointer to the socket
+     */
+    Ptr<Socket> GetSocket() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * \brief The state of a plane of a radio unit
+     */
+    struct PlaneState
+    {
+        PlaneConfig config; //!< the traffic of the plane
+        Time interval;      //!< the time between two packets
+        Time onEnd;         //!< the end of the current On period
+        uint64_t totBytes;  //!< the bytes sent so far
+    };
+
+    /**
+     * \brief An entry of the heap of the next transmissions
+     */
+    struct TxEntry
+    {
+        Time time;      //!< the time of the next transmission
+        uint32_t index; //!< the plane, as 2 * ru + plane
+    };
+
+    /**
+     * \brief Order the heap entries so that the earliest is on top
+     */
+    struct Later
+    {
+        /**
+         * \param a an entry
+         * \param b another entry
+         * \return true if a comes after b
+         */
+        bool operator()(const TxEntry& a, const TxEntry& b) const
+        {
+            return a.time > b.time || (a.time == b.time && a.index > b.index);
+        }
+    };
+
+    /**
+     * \brief Push a plane in the heap
+     * \param index the plane
+     * \param time its next transmission time
+     */
+    void Push(uint32_t index, Time time);
+
+    /**
+     * \brief Get the transmission following the one at the given time
+     * \param state the plane
+     * \param time the time of the current transmission
+     * \return the time of the next transmission
+     */
+    Time GetNextTx(PlaneState& state, Time time);
+
+    /**
+     * \brief Schedule the event of the earliest transmission of the heap
+     */
+    void ScheduleNextTx();
+
+    /**
+     * \brief Send the packets of every plane which is due
+     */
+    void SendDue();
+
+    /**
+     * \brief Send a packet of a plane
+     * \param index the plane
+     */
+    void SendPacket(uint32_t index);
+
+    Ptr<Socket> m_socket;             //!< the socket of the fleet
+    Address m_local;                  //!< Local address to bind to
+    TypeId m_tid;                     //!< Type of the socket used
+    std::vector<PlaneState> m_planes; //!< the planes, two per radio unit
+    std::vector<Time> m_ruStart;      //!< the start delay of each radio unit
+    std::vector<TxEntry> m_heap;      //!< the next transmission of the active planes
+    EventId m_sendEvent;              //!< the event of the earliest transmission
+
+    /// Traced Callback: transmitted packets.
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+
+    /// Callbacks for tracing the packet Tx events, includes source and destination addresses
+    TracedCallback<Ptr<const Packet>, const Address&, const Address&> m_txTraceWithAddresses;
+
+    /// Callbacks for tracing the packet Tx events, includes the radio unit and the plane
+    TracedCallback<Ptr<const Packet>, uint32_t, uint8_t> m_txTraceWithRu;
+};
+
+} // namespace ns3
+
+#endif /* OFH_FLEET_APPLICATION_H */
@@ -0,0 +1,279 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ofh-sink.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/ofh-timing-header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("OfhSink");
+
+NS_OBJECT_ENSURE_REGISTERED(OfhSink);
+
+TypeId
+OfhSink::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::OfhSink")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddConstructor<OfhSink>()
+            .AddAttribute("U-Ta4Min",
+                          "The start of the reception window of the U-plane, relative to "
+                          "the symbol time",
+                          TimeValue(Time(0)),
+                          MakeTimeAccessor(&OfhSink::m_uTa4Min),
+                          MakeTimeChecker())
+            .AddAttribute("U-Ta4Max",
+                          "The end of the reception window of the U-plane, relative to "
+                          "the symbol time",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&OfhSink::m_uTa4Max),
+                          MakeTimeChecker())
+            .AddAttribute("C-Ta4Min",
+                          "The start of the reception window of the C-plane, relative to "
+                          "the symbol time",
+                          TimeValue(MicroSeconds(-200)),
+                          MakeTimeAccessor(&OfhSink::m_cTa4Min),
+                          MakeTimeChecker())
+            .AddAttribute("C-Ta4Max",
+                          "The end of the reception window of the C-plane, relative to "
+                          "the symbol time",
+                          TimeValue(Time(0)),
+                          MakeTimeAccessor(&OfhSink::m_cTa4Max),
+                          MakeTimeChecker())
+            .AddAttribute("HistogramBins",
+                          "The number of bins of the histograms, evenly spanning the "
+                          "reception window",
+                          UintegerValue(20),
+                          MakeUintegerAccessor(&OfhSink::m_nBins),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("SummaryFile",
+                          "The file the summary is written to when the sink stops, "
+                          "nothing is written if empty",
+                          StringValue(""),
+                          MakeStringAccessor(&OfhSink::m_summaryFile),
+                          MakeStringChecker());
+    return tid;
+}
+
+OfhSink::OfhSink()
+    : m_summaryWritten(false),
+      m_malformed(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+OfhSink::~OfhSink()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+OfhSink::AddLocal(const Address& local)
+{
+    NS_LOG_FUNCTION(this << local);
+    m_locals.push_back(local);
+}
+
+OfhSink::Stats
+OfhSink::GetStats(uint16_t ru, uint8_t plane) const
+{
+    NS_LOG_FUNCTION(this << ru << +plane);
+    auto it = m_stats.find(Key(ru, plane));
+    return it == m_stats.end() ? Stats() : it->second;
+}
+
+uint64_t
+OfhSink::GetNMalformed() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_malformed;
+}
+
+void
+OfhSink::PrintSummary(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this << &os);
+    os << "# ru plane packets bytes early onTime late minUs meanUs maxUs bins...\n";
+    for (const auto& [key, stats] : m_stats)
+    {
+        os << key.first << " " << +key.second << " " << stats.packets << " " << stats.bytes << " "
+           << stats.early << " " << stats.onTime << " " << stats.late << " "
+           << stats.minOffset.GetMicroSeconds() << " "
+           << (stats.sumOffset / stats.packets).GetMicroSeconds() << " "
+           << stats.maxOffset.GetMicroSeconds();
+        for (uint64_t count : stats.bins)
+        {
+            os << " " << count;
+        }
+        os << "\n";
+    }
+    if (m_malformed)
+    {
+        os << "# malformed " << m_malformed << "\n";
+    }
+}
+
+void
+OfhSink::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    // the sink may never be stopped
+    WriteSummary();
+    m_sockets.clear();
+
+    // chain up
+    Application::DoDispose();
+}
+
+void
+OfhSink::StartApplication() // Called at time specified by Start
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(m_uTa4Max <= m_uTa4Min || m_cTa4Max <= m_cTa4Min,
+                    "The reception windows must not be empty");
+    if (m_sockets.empty())
+    {
+        for (const Address& local : m_locals)
+        {
+            Ptr<Socket> socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            if (socket->Bind(local) == -1)
+            {
+                NS_FATAL_ERROR("Failed to bind socket");
+            }
+            socket->ShutdownSend();
+            m_sockets.push_back(socket);
+        }
+    }
+    for (Ptr<Socket> socket : m_sockets)
+    {
+        socket->SetRecvCallback(MakeCallback(&OfhSink::HandleRead, this));
+    }
+}
+
+void
+OfhSink::StopApplication() // Called at time specified by Stop
+{
+    NS_LOG_FUNCTION(this);
+    for (Ptr<Socket> socket : m_sockets)
+    {
+        socket->Close();
+        socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
+    WriteSummary();
+}
+
+void
+OfhSink::HandleRead(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv()))
+    {
+        if (packet->GetSize() == 0)
+        { // EOF
+            break;
+        }
+        Account(packet);
+    }
+}
+
+void
+OfhSink::Account(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+    uint32_t size = packet->GetSize();
+    OfhTimingHeader header;
+    if (size < header.GetSerializedSize())
+    {
+        m_malformed++;
+        return;
+    }
+    packet->RemoveHeader(header);
+    // a packet sent without OfhTimingHeader, or of an unknown plane
+    if (!header.IsValid())
+    {
+        m_malformed++;
+        return;
+    }
+    Time offset = Simulator::Now() - header.GetSymbolTime();
+    bool uPlane = header.GetPlane() == OfhTimingHeader::U_PLANE;
+    Time ta4Min = uPlane ? m_uTa4Min : m_cTa4Min;
+    Time ta4Max = uPlane ? m_uTa4Max : m_cTa4Max;
+
+    Stats& stats = m_stats[Key(header.GetRu(), header.GetPlane())];
+    if (stats.packets == 0)
+    {
+        stats.minOffset = offset;
+        stats.maxOffset = offset;
+        stats.bins.assign(m_nBins, 0);
+    }
+    stats.packets++;
+    stats.bytes += size;
+    stats.minOffset = Min(stats.minOffset, offset);
+    stats.maxOffset = Max(stats.maxOffset, offset);
+    stats.sumOffset += offset;
+    if (offset < ta4Min)
+    {
+        stats.early++;
+    }
+    else if (offset > ta4Max)
+    {
+        stats.late++;
+    }
+    else
+    {
+        stats.onTime++;
+        // the end of the window falls in the last bin
+        uint64_t bin = (offset - ta4Min).GetTimeStep() * m_nBins / (ta4Max - ta4Min).GetTimeStep();
+        stats.bins[std::min<uint64_t>(bin, m_nBins - 1)]++;
+    }
+    NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " received " << size
+                           << " bytes of ru " << header.GetRu() << " plane "
+                           << +header.GetPlane() << ", offset " << offset.As(Time::US));
+}
+
+void
+OfhSink::WriteSummary()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_summaryWritten || m_summaryFile.empty())
+    {
+        return;
+    }
+    std::ofstream os(m_summaryFile);
+    NS_ABORT_MSG_IF(!os.is_open(), "Cannot open summary file " << m_summaryFile);
+    PrintSummary(os);
+    m_summaryWritten = true;
+}
+
+} // namespace ns3
@@ -0,0 +1,153 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OFH_SINK_H
+#define OFH_SINK_H
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup applications
+ *
+ * \brief Receive fronthaul packets and account for their reception window.
+ *
+ * The sink receives the packets of OfhApplication instances with the
+ * attribute "EnableTimingHeader" set, on the UDP ports added by AddLocal.
+ * The offset of a packet is its arrival time minus the symbol time carried by
+ * its OfhTimingHeader. Against the reception window of its plane
+ * ([U-Ta4Min, U-Ta4Max] for the U-plane, [C-Ta4Min, C-Ta4Max] for the
+ * C-plane), a packet is early, on time or late.
+ *
+ * Nothing is traced per packet: the sink keeps, per radio unit and plane,
+ * the counters of the packets and a histogram of the offsets of the packets
+ * on time, and writes their summary to SummaryFile when it stops.
+ */
+class OfhSink : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    OfhSink();
+
+    ~OfhSink() override;
+
+    /// The statistics of a plane of a radio unit
+    struct Stats
+    {
+        uint64_t packets{0};          //!< the packets received
+        uint64_t bytes{0};            //!< the bytes received
+        uint64_t early{0};            //!< the packets received before the window
+        uint64_t onTime{0};           //!< the packets received in the window
+        uint64_t late{0};             //!< the packets received after the window
+        Time minOffset;               //!< the smallest offset
+        Time maxOffset;               //!< the largest offset
+        Time sumOffset;               //!< the sum of the offsets
+        std::vector<uint64_t> bins{}; //!< the histogram of the offsets in the window
+    };
+
+    /**
+     * \brief Receive the packets sent to an address.
+     * \param local the address, of a UDP port, to bind a socket to
+     */
+    void AddLocal(const Address& local);
+
+    /**
+     * \brief Get the statistics of a plane of a radio unit.
+     * \param ru the radio unit
+     * \param plane the plane (OfhTimingHeader::U_PLANE or OfhTimingHeader::C_PLANE)
+     * \return the statistics, empty if no packet was received
+     */
+    Stats GetStats(uint16_t ru, uint8_t plane) const;
+
+    /**
+     * \brief Get the number of packets without a valid OfhTimingHeader.
+     * \return the number of malformed packets
+     */
+    uint64_t GetNMalformed() const;
+
+    /**
+     * \brief Print the summary of the statistics.
+     *
+     * A line per plane of a radio unit: the radio unit, the plane, the packets,
+     * the bytes, the early, on time and late packets, the minimum, mean and
+     * maximum offsets in microseconds, then the counts of the histogram bins.
+     *
+     * \param os the output stream
+     */
+    void PrintSummary(std::ostream& os) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * \brief Handle the packets received by a socket
+     * \param socket the socket
+     */
+    void HandleRead(Ptr<Socket> socket);
+
+    /**
+     * \brief Account for a packet received
+     * \param packet the packet
+     */
+    void Account(Ptr<Packet> packet);
+
+    /**
+     * \brief Write the summary to SummaryFile, once
+     */
+    void WriteSummary();
+
+    /// The key of the statistics: the radio unit and the plane
+    using Key = std::pair<uint16_t, uint8_t>;
+
+    std::vector<Address> m_locals;      //!< the addresses to receive from
+    std::vector<Ptr<Socket>> m_sockets; //!< the sockets, one per address
+    Time m_uTa4Min;                     //!< the start of the U-plane window
+    Time m_uTa4Max;                     //!< the end of the U-plane window
+    Time m_cTa4Min;                     //!< the start of the C-plane window
+    Time m_cTa4Max;                     //!< the end of the C-plane window
+    uint32_t m_nBins;                   //!< the number of bins of the histograms
+    std::string m_summaryFile;          //!< the name of the summary file
+    bool m_summaryWritten;              //!< whether the summary was written
+    std::map<Key, Stats> m_stats;       //!< the statistics per radio unit and plane
+    uint64_t m_malformed;               //!< the packets without OfhTimingHeader
+};
+
+} // namespace ns3
+
+#endif /* OFH_SINK_H */
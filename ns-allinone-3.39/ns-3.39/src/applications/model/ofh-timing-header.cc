@@ -0,0 +1,140 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ofh-timing-header.h"
+
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("OfhTimingHeader");
+
+NS_OBJECT_ENSURE_REGISTERED(OfhTimingHeader);
+
+OfhTimingHeader::OfhTimingHeader()
+    : m_symbolTime(0),
+      m_ru(0),
+      m_plane(0),
+      m_magic(MAGIC)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+OfhTimingHeader::SetSymbolTime(Time symbolTime)
+{
+    NS_LOG_FUNCTION(this << symbolTime);
+    m_symbolTime = symbolTime.GetTimeStep();
+}
+
+Time
+OfhTimingHeader::GetSymbolTime() const
+{
+    NS_LOG_FUNCTION(this);
+    return TimeStep(m_symbolTime);
+}
+
+void
+OfhTimingHeader::SetRu(uint16_t ru)
+{
+    NS_LOG_FUNCTION(this << ru);
+    m_ru = ru;
+}
+
+uint16_t
+OfhTimingHeader::GetRu() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_ru;
+}
+
+void
+OfhTimingHeader::SetPlane(uint8_t plane)
+{
+    NS_LOG_FUNCTION(this << +plane);
+    m_plane = plane;
+}
+
+uint8_t
+OfhTimingHeader::GetPlane() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_plane;
+}
+
+bool
+OfhTimingHeader::IsValid() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_magic == MAGIC && (m_plane == U_PLANE || m_plane == C_PLANE);
+}
+
+TypeId
+OfhTimingHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::OfhTimingHeader")
+                            .SetParent<Header>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<OfhTimingHeader>();
+    return tid;
+}
+
+TypeId
+OfhTimingHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+OfhTimingHeader::Print(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this << &os);
+    os << "(ru=" << m_ru << " plane=" << +m_plane
+       << " symbol=" << TimeStep(m_symbolTime).As(Time::S) << ")";
+}
+
+uint32_t
+OfhTimingHeader::GetSerializedSize() const
+{
+    NS_LOG_FUNCTION(this);
+    return 8 + 2 + 1 + 1;
+}
+
+void
+OfhTimingHeader::Serialize(Buffer::Iterator start) const
+{
+    NS_LOG_FUNCTION(this << &start);
+    Buffer::Iterator i = start;
+    i.WriteHtonU64(m_symbolTime);
+    i.WriteHtonU16(m_ru);
+    i.WriteU8(m_plane);
+    i.WriteU8(MAGIC);
+}
+
+uint32_t
+OfhTimingHeader::Deserialize(Buffer::Iterator start)
+{
+    NS_LOG_FUNCTION(this << &start);
+    Buffer::Iterator i = start;
+    m_symbolTime = i.ReadNtohU64();
+    m_ru = i.ReadNtohU16();
+    m_plane = i.ReadU8();
+    m_magic = i.ReadU8();
+    return GetSerializedSize();
+}
+
+} // namespace ns3
@@ -0,0 +1,105 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OFH_TIMING_HEADER_H
+#define OFH_TIMING_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+/**
+ * \ingroup applications
+ * \brief Header with the radio unit, the plane and the symbol time of a
+ *        fronthaul packet
+ *
+ * The symbol time is the time of the symbol the packet belongs to, against
+ * which the receiver checks its reception window. The header takes 12 bytes,
+ * the last one identifying the header and its version (MAGIC), so that a
+ * receiver can tell the packets without this header apart (see IsValid).
+ */
+class OfhTimingHeader : public Header
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /// The planes of a fronthaul packet
+    enum Plane : uint8_t
+    {
+        U_PLANE = 0,
+        C_PLANE = 1
+    };
+
+    /// The identifier of the header and of its version
+    static constexpr uint8_t MAGIC = 0xA1;
+
+    /**
+     * \brief constructor
+     */
+    OfhTimingHeader();
+
+    /**
+     * \param symbolTime the time of the symbol of the packet
+     */
+    void SetSymbolTime(Time symbolTime);
+    /**
+     * \return the time of the symbol of the packet
+     */
+    Time GetSymbolTime() const;
+    /**
+     * \param ru the radio unit which sent the packet
+     */
+    void SetRu(uint16_t ru);
+    /**
+     * \return the radio unit which sent the packet
+     */
+    uint16_t GetRu() const;
+    /**
+     * \param plane the plane of the packet (0 for the U-plane, 1 for the C-plane)
+     */
+    void SetPlane(uint8_t plane);
+    /**
+     * \return the plane of the packet (0 for the U-plane, 1 for the C-plane)
+     */
+    uint8_t GetPlane() const;
+    /**
+     * \return whether the deserialized bytes are an OfhTimingHeader of a
+     *         known plane
+     */
+    bool IsValid() const;
+
+    // Inherited
+    TypeId GetInstanceTypeId() const override;
+    void Print(std::ostream& os) const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+
+  private:
+    uint64_t m_symbolTime; //!< the symbol time, in time steps
+    uint16_t m_ru;         //!< the radio unit
+    uint8_t m_plane;       //!< the plane
+    uint8_t m_magic;       //!< the identifier of the header
+};
+
+} // namespace ns3
+
+#endif /* OFH_TIMING_HEADER_H */
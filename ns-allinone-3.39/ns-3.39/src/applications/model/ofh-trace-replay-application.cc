@@ -0,0 +1,448 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ofh-trace-replay-application.h"
+
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/trace-helper.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("OfhTraceReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED(OfhTraceReplayApplication);
+
+TypeId
+OfhTraceReplayApplication::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::OfhTraceReplayApplication")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddConstructor<OfhTraceReplayApplication>()
+            .AddAttribute("TraceFile",
+                          "The name of the fronthaul trace file to replay",
+                          StringValue(""),
+                          MakeStringAccessor(&OfhTraceReplayApplication::SetTraceFile),
+                          MakeStringChecker())
+            .AddAttribute("RemoteAddress",
+                          "The IP address of the packet sink, the ports are given by the "
+                          "radio unit and the plane of each packet",
+                          AddressValue(),
+                          MakeAddressAccessor(&OfhTraceReplayApplication::m_peer),
+                          MakeAddressChecker())
+            .AddAttribute("UPlanePort",
+                          "The destination port of the U-plane packets of radio unit 0, "
+                          "radio unit n using the port UPlanePort + n",
+                          UintegerValue(8080),
+                          MakeUintegerAccessor(&OfhTraceReplayApplication::m_uPort),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("CPlanePort",
+                          "The destination port of the C-plane packets of radio unit 0, "
+                          "radio unit n using the port CPlanePort + n",
+                          UintegerValue(9090),
+                          MakeUintegerAccessor(&OfhTraceReplayApplication::m_cPort),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("TimeScale",
+                          "The factor applied to the recorded times (2 replays the trace "
+                          "twice slower)",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&OfhTraceReplayApplication::m_timeScale),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("Lookahead",
+                          "The number of records prefetched after the cursor, 0 to leave "
+                          "the paging of the trace file to the kernel",
+                          UintegerValue(65536),
+                          MakeUintegerAccessor(&OfhTraceReplayApplication::m_lookahead),
+                          MakeUintegerChecker<uint32_t>())
+            .AddTraceSource("Tx",
+                            "A new packet is created and is sent",
+                            MakeTraceSourceAccessor(&OfhTraceReplayApplication::m_txTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("TxWithRu",
+                            "A new packet is created and is sent by a plane of a radio unit",
+                            MakeTraceSourceAccessor(&OfhTraceReplayApplication::m_txTraceWithRu),
+                            "ns3::OfhTraceReplayApplication::TxWithRuTracedCallback");
+    return tid;
+}
+
+OfhTraceReplayApplication::OfhTraceReplayApplication()
+    : m_socket(nullptr),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_records(nullptr),
+      m_nRecords(0),
+      m_cursor(0),
+      m_prefetched(0),
+      m_released(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+OfhTraceReplayApplication::~OfhTraceReplayApplication()
+{
+    NS_LOG_FUNCTION(this);
+    Unmap();
+}
+
+void
+OfhTraceReplayApplication::SetTraceFile(const std::string& traceFile)
+{
+    NS_LOG_FUNCTION(this << traceFile);
+    m_traceFile = traceFile;
+}
+
+uint64_t
+OfhTraceReplayApplication::GetNRecords() const
+{
+    return m_nRecords;
+}
+
+uint64_t
+OfhTraceReplayApplication::GetNReplayed() const
+{
+    return m_cursor;
+}
+
+void
+OfhTraceReplayApplication::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_sendEvent.Cancel();
+    m_socket = nullptr;
+    Unmap();
+    // chain up
+    Application::DoDispose();
+}
+
+void
+OfhTraceReplayApplication::Map()
+{
+    NS_LOG_FUNCTION(this);
+
+    int fd = open(m_traceFile.c_str(), O_RDONLY);
+    NS_ABORT_MSG_IF(fd < 0, "Cannot open the trace file " << m_traceFile);
+    struct stat st;
+    NS_ABORT_MSG_IF(fstat(fd, &st) < 0, "Cannot stat the trace file " << m_traceFile);
+    m_mapSize = st.st_size;
+    NS_ABORT_MSG_IF(m_mapSize < sizeof(OfhTraceFileHeader),
+                    "The trace file " << m_traceFile << " has no header");
+    void* map = mmap(nullptr, m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping holds its own reference to the file
+    close(fd);
+    NS_ABORT_MSG_IF(map == MAP_FAILED, "Cannot map the trace file " << m_traceFile);
+    m_map = static_cast<uint8_t*>(map);
+
+    const auto header = reinterpret_cast<const OfhTraceFileHeader*>(m_map);
+    NS_ABORT_MSG_IF(header->magic != OfhTraceFileHeader::MAGIC ||
+                        header->version != OfhTraceFileHeader::VERSION ||
+                        header->recordSize != sizeof(OfhTraceRecord),
+                    "The file " << m_traceFile << " is not a fronthaul trace file");
+    NS_ABORT_MSG_IF(sizeof(OfhTraceFileHeader) + header->nRecords * sizeof(OfhTraceRecord) >
+                        m_mapSize,
+                    "The trace file " << m_traceFile << " is truncated");
+    m_records = reinterpret_cast<const OfhTraceRecord*>(m_map + sizeof(OfhTraceFileHeader));
+    m_nRecords = header->nRecords;
+    if (m_lookahead > 0)
+    {
+        madvise(m_map, m_mapSize, MADV_SEQUENTIAL);
+    }
+    NS_LOG_INFO("Mapped " << m_nRecords << " records of " << m_traceFile);
+}
+
+void
+OfhTraceReplayApplication::Unmap()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_map)
+    {
+        munmap(m_map, m_mapSize);
+        m_map = nullptr;
+        m_records = nullptr;
+    }
+}
+
+void
+OfhTraceReplayApplication::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_map)
+    {
+        Map();
+    }
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        int ret = -1;
+        if (Ipv6Address::IsMatchingType(m_peer) || Inet6SocketAddress::IsMatchingType(m_peer))
+        {
+            ret = m_socket->Bind6();
+        }
+        else if (Ipv4Address::IsMatchingType(m_peer) || InetSocketAddress::IsMatchingType(m_peer))
+        {
+            ret = m_socket->Bind();
+        }
+        if (ret == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+        m_socket->ShutdownRecv();
+    }
+
+    // replay from the first record, whose time is the start of the application
+    m_cursor = 0;
+    m_prefetched = 0;
+    m_released = 0;
+    m_origin = Simulator::Now();
+    ScheduleNextTx();
+}
+
+void
+OfhTraceReplayApplication::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_sendEvent.Cancel();
+    if (m_socket)
+    {
+        m_socket->Close();
+    }
+}
+
+Time
+OfhTraceReplayApplication::GetReplayTime(const OfhTraceRecord& record) const
+{
+    // a record older than the first one is due at once
+    if (record.timestamp <= m_records[0].timestamp)
+    {
+        return m_origin;
+    }
+    double offset = static_cast<double>(record.timestamp - m_records[0].timestamp);
+    return m_origin + NanoSeconds(static_cast<int64_t>(offset * m_timeScale));
+}
+
+void
+OfhTraceReplayApplication::Advise()
+{
+    if (m_lookahead == 0)
+    {
+        return;
+    }
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    auto offset = [](uint64_t record) {
+        return sizeof(OfhTraceFileHeader) + record * sizeof(OfhTraceRecord);
+    };
+
+    // prefetch the next window once the cursor is half way through the current one
+    if (m_prefetched < m_nRecords && m_cursor + m_lookahead / 2 >= m_prefetched)
+    {
+        uint64_t end = std::min(m_nRecords, m_cursor + m_lookahead);
+        uint64_t first = offset(m_prefetched) / pageSize * pageSize;
+        madvise(m_map + first, offset(end) - first, MADV_WILLNEED);
+        m_prefetched = end;
+    }
+    // release the whole pages before the cursor
+    if (m_cursor >= m_released + m_lookahead)
+    {
+        uint64_t first = offset(m_released) / pageSize * pageSize;
+        uint64_t last = offset(m_cursor) / pageSize * pageSize;
+        if (last > first)
+        {
+            madvise(m_map + first, last - first, MADV_DONTNEED);
+        }
+        m_released = m_cursor;
+    }
+}
+
+void
+OfhTraceReplayApplication::ScheduleNextTx()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_cursor == m_nRecords)
+    {
+        NS_LOG_LOGIC("The trace file is replayed");
+        return;
+    }
+    Advise();
+    // records out of order are sent at once
+    Time delay = Max(GetReplayTime(m_records[m_cursor]) - Simulator::Now(), Time(0));
+    m_sendEvent = Simulator::Schedule(delay, &OfhTraceReplayApplication::SendDue, this);
+}
+
+void
+OfhTraceReplayApplication::SendDue()
+{
+    NS_LOG_FUNCTION(this);
+
+    Time now = Simulator::Now();
+    while (m_cursor < m_nRecords && GetReplayTime(m_records[m_cursor]) <= now)
+    {
+        const OfhTraceRecord& record = m_records[m_cursor++];
+        uint16_t port = (record.plane == 0 ? m_uPort : m_cPort) + record.ru;
+        Address peer;
+        if (Ipv4Address::IsMatchingType(m_peer))
+        {
+            peer = InetSocketAddress(Ipv4Address::ConvertFrom(m_peer), port);
+        }
+        else if (InetSocketAddress::IsMatchingType(m_peer))
+        {
+            peer = InetSocketAddress(InetSocketAddress::ConvertFrom(m_peer).GetIpv4(), port);
+        }
+        else if (Ipv6Address::IsMatchingType(m_peer))
+        {
+            peer = Inet6SocketAddress(Ipv6Address::ConvertFrom(m_peer), port);
+        }
+        else
+        {
+            peer = Inet6SocketAddress(Inet6SocketAddress::ConvertFrom(m_peer).GetIpv6(), port);
+        }
+
+        Ptr<Packet> packet = Create<Packet>(record.size);
+        if (m_socket->SendTo(packet, 0, peer) < 0)
+        {
+            NS_LOG_DEBUG("Unable to send record " << m_cursor - 1 << "; dropped");
+            continue;
+        }
+        m_txTrace(packet);
+        m_txTraceWithRu(packet, record.ru, record.plane);
+    }
+    ScheduleNextTx();
+}
+
+uint64_t
+OfhTraceReplayApplication::ConvertPcap(const std::string& pcapFile, const std::string& traceFile)
+{
+    NS_LOG_FUNCTION(pcapFile << traceFile);
+
+    PcapFile pcap;
+    pcap.Open(pcapFile, std::ios::in);
+    NS_ABORT_MSG_IF(pcap.Fail(), "Cannot open the capture " << pcapFile);
+    NS_ABORT_MSG_IF(pcap.GetDataLinkType() != PcapHelper::DLT_EN10MB,
+                    "The capture " << pcapFile << " is not an Ethernet capture");
+    uint64_t tsUnit = pcap.IsNanoSecMode() ? 1 : 1000;
+
+    std::vector<uint8_t> data(pcap.GetSnapLen());
+    std::vector<OfhTraceRecord> records;
+    std::map<uint64_t, uint8_t> rus;
+    uint32_t tsSec;
+    uint32_t tsUsec;
+    uint32_t inclLen;
+    uint32_t origLen;
+    uint32_t readLen;
+    while (true)
+    {
+        pcap.Read(data.data(), data.size(), tsSec, tsUsec, inclLen, origLen, readLen);
+        if (pcap.Fail())
+        {
+            break;
+        }
+        if (readLen < 18)
+        {
+            continue;
+        }
+        uint32_t offset = 12;
+        uint16_t etherType = (data[offset] << 8) | data[offset + 1];
+        if (etherType == 0x8100)
+        {
+            offset += 4;
+            etherType = (data[offset] << 8) | data[offset + 1];
+        }
+        offset += 2;
+        // eCPRI common header, then the PC_ID/RTC_ID of the IQ data and control messages
+        if (etherType != 0xAEFE || readLen < offset + 6)
+        {
+            continue;
+        }
+        uint8_t messageType = data[offset + 1];
+        if (messageType != 0 && messageType != 2)
+        {
+            continue;
+        }
+
+        uint64_t mac = 0;
+        for (uint32_t i = 6; i < 12; i++)
+        {
+            mac = (mac << 8) | data[i];
+        }
+        auto it = rus.find(mac);
+        if (it == rus.end())
+        {
+            NS_ABORT_MSG_IF(rus.size() > UINT8_MAX, "Too many radio units in " << pcapFile);
+            it = rus.emplace(mac, rus.size()).first;
+        }
+
+        OfhTraceRecord record;
+        record.timestamp = tsSec * 1000000000ULL + tsUsec * tsUnit;
+        record.size = std::min<uint32_t>(origLen - offset, UINT16_MAX);
+        record.eAxC = (data[offset + 4] << 8) | data[offset + 5];
+        record.plane = messageType == 0 ? 0 : 1;
+        record.ru = it->second;
+        record.reserved = 0;
+        records.push_back(record);
+    }
+    pcap.Close();
+
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [](const OfhTraceRecord& a, const OfhTraceRecord& b) {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    OfhTraceFileHeader header;
+    header.magic = OfhTraceFileHeader::MAGIC;
+    header.version = OfhTraceFileHeader::VERSION;
+    header.recordSize = sizeof(OfhTraceRecord);
+    header.nRecords = records.size();
+    std::ofstream out(traceFile, std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!out, "Cannot open the trace file " << traceFile);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()),
+              records.size() * sizeof(OfhTraceRecord));
+    NS_ABORT_MSG_IF(!out, "Cannot write the trace file " << traceFile);
+    NS_LOG_INFO("Converted " << records.size() << " eCPRI frames of " << rus.size()
+                             << " radio units");
+    return records.size();
+}
+
+} // Namespace ns3
@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OFH_TRACE_REPLAY_APPLICATION_H
+#define OFH_TRACE_REPLAY_APPLICATION_H
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+
+#include <string>
+
+namespace ns3
+{
+
+class Socket;
+
+/**
+ * \ingroup applications
+ *
+ * \brief The header of a fronthaul trace file
+ *
+ * A fronthaul trace file is this header followed by nRecords OfhTraceRecord,
+ * sorted by timestamp, all in the byte order of the host.
+ */
+struct OfhTraceFileHeader
+{
+    uint32_t magic;      //!< OfhTraceFileHeader::MAGIC
+    uint16_t version;    //!< OfhTraceFileHeader::VERSION
+    uint16_t recordSize; //!< the size of a record, in bytes
+    uint64_t nRecords;   //!< the number of records
+
+    static constexpr uint32_t MAGIC = 0x5448464f; //!< "OFHT"
+    static constexpr uint16_t VERSION = 1;        //!< the version of the format
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief A packet of a fronthaul trace file
+ */
+struct OfhTraceRecord
+{
+    uint64_t timestamp; //!< the capture time of the packet, in nanoseconds
+    uint16_t size;      //!< the size of the packet, in bytes
+    uint16_t eAxC;      //!< the eAxC identifier of the packet
+    uint8_t plane;      //!< the plane of the packet (0 for the U-plane, 1 for the C-plane)
+    uint8_t ru;         //!< the radio unit which sent the packet
+    uint16_t reserved;  //!< padding, zero
+};
+
+static_assert(sizeof(OfhTraceFileHeader) == 16, "Unexpected padding of the trace file header");
+static_assert(sizeof(OfhTraceRecord) == 16, "Unexpected padding of the trace records");
+
+/**
+ * \ingroup applications
+ *
+ * \brief Replay the fronthaul packets of a trace file.
+ *
+ * The application memory-maps a fronthaul trace file (see OfhTraceFileHeader
+ * and OfhTraceRecord), such as the one written by ConvertPcap from an eCPRI
+ * capture, and sends a UDP packet of the recorded size for each record, at
+ * the recorded time relative to the first record, multiplied by TimeScale.
+ * The packets of radio unit n are sent to RemoteAddress, on port
+ * UPlanePort + n for the U-plane and CPlanePort + n for the C-plane.
+ *
+ * The records are read in place through a cursor, with a single pending
+ * event for the next timestamp (the records sharing a timestamp are sent by
+ * the same event). The Lookahead records after the cursor are prefetched
+ * and the pages already replayed are released, so that traces of millions
+ * of records replay with a bounded resident memory.
+ */
+class OfhTraceReplayApplication : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    OfhTraceReplayApplication();
+
+    ~OfhTraceReplayApplication() override;
+
+    /**
+     * TracedCallback signature for the packets sent by a plane of a radio unit.
+     *
+     * \param [in] packet The packet sent.
+     * \param [in] ru The index of the radio unit.
+     * \param [in] plane The plane of the packet.
+     */
+    typedef void (*TxWithRuTracedCallback)(Ptr<const Packet> packet, uint32_t ru, uint8_t plane);
+
+    /**
+     * \brief Set the trace file to replay.
+     * \param traceFile the name of the trace file
+     */
+    void SetTraceFile(const std::string& traceFile);
+
+    /**
+     * \brief Get the number of records of the trace file, once started.
+     * \return the number of records
+     */
+    uint64_t GetNRecords() const;
+
+    /**
+     * \brief Get the number of records replayed so far.
+     * \return the number of records replayed
+     */
+    uint64_t GetNReplayed() const;
+
+    /**
+     * \brief Convert an eCPRI capture to a fronthaul trace file.
+     *
+     * The capture must have an Ethernet link type. The frames of eCPRI type
+     * (0xAEFE, possibly behind a VLAN tag) are converted: the IQ data
+     * messages to U-plane records and the real-time control ones to C-plane
+     * records, with the PC_ID/RTC_ID field as the eAxC identifier. The radio
+     * units are numbered in the order their source MAC addresses first appear.
+     * The other frames are skipped.
+     *
+     * \param pcapFile the name of the capture to read
+     * \param traceFile the name of the trace file to write
+     * \return the number of records written
+     */
+    static uint64_t ConvertPcap(const std::string& pcapFile, const std::string& traceFile);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * \brief Map the trace file in memory
+     */
+    void Map();
+
+    /**
+     * \brief Unmap the trace file
+     */
+    void Unmap();
+
+    /**
+     * \brief Get the replay time of a record
+     * \param record the record
+     * \return the time at which the record is sent
+     */
+    Time GetReplayTime(const OfhTraceRecord& record) const;
+
+    /**
+     * \brief Prefetch the records after the cursor and release those before
+     */
+    void Advise();
+
+    /**
+     * \brief Schedule the event of the record under the cursor
+     */
+    void ScheduleNextTx();
+
+    /**
+     * \brief Send the records which are due and advance the cursor
+     */
+    void SendDue();
+
+    std::string m_traceFile;         //!< the name of the trace file
+    Address m_peer;                  //!< the address of the packet sink
+    uint16_t m_uPort;                //!< the port of the U-plane of radio unit 0
+    uint16_t m_cPort;                //!< the port of the C-plane of radio unit 0
+    double m_timeScale;              //!< the factor applied to the recorded times
+    uint32_t m_lookahead;            //!< the records prefetched after the cursor
+    Ptr<Socket> m_socket;            //!< the socket
+    uint8_t* m_map;                  //!< the mapped trace file
+    uint64_t m_mapSize;              //!< the size of the mapping
+    const OfhTraceRecord* m_records; //!< the records of the trace file
+    uint64_t m_nRecords;             //!< the number of records
+    uint64_t m_cursor;               //!< the next record to replay
+    uint64_t m_prefetched;           //!< the records prefetched so far
+    uint64_t m_released;             //!< the records released so far
+    Time m_origin;                   //!< the replay time of the first record
+    EventId m_sendEvent;             //!< the event of the record under the cursor
+
+    /// Traced Callback: transmitted packets.
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+
+    /// Callbacks for tracing the packet Tx events, includes the radio unit and the plane
+    TracedCallback<Ptr<const Packet>, uint32_t, uint8_t> m_txTraceWithRu;
+};
+
+} // namespace ns3
+
+#endif /* OFH_TRACE_REPLAY_APPLICATION_H */
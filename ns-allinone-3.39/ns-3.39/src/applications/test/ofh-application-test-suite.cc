@@ -0,0 +1,535 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/application-container.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ofh-application.h"
+#include "ns3/ofh-fleet-application.h"
+#include "ns3/ofh-helper.h"
+#include "ns3/ofh-sink.h"
+#include "ns3/ofh-timing-header.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks that the symbol-aligned mode sends one burst per symbol and plane,
+ * the C-plane bursts ahead of the U-plane ones.
+ */
+class OfhSymbolAlignedTestCase : public TestCase
+{
+  public:
+    OfhSymbolAlignedTestCase();
+    ~OfhSymbolAlignedTestCase() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Record the time of a packet sent
+     * \param p the packet
+     */
+    void SendTx(Ptr<const Packet> p);
+
+    std::vector<Time> m_uTimes; //!< times of the U-plane packets
+    std::vector<Time> m_cTimes; //!< times of the C-plane packets
+};
+
+OfhSymbolAlignedTestCase::OfhSymbolAlignedTestCase()
+    : TestCase("Check the symbol-aligned U-plane and C-plane bursts")
+{
+}
+
+OfhSymbolAlignedTestCase::~OfhSymbolAlignedTestCase()
+{
+}
+
+void
+OfhSymbolAlignedTestCase::SendTx(Ptr<const Packet> p)
+{
+    // the planes are told apart by their packet size
+    (p->GetSize() == 1000 ? m_uTimes : m_cTimes).push_back(Simulator::Now());
+}
+
+void
+OfhSymbolAlignedTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+
+    OfhHelper ofhHelper("ns3::UdpSocketFactory");
+    ofhHelper.SetAttribute("U-Plane", AddressValue(InetSocketAddress(i.GetAddress(1), 9)));
+    ofhHelper.SetAttribute("C-Plane", AddressValue(InetSocketAddress(i.GetAddress(1), 10)));
+    ofhHelper.SetAttribute("U-PacketSize", UintegerValue(1000));
+    ofhHelper.SetAttribute("C-PacketSize", UintegerValue(100));
+    ofhHelper.SetAttribute("SymbolAligned", BooleanValue(true));
+    ofhHelper.SetAttribute("Numerology", UintegerValue(1));
+    ofhHelper.SetAttribute("U-PacketsPerSymbol", UintegerValue(3));
+    ofhHelper.SetAttribute("C-Advance", TimeValue(MicroSeconds(100)));
+    ApplicationContainer apps = ofhHelper.Install(nodes.Get(0));
+    apps.Start(Seconds(0));
+    apps.Get(0)->TraceConnectWithoutContext(
+        "Tx",
+        MakeCallback(&OfhSymbolAlignedTestCase::SendTx, this));
+
+    // the U-plane bursts of the first slot, symbol 14 being at 600us
+    Simulator::Stop(MicroSeconds(590));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    // a 500us slot of 14 symbols
+    auto symbolTime = [](uint32_t n) {
+        return NanoSeconds((n / 14) * 500000 + (n % 14) * 500000 / 14);
+    };
+
+    NS_TEST_ASSERT_MSG_EQ(m_uTimes.size(), 14 * 3, "One burst of 3 packets per symbol");
+    for (uint32_t n = 0; n < m_uTimes.size(); n++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_uTimes[n],
+                              MicroSeconds(100) + symbolTime(n / 3),
+                              "U-plane packet " << n << " is not aligned on its symbol");
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(m_cTimes.size(), 17, "One C-plane packet per symbol up to 590us");
+    for (uint32_t n = 0; n < m_cTimes.size(); n++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_cTimes[n],
+                              symbolTime(n),
+                              "C-plane packet " << n << " is not 100us ahead of its symbol");
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks the rates, the byte limits and the On/Off periods of the radio units
+ * of an OfhFleetApplication.
+ */
+class OfhFleetTestCase : public TestCase
+{
+  public:
+    OfhFleetTestCase();
+    ~OfhFleetTestCase() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Record the time of a packet sent
+     * \param p the packet
+     * \param ru the radio unit
+     * \param plane the plane
+     */
+    void SendTx(Ptr<const Packet> p, uint32_t ru, uint8_t plane);
+
+    /// the times of the packets sent by each plane of each radio unit
+    std::map<std::pair<uint32_t, uint8_t>, std::vector<Time>> m_times;
+};
+
+OfhFleetTestCase::OfhFleetTestCase()
+    : TestCase("Check the radio units of a fleet")
+{
+}
+
+OfhFleetTestCase::~OfhFleetTestCase()
+{
+}
+
+void
+OfhFleetTestCase::SendTx(Ptr<const Packet> p, uint32_t ru, uint8_t plane)
+{
+    m_times[{ru, plane}].push_back(Simulator::Now());
+}
+
+void
+OfhFleetTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+
+    Ptr<OfhFleetApplication> fleet = CreateObject<OfhFleetApplication>();
+    nodes.Get(0)->AddApplication(fleet);
+
+    // a packet per millisecond on both planes
+    OfhFleetApplication::PlaneConfig uPlane;
+    uPlane.peer = InetSocketAddress(i.GetAddress(1), 8080);
+    uPlane.rate = DataRate("8Mbps");
+    uPlane.packetSize = 1000;
+    OfhFleetApplication::PlaneConfig cPlane;
+    cPlane.peer = InetSocketAddress(i.GetAddress(1), 9090);
+    cPlane.rate = DataRate("800kbps");
+    cPlane.packetSize = 100;
+    fleet->AddRu(uPlane, cPlane);
+
+    // three packets two milliseconds apart, no C-plane
+    uPlane.peer = InetSocketAddress(i.GetAddress(1), 8081);
+    uPlane.rate = DataRate("4Mbps");
+    uPlane.maxBytes = 3000;
+    cPlane.rate = DataRate(0);
+    fleet->AddRu(uPlane, cPlane);
+
+    // 2ms On and 1ms Off periods, starting at 0.5ms
+    uPlane.peer = InetSocketAddress(i.GetAddress(1), 8082);
+    uPlane.rate = DataRate("8Mbps");
+    uPlane.maxBytes = 0;
+    uPlane.onTime = MilliSeconds(2);
+    uPlane.offTime = MilliSeconds(1);
+    fleet->AddRu(uPlane, cPlane, MicroSeconds(500));
+
+    fleet->SetStartTime(Seconds(0));
+    fleet->TraceConnectWithoutContext("TxWithRu", MakeCallback(&OfhFleetTestCase::SendTx, this));
+
+    Simulator::Stop(MicroSeconds(10200));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(fleet->GetNRus(), 3, "Three radio units were added");
+    using Key = std::pair<uint32_t, uint8_t>;
+    std::vector<Time>& ru0 = m_times[Key(0, OfhFleetApplication::U_PLANE)];
+    NS_TEST_ASSERT_MSG_EQ(ru0.size(), 10, "A U-plane packet per millisecond");
+    for (uint32_t n = 0; n < ru0.size(); n++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(ru0[n], MilliSeconds(n + 1), "Wrong time of packet " << n);
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_times[Key(0, OfhFleetApplication::C_PLANE)].size(),
+                          10,
+                          "A C-plane packet per millisecond");
+    NS_TEST_EXPECT_MSG_EQ(fleet->GetTotalTx(0, OfhFleetApplication::C_PLANE),
+                          1000,
+                          "Ten C-plane packets of 100 bytes");
+
+    std::vector<Time> expected{MilliSeconds(2), MilliSeconds(4), MilliSeconds(6)};
+    NS_TEST_EXPECT_MSG_EQ((m_times[Key(1, OfhFleetApplication::U_PLANE)] == expected),
+                          true,
+                          "The second radio unit stops at its byte limit");
+    NS_TEST_EXPECT_MSG_EQ(m_times.count(Key(1, OfhFleetApplication::C_PLANE)),
+                          0,
+                          "A plane without rate sends nothing");
+
+    expected = {MicroSeconds(1500),
+                MicroSeconds(2500),
+                MicroSeconds(4500),
+                MicroSeconds(5500),
+                MicroSeconds(7500),
+                MicroSeconds(8500)};
+    NS_TEST_EXPECT_MSG_EQ((m_times[Key(2, OfhFleetApplication::U_PLANE)] == expected),
+                          true,
+                          "The third radio unit sends nothing in its Off periods");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks that the prototype packets are copies of one payload per plane and
+ * are received whole, with their SeqTsSizeHeader.
+ */
+class OfhPrototypePacketsTestCase : public TestCase
+{
+  public:
+    OfhPrototypePacketsTestCase();
+    ~OfhPrototypePacketsTestCase() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Record a packet sent
+     * \param p the packet
+     */
+    void SendTx(Ptr<const Packet> p);
+
+    std::vector<uint64_t> m_uUids; //!< uids of the U-plane packets
+    std::vector<uint64_t> m_cUids; //!< uids of the C-plane packets
+};
+
+OfhPrototypePacketsTestCase::OfhPrototypePacketsTestCase()
+    : TestCase("Check the prototype packets")
+{
+}
+
+OfhPrototypePacketsTestCase::~OfhPrototypePacketsTestCase()
+{
+}
+
+void
+OfhPrototypePacketsTestCase::SendTx(Ptr<const Packet> p)
+{
+    (p->GetSize() == 1000 ? m_uUids : m_cUids).push_back(p->GetUid());
+}
+
+void
+OfhPrototypePacketsTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+
+    PacketSinkHelper sinkHelper("ns3::UdpSocketFactory",
+                                InetSocketAddress(Ipv4Address::GetAny(), 9));
+    sinkHelper.SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+    Ptr<PacketSink> sink = DynamicCast<PacketSink>(sinkHelper.Install(nodes.Get(1)).Get(0));
+
+    // a U-plane and a C-plane packet per millisecond
+    OfhHelper ofhHelper("ns3::UdpSocketFactory");
+    ofhHelper.SetAttribute("U-Plane", AddressValue(InetSocketAddress(i.GetAddress(1), 9)));
+    ofhHelper.SetAttribute("C-Plane", AddressValue(InetSocketAddress(i.GetAddress(1), 10)));
+    ofhHelper.SetAttribute("U-DataRate", StringValue("8Mbps"));
+    ofhHelper.SetAttribute("U-PacketSize", UintegerValue(1000));
+    ofhHelper.SetAttribute("C-DataRate", StringValue("800kbps"));
+    ofhHelper.SetAttribute("C-PacketSize", UintegerValue(100));
+    ofhHelper.SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+    ofhHelper.SetAttribute("PrototypePackets", BooleanValue(true));
+    ApplicationContainer apps = ofhHelper.Install(nodes.Get(0));
+    apps.Start(Seconds(0));
+    apps.Get(0)->TraceConnectWithoutContext(
+        "Tx",
+        MakeCallback(&OfhPrototypePacketsTestCase::SendTx, this));
+
+    Simulator::Stop(MicroSeconds(10500));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(m_uUids.size(), 10, "A U-plane packet per millisecond");
+    NS_TEST_ASSERT_MSG_EQ(m_cUids.size(), 10, "A C-plane packet per millisecond");
+    for (uint32_t n = 1; n < m_uUids.size(); n++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_uUids[n], m_uUids[0], "U-plane packet " << n << " is not a copy");
+        NS_TEST_EXPECT_MSG_EQ(m_cUids[n], m_cUids[0], "C-plane packet " << n << " is not a copy");
+    }
+    NS_TEST_EXPECT_MSG_NE(m_uUids[0], m_cUids[0], "Each plane has its own prototype");
+    // the first packets may be lost while ARP resolves the sink address
+    NS_TEST_EXPECT_MSG_GT(sink->GetTotalRx(), 0, "The U-plane packets should be received");
+    NS_TEST_EXPECT_MSG_EQ(sink->GetTotalRx() % 1000, 0, "The U-plane packets are received whole");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks that an OfhSink classifies the packets stamped with an
+ * OfhTimingHeader against the reception windows of their plane, and counts
+ * the packets without a valid one as malformed.
+ */
+class OfhSinkTestCase : public TestCase
+{
+  public:
+    OfhSinkTestCase();
+    ~OfhSinkTestCase() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Send a packet
+     * \param node the node to send from
+     * \param peer the address of the sink
+     * \param packet the packet
+     */
+    static void Send(Ptr<Node> node, Address peer, Ptr<Packet> packet);
+};
+
+OfhSinkTestCase::OfhSinkTestCase()
+    : TestCase("Check the reception windows of the OfhSink")
+{
+}
+
+OfhSinkTestCase::~OfhSinkTestCase()
+{
+}
+
+void
+OfhSinkTestCase::Send(Ptr<Node> node, Address peer, Ptr<Packet> packet)
+{
+    Ptr<Socket> socket = Socket::CreateSocket(node, UdpSocketFactory::GetTypeId());
+    socket->Connect(peer);
+    socket->Send(packet);
+}
+
+void
+OfhSinkTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetChannelAttribute("Delay", TimeValue(MicroSeconds(50)));
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+
+    // the U-plane packets arrive 50us after their symbol, past its window,
+    // the C-plane ones 50us before, in the 16th bin of 10us of their window
+    std::string summaryFile = CreateTempDirFilename("ofh-sink.summary");
+    Ptr<OfhSink> sink = CreateObjectWithAttributes<OfhSink>("U-Ta4Min",
+                                                            TimeValue(Time(0)),
+                                                            "U-Ta4Max",
+                                                            TimeValue(MicroSeconds(40)),
+                                                            "C-Ta4Min",
+                                                            TimeValue(MicroSeconds(-200)),
+                                                            "C-Ta4Max",
+                                                            TimeValue(Time(0)),
+                                                            "SummaryFile",
+                                                            StringValue(summaryFile));
+    sink->AddLocal(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    sink->AddLocal(InetSocketAddress(Ipv4Address::GetAny(), 10));
+    nodes.Get(1)->AddApplication(sink);
+    sink->SetStopTime(MilliSeconds(19));
+
+    OfhHelper ofhHelper("ns3::UdpSocketFactory");
+    ofhHelper.SetAttribute("U-Plane", AddressValue(InetSocketAddress(i.GetAddress(1), 9)));
+    ofhHelper.SetAttribute("C-Plane", AddressValue(InetSocketAddress(i.GetAddress(1), 10)));
+    ofhHelper.SetAttribute("U-PacketSize", UintegerValue(1000));
+    ofhHelper.SetAttribute("C-PacketSize", UintegerValue(100));
+    ofhHelper.SetAttribute("SymbolAligned", BooleanValue(true));
+    ofhHelper.SetAttribute("U-PacketsPerSymbol", UintegerValue(1));
+    ofhHelper.SetAttribute("C-Advance", TimeValue(MicroSeconds(100)));
+    ofhHelper.SetAttribute("EnableTimingHeader", BooleanValue(true));
+    ofhHelper.SetAttribute("RuId", UintegerValue(3));
+    ApplicationContainer apps = ofhHelper.Install(nodes.Get(0));
+    apps.Start(Seconds(0));
+
+    // once ARP resolved the sink address, the zero payloads an OfhApplication
+    // sends without OfhTimingHeader and a packet of an unknown plane
+    Address uPeer = InetSocketAddress(i.GetAddress(1), 9);
+    Address cPeer = InetSocketAddress(i.GetAddress(1), 10);
+    Simulator::Schedule(MilliSeconds(10), &Send, nodes.Get(0), uPeer, Create<Packet>(1000));
+    Simulator::Schedule(MilliSeconds(10), &Send, nodes.Get(0), cPeer, Create<Packet>(100));
+    OfhTimingHeader header;
+    header.SetRu(3);
+    header.SetPlane(2);
+    header.SetSymbolTime(MilliSeconds(10));
+    Ptr<Packet> unknownPlane = Create<Packet>(100);
+    unknownPlane->AddHeader(header);
+    Simulator::Schedule(MilliSeconds(10), &Send, nodes.Get(0), uPeer, unknownPlane);
+
+    Simulator::Stop(MilliSeconds(20));
+    Simulator::Run();
+
+    // the first packets may be delayed while ARP resolves the sink address
+    OfhSink::Stats u = sink->GetStats(3, OfhTimingHeader::U_PLANE);
+    NS_TEST_EXPECT_MSG_GT(u.packets, 0, "The U-plane packets should be received");
+    NS_TEST_EXPECT_MSG_EQ(u.bytes, u.packets * 1000, "The U-plane packets are received whole");
+    NS_TEST_EXPECT_MSG_EQ(u.late, u.packets, "The U-plane packets should be late");
+    NS_TEST_EXPECT_MSG_EQ(u.minOffset, MicroSeconds(50), "Wrong smallest U-plane offset");
+
+    OfhSink::Stats c = sink->GetStats(3, OfhTimingHeader::C_PLANE);
+    NS_TEST_EXPECT_MSG_GT(c.packets, 0, "The C-plane packets should be received");
+    NS_TEST_EXPECT_MSG_EQ(c.early, 0, "No C-plane packet should be early");
+    NS_TEST_EXPECT_MSG_GT(c.onTime, 0, "The C-plane packets should be on time");
+    NS_TEST_EXPECT_MSG_EQ(c.early + c.onTime + c.late, c.packets, "Every packet is classified");
+    NS_TEST_EXPECT_MSG_EQ(c.minOffset, MicroSeconds(-50), "Wrong smallest C-plane offset");
+    NS_TEST_ASSERT_MSG_EQ(c.bins.size(), 20, "Wrong number of bins");
+    NS_TEST_EXPECT_MSG_EQ(std::accumulate(c.bins.begin(), c.bins.end(), uint64_t(0)),
+                          c.onTime,
+                          "The histogram counts the packets on time");
+    NS_TEST_EXPECT_MSG_GT(c.bins[15], 0, "The C-plane packets should arrive 50us early");
+
+    NS_TEST_EXPECT_MSG_EQ(sink->GetStats(0, OfhTimingHeader::U_PLANE).packets,
+                          0,
+                          "No packet of another radio unit");
+    NS_TEST_EXPECT_MSG_EQ(sink->GetStats(3, 2).packets, 0, "No packet of an unknown plane");
+    NS_TEST_EXPECT_MSG_EQ(sink->GetNMalformed(), 3, "Wrong number of malformed packets");
+
+    // a comment line, a line per plane and the malformed packets
+    std::ifstream in(summaryFile);
+    NS_TEST_ASSERT_MSG_EQ(in.is_open(), true, "The summary should be written at the stop");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+    {
+        lines.push_back(line);
+    }
+    NS_TEST_ASSERT_MSG_EQ(lines.size(), 4, "Wrong number of summary lines");
+    NS_TEST_EXPECT_MSG_EQ(lines[1].rfind("3 0 " + std::to_string(u.packets) + " ", 0),
+                          0,
+                          "Wrong U-plane summary");
+    NS_TEST_EXPECT_MSG_EQ(lines[2].rfind("3 1 " + std::to_string(c.packets) + " ", 0),
+                          0,
+                          "Wrong C-plane summary");
+    NS_TEST_EXPECT_MSG_EQ(lines[3], "# malformed 3", "Wrong malformed summary");
+    in.close();
+
+    Simulator::Destroy();
+    std::remove(summaryFile.c_str());
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief OfhApplication TestSuite
+ */
+class OfhApplicationTestSuite : public TestSuite
+{
+  public:
+    OfhApplicationTestSuite();
+};
+
+OfhApplicationTestSuite::OfhApplicationTestSuite()
+    : TestSuite("ofh-application", UNIT)
+{
+    AddTestCase(new OfhSymbolAlignedTestCase, TestCase::QUICK);
+    AddTestCase(new OfhFleetTestCase, TestCase::QUICK);
+    AddTestCase(new OfhPrototypePacketsTestCase, TestCase::QUICK);
+    AddTestCase(new OfhSinkTestCase, TestCase::QUICK);
+}
+
+static OfhApplicationTestSuite g_ofhApplicationTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,288 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/node-container.h"
+#include "ns3/ofh-trace-replay-application.h"
+#include "ns3/pcap-file.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/trace-helper.h"
+#include "ns3/uinteger.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks that the records of a trace file are replayed in order, at their
+ * scaled times, by radio unit and plane.
+ */
+class OfhTraceReplayTestCase : public TestCase
+{
+  public:
+    OfhTraceReplayTestCase();
+    ~OfhTraceReplayTestCase() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Record a packet sent
+     * \param p the packet
+     * \param ru the radio unit
+     * \param plane the plane
+     */
+    void SendTx(Ptr<const Packet> p, uint32_t ru, uint8_t plane);
+
+    /// A packet sent
+    struct Sent
+    {
+        Time time;     //!< the time it was sent
+        uint32_t size; //!< its size
+        uint32_t ru;   //!< its radio unit
+        uint8_t plane; //!< its plane
+    };
+
+    std::vector<Sent> m_sent; //!< the packets sent
+};
+
+OfhTraceReplayTestCase::OfhTraceReplayTestCase()
+    : TestCase("Check the replay of a trace file")
+{
+}
+
+OfhTraceReplayTestCase::~OfhTraceReplayTestCase()
+{
+}
+
+void
+OfhTraceReplayTestCase::SendTx(Ptr<const Packet> p, uint32_t ru, uint8_t plane)
+{
+    m_sent.push_back({Simulator::Now(), p->GetSize(), ru, plane});
+}
+
+void
+OfhTraceReplayTestCase::DoRun()
+{
+    // two radio units, captured 1000s after the epoch, a record older than
+    // the first one being sent with the records due when it is reached
+    const uint64_t base = 1000000000000ULL;
+    std::vector<OfhTraceRecord> records{{base, 1000, 1, 0, 0, 0},
+                                        {base + 500000, 100, 2, 1, 1, 0},
+                                        {base + 1000000, 1000, 1, 0, 0, 0},
+                                        {base + 1000000, 1200, 1, 0, 0, 0},
+                                        {base - 1000, 500, 1, 0, 0, 0},
+                                        {base + 2000000, 800, 3, 0, 1, 0}};
+    OfhTraceFileHeader header{OfhTraceFileHeader::MAGIC,
+                              OfhTraceFileHeader::VERSION,
+                              sizeof(OfhTraceRecord),
+                              records.size()};
+    std::string traceFile = CreateTempDirFilename("ofh-replay.trace");
+    std::ofstream out(traceFile, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()),
+              records.size() * sizeof(OfhTraceRecord));
+    out.close();
+
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+
+    // replayed twice slower, starting at 1ms
+    Ptr<OfhTraceReplayApplication> replay =
+        CreateObjectWithAttributes<OfhTraceReplayApplication>("TraceFile",
+                                                              StringValue(traceFile),
+                                                              "RemoteAddress",
+                                                              AddressValue(i.GetAddress(1)),
+                                                              "TimeScale",
+                                                              DoubleValue(2),
+                                                              "Lookahead",
+                                                              UintegerValue(2));
+    nodes.Get(0)->AddApplication(replay);
+    replay->SetStartTime(MilliSeconds(1));
+    replay->TraceConnectWithoutContext("TxWithRu",
+                                       MakeCallback(&OfhTraceReplayTestCase::SendTx, this));
+
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(replay->GetNRecords(), 6, "The trace file has six records");
+    NS_TEST_EXPECT_MSG_EQ(replay->GetNReplayed(), 6, "All the records should be replayed");
+    std::vector<Time> times{MilliSeconds(1),
+                            MilliSeconds(2),
+                            MilliSeconds(3),
+                            MilliSeconds(3),
+                            MilliSeconds(3),
+                            MilliSeconds(5)};
+    NS_TEST_ASSERT_MSG_EQ(m_sent.size(), records.size(), "A packet per record");
+    for (uint32_t n = 0; n < m_sent.size(); n++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_sent[n].time, times[n], "Wrong time of record " << n);
+        NS_TEST_EXPECT_MSG_EQ(m_sent[n].size, records[n].size, "Wrong size of record " << n);
+        NS_TEST_EXPECT_MSG_EQ(m_sent[n].ru, +records[n].ru, "Wrong radio unit of record " << n);
+        NS_TEST_EXPECT_MSG_EQ(+m_sent[n].plane, +records[n].plane, "Wrong plane of record " << n);
+    }
+
+    Simulator::Destroy();
+    std::remove(traceFile.c_str());
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks the conversion of an eCPRI capture to a trace file.
+ */
+class OfhTraceConvertPcapTestCase : public TestCase
+{
+  public:
+    OfhTraceConvertPcapTestCase();
+    ~OfhTraceConvertPcapTestCase() override;
+
+  private:
+    void DoRun() override;
+};
+
+OfhTraceConvertPcapTestCase::OfhTraceConvertPcapTestCase()
+    : TestCase("Check the conversion of an eCPRI capture")
+{
+}
+
+OfhTraceConvertPcapTestCase::~OfhTraceConvertPcapTestCase()
+{
+}
+
+/**
+ * Build an Ethernet frame
+ * \param srcMac the last byte of the source MAC address
+ * \param etherType the EtherType
+ * \param vlan whether the frame has a VLAN tag
+ * \param messageType the eCPRI message type
+ * \param eAxC the eCPRI PC_ID/RTC_ID
+ * \param size the size of the frame
+ * \return the frame
+ */
+static std::vector<uint8_t>
+MakeFrame(uint8_t srcMac,
+          uint16_t etherType,
+          bool vlan,
+          uint8_t messageType,
+          uint16_t eAxC,
+          uint32_t size)
+{
+    std::vector<uint8_t> frame(size, 0);
+    frame[11] = srcMac;
+    uint32_t offset = 12;
+    if (vlan)
+    {
+        frame[offset++] = 0x81;
+        frame[offset++] = 0x00;
+        offset += 2;
+    }
+    frame[offset++] = etherType >> 8;
+    frame[offset++] = etherType & 0xff;
+    frame[offset] = 0x10;
+    frame[offset + 1] = messageType;
+    frame[offset + 4] = eAxC >> 8;
+    frame[offset + 5] = eAxC & 0xff;
+    return frame;
+}
+
+void
+OfhTraceConvertPcapTestCase::DoRun()
+{
+    std::string pcapFile = CreateTempDirFilename("ofh-capture.pcap");
+    std::string traceFile = CreateTempDirFilename("ofh-capture.trace");
+    PcapFile pcap;
+    pcap.Open(pcapFile, std::ios::out);
+    pcap.Init(PcapHelper::DLT_EN10MB);
+    std::vector<uint8_t> frame = MakeFrame(1, 0xAEFE, true, 0, 0x0102, 1000);
+    pcap.Write(10, 0, frame.data(), frame.size());
+    frame = MakeFrame(2, 0x0800, false, 0, 0, 200);
+    pcap.Write(10, 5, frame.data(), frame.size());
+    frame = MakeFrame(2, 0xAEFE, false, 2, 0x0304, 100);
+    pcap.Write(10, 30, frame.data(), frame.size());
+    // a frame captured out of order
+    frame = MakeFrame(1, 0xAEFE, false, 0, 0x0102, 900);
+    pcap.Write(10, 20, frame.data(), frame.size());
+    pcap.Close();
+
+    NS_TEST_ASSERT_MSG_EQ(OfhTraceReplayApplication::ConvertPcap(pcapFile, traceFile),
+                          3,
+                          "The eCPRI frames should be converted");
+
+    std::ifstream in(traceFile, std::ios::binary);
+    OfhTraceFileHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    NS_TEST_EXPECT_MSG_EQ(header.magic, OfhTraceFileHeader::MAGIC, "Wrong magic");
+    NS_TEST_ASSERT_MSG_EQ(header.nRecords, 3, "Wrong number of records");
+    std::vector<OfhTraceRecord> records(3);
+    in.read(reinterpret_cast<char*>(records.data()), 3 * sizeof(OfhTraceRecord));
+    NS_TEST_ASSERT_MSG_EQ(in.good(), true, "The records should be read");
+
+    // timestamps, sizes from the eCPRI header on, eAxC, planes and radio units
+    NS_TEST_EXPECT_MSG_EQ(records[0].timestamp, 10000000000ULL, "Wrong timestamp");
+    NS_TEST_EXPECT_MSG_EQ(records[1].timestamp, 10000020000ULL, "Records are sorted");
+    NS_TEST_EXPECT_MSG_EQ(records[2].timestamp, 10000030000ULL, "Wrong timestamp");
+    NS_TEST_EXPECT_MSG_EQ(records[0].size, 1000 - 18, "The VLAN tag is skipped");
+    NS_TEST_EXPECT_MSG_EQ(records[1].size, 900 - 14, "Wrong size");
+    NS_TEST_EXPECT_MSG_EQ(records[0].eAxC, 0x0102, "Wrong eAxC");
+    NS_TEST_EXPECT_MSG_EQ(records[2].eAxC, 0x0304, "Wrong eAxC");
+    NS_TEST_EXPECT_MSG_EQ(+records[0].plane, 0, "IQ data is U-plane");
+    NS_TEST_EXPECT_MSG_EQ(+records[2].plane, 1, "Real-time control is C-plane");
+    NS_TEST_EXPECT_MSG_EQ(+records[1].ru, 0, "The first MAC address is radio unit 0");
+    NS_TEST_EXPECT_MSG_EQ(+records[2].ru, 1, "The second MAC address is radio unit 1");
+
+    in.close();
+    std::remove(pcapFile.c_str());
+    std::remove(traceFile.c_str());
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief OfhTraceReplayApplication TestSuite
+ */
+class OfhTraceReplayTestSuite : public TestSuite
+{
+  public:
+    OfhTraceReplayTestSuite();
+};
+
+OfhTraceReplayTestSuite::OfhTraceReplayTestSuite()
+    : TestSuite("ofh-trace-replay", UNIT)
+{
+    AddTestCase(new OfhTraceReplayTestCase, TestCase::QUICK);
+    AddTestCase(new OfhTraceConvertPcapTestCase, TestCase::QUICK);
+}
+
+static OfhTraceReplayTestSuite g_ofhTraceReplayTestSuite; //!< Static variable for test initialization
@@ -17,7 +17,6 @@
 
 #include "ipv4-queue-disc-item.h"
 
-#include "tcp-header.h"
 #include "udp-header.h"
 
 #include "ns3/log.h"
@@ -62,6 +61,15 @@ Ipv4QueueDiscItem::GetHeader() const
     return m_header;
 }
 
+void
+Ipv4QueueDiscItem::SetDscp(Ipv4Header::DscpType dscp)
+{
+    NS_LOG_FUNCTION(this << dscp);
+    NS_ASSERT_MSG(!m_headerAdded, "The header has already been added to the packet");
+    m_header.SetDscp(dscp);
+    UpdateClassKeyDscp(dscp);
+}
+
 void
 Ipv4QueueDiscItem::AddHeader()
 {
@@ -115,47 +123,44 @@ Ipv4QueueDiscItem::GetUint8Value(QueueItem::Uint8Values field, uint8_t& value) c
     return ret;
 }
 
-uint32_t
-Ipv4QueueDiscItem::Hash(uint32_t perturbation) const
+bool
+Ipv4QueueDiscItem::SetUint8Value(QueueItem::Uint8Values field, uint8_t value)
 {
-    NS_LOG_FUNCTION(this << perturbation);
-
-    Ipv4Address src = m_header.GetSource();
-    Ipv4Address dest = m_header.GetDestination();
-    uint8_t prot = m_header.GetProtocol();
-    uint16_t fragOffset = m_header.GetFragmentOffset();
-
-    TcpHeader tcpHdr;
-    UdpHeader udpHdr;
-    uint16_t srcPort = 0;
-    uint16_t destPort = 0;
+    NS_LOG_FUNCTION(this << +value);
+    NS_ASSERT_MSG(!m_headerAdded, "The header has already been added to the packet");
+    bool ret = false;
 
-    if (prot == 6 && fragOffset == 0) // TCP
-    {
-        GetPacket()->PeekHeader(tcpHdr);
-        srcPort = tcpHdr.GetSourcePort();
-        destPort = tcpHdr.GetDestinationPort();
-    }
-    else if (prot == 17 && fragOffset == 0) // UDP
-    {
-        GetPacket()->PeekHeader(udpHdr);
-        srcPort = udpHdr.GetSourcePort();
-        destPort = udpHdr.GetDestinationPort();
-    }
-    if (prot != 6 && prot != 17)
+    switch (field)
     {
-        NS_LOG_WARN("Unknown transport protocol, no port number included in hash computation");
+    case IP_DSFIELD:
+        m_header.SetTos(value);
+        UpdateClassKeyDscp(value >> 2);
+        ret = true;
+        break;
     }
 
+    return ret;
+}
+
+uint32_t
+Ipv4QueueDiscItem::Hash(uint32_t perturbation) const
+{
+    NS_LOG_FUNCTION(this << perturbation);
+    return HashFiveTuple(GetClassKey(), perturbation);
+}
+
+uint32_t
+Ipv4QueueDiscItem::HashFiveTuple(const ClassKey& key, uint32_t perturbation) const
+{
     /* serialize the 5-tuple and the perturbation in buf */
     uint8_t buf[17];
-    src.Serialize(buf);
-    dest.Serialize(buf + 4);
-    buf[8] = prot;
-    buf[9] = (srcPort >> 8) & 0xff;
-    buf[10] = srcPort & 0xff;
-    buf[11] = (destPort >> 8) & 0xff;
-    buf[12] = destPort & 0xff;
+    m_header.GetSource().Serialize(buf);
+    m_header.GetDestination().Serialize(buf + 4);
+    buf[8] = key.l4Protocol;
+    buf[9] = (key.srcPort >> 8) & 0xff;
+    buf[10] = key.srcPort & 0xff;
+    buf[11] = (key.dstPort >> 8) & 0xff;
+    buf[12] = key.dstPort & 0xff;
     buf[13] = (perturbation >> 24) & 0xff;
     buf[14] = (perturbation >> 16) & 0xff;
     buf[15] = (perturbation >> 8) & 0xff;
@@ -170,4 +175,29 @@ Ipv4QueueDiscItem::Hash(uint32_t perturbation) const
     return hash;
 }
 
+void
+Ipv4QueueDiscItem::ComputeClassKey(ClassKey& key) const
+{
+    NS_LOG_FUNCTION(this);
+
+    key.ip = true;
+    key.dscp = m_header.GetDscp();
+    key.l4Protocol = m_header.GetProtocol();
+
+    // TCP and UDP share the layout of the ports, so peeking a UDP header (without
+    // copying the packet) gives the ports of both
+    if ((key.l4Protocol == 6 || key.l4Protocol == 17) && m_header.GetFragmentOffset() == 0)
+    {
+        UdpHeader udpHdr;
+        GetPacket()->PeekHeader(udpHdr);
+        key.srcPort = udpHdr.GetSourcePort();
+        key.dstPort = udpHdr.GetDestinationPort();
+    }
+    if (key.l4Protocol != 6 && key.l4Protocol != 17)
+    {
+        NS_LOG_WARN("Unknown transport protocol, no port number included in hash computation");
+    }
+    key.flowHash = HashFiveTuple(key, 0);
+}
+
 } // namespace ns3
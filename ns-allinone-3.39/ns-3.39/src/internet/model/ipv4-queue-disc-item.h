@@ -66,6 +66,14 @@ class Ipv4QueueDiscItem : public QueueDiscItem
      */
     const Ipv4Header& GetHeader() const;
 
+    /**
+     * \brief Rewrite the DSCP of the header stored in this item, in place.
+     *
+     * The header must not have been added to the packet yet.
+     * \param dscp the new DSCP value
+     */
+    void SetDscp(Ipv4Header::DscpType dscp);
+
     /**
      * \brief Add the header to the packet
      */
@@ -86,6 +94,14 @@ class Ipv4QueueDiscItem : public QueueDiscItem
      */
     bool GetUint8Value(Uint8Values field, uint8_t& value) const override;
 
+    /**
+     * \brief Rewrite the value of a given field of the header stored in this item
+     * \param field the field whose value has to be rewritten
+     * \param value the new value
+     * \return true if the requested field is present in the header, false otherwise.
+     */
+    bool SetUint8Value(Uint8Values field, uint8_t value) override;
+
     /**
      * \brief Marks the packet by setting ECN_CE bits if the packet has
      * ECN_ECT0 or ECN_ECT1 set.  If ECN_CE is already set, returns true.
@@ -105,7 +121,23 @@ class Ipv4QueueDiscItem : public QueueDiscItem
      */
     uint32_t Hash(uint32_t perturbation) const override;
 
+  protected:
+    /**
+     * \brief Read the DSCP, the protocol and, if the transport protocol is
+     * either UDP or TCP, the ports, and hash the 5-tuple
+     * \param key the classification fields to set
+     */
+    void ComputeClassKey(ClassKey& key) const override;
+
   private:
+    /**
+     * \brief Hash the addresses of the header and the L4 fields of a key
+     * \param key the classification fields of the packet
+     * \param perturbation hash perturbation value
+     * \return the hash of the packet's 5-tuple
+     */
+    uint32_t HashFiveTuple(const ClassKey& key, uint32_t perturbation) const;
+
     Ipv4Header m_header; //!< The IPv4 header.
     bool m_headerAdded;  //!< True if the header has already been added to the packet.
 };
@@ -17,7 +17,6 @@
 
 #include "ipv6-queue-disc-item.h"
 
-#include "tcp-header.h"
 #include "udp-header.h"
 
 #include "ns3/log.h"
@@ -115,46 +114,44 @@ Ipv6QueueDiscItem::GetUint8Value(QueueItem::Uint8Values field, uint8_t& value) c
     return ret;
 }
 
-uint32_t
-Ipv6QueueDiscItem::Hash(uint32_t perturbation) const
+bool
+Ipv6QueueDiscItem::SetUint8Value(QueueItem::Uint8Values field, uint8_t value)
 {
-    NS_LOG_FUNCTION(this << perturbation);
-
-    Ipv6Address src = m_header.GetSource();
-    Ipv6Address dest = m_header.GetDestination();
-    uint8_t prot = m_header.GetNextHeader();
-
-    TcpHeader tcpHdr;
-    UdpHeader udpHdr;
-    uint16_t srcPort = 0;
-    uint16_t destPort = 0;
+    NS_LOG_FUNCTION(this << +value);
+    NS_ASSERT_MSG(!m_headerAdded, "The header has already been added to the packet");
+    bool ret = false;
 
-    if (prot == 6) // TCP
-    {
-        GetPacket()->PeekHeader(tcpHdr);
-        srcPort = tcpHdr.GetSourcePort();
-        destPort = tcpHdr.GetDestinationPort();
-    }
-    else if (prot == 17) // UDP
-    {
-        GetPacket()->PeekHeader(udpHdr);
-        srcPort = udpHdr.GetSourcePort();
-        destPort = udpHdr.GetDestinationPort();
-    }
-    if (prot != 6 && prot != 17)
+    switch (field)
     {
-        NS_LOG_WARN("Unknown transport protocol, no port number included in hash computation");
+    case IP_DSFIELD:
+        m_header.SetTrafficClass(value);
+        UpdateClassKeyDscp(value >> 2);
+        ret = true;
+        break;
     }
 
+    return ret;
+}
+
+uint32_t
+Ipv6QueueDiscItem::Hash(uint32_t perturbation) const
+{
+    NS_LOG_FUNCTION(this << perturbation);
+    return HashFiveTuple(GetClassKey(), perturbation);
+}
+
+uint32_t
+Ipv6QueueDiscItem::HashFiveTuple(const ClassKey& key, uint32_t perturbation) const
+{
     /* serialize the 5-tuple and the perturbation in buf */
     uint8_t buf[41];
-    src.Serialize(buf);
-    dest.Serialize(buf + 16);
-    buf[32] = prot;
-    buf[33] = (srcPort >> 8) & 0xff;
-    buf[34] = srcPort & 0xff;
-    buf[35] = (destPort >> 8) & 0xff;
-    buf[36] = destPort & 0xff;
+    m_header.GetSource().Serialize(buf);
+    m_header.GetDestination().Serialize(buf + 16);
+    buf[32] = key.l4Protocol;
+    buf[33] = (key.srcPort >> 8) & 0xff;
+    buf[34] = key.srcPort & 0xff;
+    buf[35] = (key.dstPort >> 8) & 0xff;
+    buf[36] = key.dstPort & 0xff;
     buf[37] = (perturbation >> 24) & 0xff;
     buf[38] = (perturbation >> 16) & 0xff;
     buf[39] = (perturbation >> 8) & 0xff;
@@ -169,4 +166,29 @@ Ipv6QueueDiscItem::Hash(uint32_t perturbation) const
     return hash;
 }
 
+void
+Ipv6QueueDiscItem::ComputeClassKey(ClassKey& key) const
+{
+    NS_LOG_FUNCTION(this);
+
+    key.ip = true;
+    key.dscp = m_header.GetDscp();
+    key.l4Protocol = m_header.GetNextHeader();
+
+    // TCP and UDP share the layout of the ports, so peeking a UDP header (without
+    // copying the packet) gives the ports of both
+    if (key.l4Protocol == 6 || key.l4Protocol == 17)
+    {
+        UdpHeader udpHdr;
+        GetPacket()->PeekHeader(udpHdr);
+        key.srcPort = udpHdr.GetSourcePort();
+        key.dstPort = udpHdr.GetDestinationPort();
+    }
+    else
+    {
+        NS_LOG_WARN("Unknown transport protocol, no port number included in hash computation");
+    }
+    key.flowHash = HashFiveTuple(key, 0);
+}
+
 } // namespace ns3
@@ -42,6 +42,7 @@ NetDeviceQueue::GetTypeId()
 NetDeviceQueue::NetDeviceQueue()
     : m_stoppedByDevice(false),
       m_stoppedByQueueLimits(false),
+      m_dequeuedBytes(0),
       NS_LOG_TEMPLATE_DEFINE("NetDeviceQueueInterface")
 {
     NS_LOG_FUNCTION(this);
@@ -51,6 +52,7 @@ NetDeviceQueue::~NetDeviceQueue()
 {
     NS_LOG_FUNCTION(this);
 
+    m_dequeuedEvent.Cancel();
     m_queueLimits = nullptr;
     m_wakeCallback.Nullify();
     m_device = nullptr;
@@ -210,6 +210,8 @@ class NetDeviceQueue : public Object
     Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
     WakeCallback m_wakeCallback;    //!< Wake callback
     Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+    uint32_t m_dequeuedBytes;       //!< Bytes dequeued and not yet reported to BQL
+    EventId m_dequeuedEvent;        //!< Event reporting the dequeued bytes
 
     NS_LOG_TEMPLATE_DECLARE; //!< redefinition of the log component
 };
@@ -364,9 +366,19 @@ NetDeviceQueue::PacketDequeued(QueueType* queue, Ptr<const typename QueueType::I
     NS_LOG_FUNCTION(this << queue << item);
     NS_ASSERT_MSG(m_device, "Aggregated NetDevice not set");
 
-    Simulator::ScheduleNow([=]() {
+    // The packets dequeued at once (e.g., a batch sent back to back by the
+    // device) are reported to BQL and wake the queue disc with a single event
+    m_dequeuedBytes += item->GetSize();
+    if (m_dequeuedEvent.IsRunning())
+    {
+        return;
+    }
+
+    m_dequeuedEvent = Simulator::ScheduleNow([=]() {
         // Inform BQL
-        NotifyTransmittedBytes(item->GetSize());
+        uint32_t bytes = m_dequeuedBytes;
+        m_dequeuedBytes = 0;
+        NotifyTransmittedBytes(bytes);
 
         // After dequeuing a packet, if there is room for another packet we
         // call Wake () that ensures that the queue is not stopped and restarts
@@ -61,6 +61,13 @@ QueueItem::GetUint8Value(QueueItem::Uint8Values field, uint8_t& value) const
     return false;
 }
 
+bool
+QueueItem::SetUint8Value(QueueItem::Uint8Values field, uint8_t value)
+{
+    NS_LOG_FUNCTION(this);
+    return false;
+}
+
 void
 QueueItem::Print(std::ostream& os) const
 {
@@ -78,7 +85,8 @@ QueueDiscItem::QueueDiscItem(Ptr<Packet> p, const Address& addr, uint16_t protoc
     : QueueItem(p),
       m_address(addr),
       m_protocol(protocol),
-      m_txq(0)
+      m_txq(0),
+      m_classKeySet(false)
 {
     NS_LOG_FUNCTION(this << p << addr << protocol);
 }
@@ -146,4 +154,11 @@ QueueDiscItem::Hash(uint32_t perturbation) const
     return 0;
 }
 
+void
+QueueDiscItem::ComputeClassKey(ClassKey& key) const
+{
+    NS_LOG_FUNCTION(this);
+    key.flowHash = Hash(0);
+}
+
 } // namespace ns3
@@ -92,6 +92,15 @@ class QueueItem : public SimpleRefCount<QueueItem>
      */
     virtual bool GetUint8Value(Uint8Values field, uint8_t& value) const;
 
+    /**
+     * \brief Rewrite the value of a given field of the packet, if present
+     * \param field the field whose value has to be rewritten
+     * \param value the new value
+     *
+     * \return true if the requested field is present in the packet, false otherwise.
+     */
+    virtual bool SetUint8Value(Uint8Values field, uint8_t value);
+
     /**
      * \brief Print the item contents.
      * \param os output stream in which the data should be printed.
@@ -132,6 +141,19 @@ std::ostream& operator<<(std::ostream& os, const QueueItem& item);
 class QueueDiscItem : public QueueItem
 {
   public:
+    /**
+     * \brief The fields of the packet header used to classify the packet
+     */
+    struct ClassKey
+    {
+        bool ip;            //!< whether the fields were read from an IP header
+        uint8_t dscp;       //!< the DSCP
+        uint8_t l4Protocol; //!< the L4 protocol number
+        uint16_t srcPort;   //!< the L4 source port (0 if not TCP or UDP)
+        uint16_t dstPort;   //!< the L4 destination port (0 if not TCP or UDP)
+        uint32_t flowHash;  //!< the hash of the 5-tuple, with no perturbation
+    };
+
     /**
      * \brief Create a queue disc item.
      * \param p the packet included in the created item.
@@ -217,13 +239,61 @@ class QueueDiscItem : public QueueItem
      */
     virtual uint32_t Hash(uint32_t perturbation = 0) const;
 
+    /**
+     * \brief Get the fields of the packet header used to classify the packet
+     *
+     * The fields are computed the first time this method is called and cached
+     * in the item, so that every queue disc of a hierarchy classifies the
+     * packet without casting the item or copying its header.
+     *
+     * \return the classification fields of the packet
+     */
+    const ClassKey& GetClassKey() const;
+
+  protected:
+    /**
+     * \brief Compute the fields of the packet header used to classify the packet
+     *
+     * This method only sets the flow hash, as returned by Hash. Subclasses
+     * should read the fields of their protocol header.
+     *
+     * \param key the classification fields to set
+     */
+    virtual void ComputeClassKey(ClassKey& key) const;
+
+    /**
+     * \brief Update the cached DSCP, if the classification fields have been computed
+     * \param dscp the new DSCP
+     */
+    void UpdateClassKeyDscp(uint8_t dscp);
+
   private:
-    Address m_address;   //!< MAC destination address
-    uint16_t m_protocol; //!< L3 Protocol number
-    uint8_t m_txq;       //!< Transmission queue index
-    Time m_tstamp;       //!< timestamp when the packet was enqueued
+    Address m_address;           //!< MAC destination address
+    uint16_t m_protocol;         //!< L3 Protocol number
+    uint8_t m_txq;               //!< Transmission queue index
+    mutable bool m_classKeySet;  //!< whether the classification fields have been computed
+    mutable ClassKey m_classKey; //!< cached classification fields
+    Time m_tstamp;               //!< timestamp when the packet was enqueued
 };
 
+inline const QueueDiscItem::ClassKey&
+QueueDiscItem::GetClassKey() const
+{
+    if (!m_classKeySet)
+    {
+        m_classKey = ClassKey{false, 0, 0, 0, 0, 0};
+        ComputeClassKey(m_classKey);
+        m_classKeySet = true;
+    }
+    return m_classKey;
+}
+
+inline void
+QueueDiscItem::UpdateClassKeyDscp(uint8_t dscp)
+{
+    m_classKey.dscp = dscp;
+}
+
 } // namespace ns3
 
 #endif /* QUEUE_ITEM_H */
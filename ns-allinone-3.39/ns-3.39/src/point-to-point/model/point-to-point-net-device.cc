@@ -24,6 +24,7 @@
 #include "ns3/llc-snap-header.h"
 #include "ns3/log.h"
 #include "ns3/mac48-address.h"
+#include "ns3/net-device-queue-interface.h"
 #include "ns3/pointer.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
@@ -81,6 +82,18 @@ PointToPointNetDevice::GetTypeId()
                           PointerValue(),
                           MakePointerAccessor(&PointToPointNetDevice::m_queue),
                           MakePointerChecker<Queue<Packet>>())
+            .AddAttribute("TxBatchBytes",
+                          "The maximum number of bytes sent back to back with a single "
+                          "transmission complete event (0 to send packets one at a time). "
+                          "The packets of a batch leave the device queue when the batch "
+                          "starts, hence the queue disc can refill the device queue before "
+                          "they are on the wire, but their bytes stay charged to the byte "
+                          "queue limits until the batch ends. Packets are sent one at a "
+                          "time while the Sniffer, PromiscSniffer, PhyTxBegin or PhyTxEnd "
+                          "traces are connected, so that they fire at the right times.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&PointToPointNetDevice::m_txBatchBytes),
+                          MakeUintegerChecker<uint32_t>())
 
             //
             // Trace sources at the "top" of the net device, where packets transition
@@ -178,7 +191,10 @@ PointToPointNetDevice::PointToPointNetDevice()
     : m_txMachineState(READY),
       m_channel(nullptr),
       m_linkUp(false),
-      m_currentPkt(nullptr)
+      m_currentPkt(nullptr),
+      m_txBatchBytes(0),
+      m_txBatchPackets(0),
+      m_txBatchChargedBytes(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -255,14 +271,60 @@ PointToPointNetDevice::TransmitStart(Ptr<Packet> p)
     Time txTime = m_bps.CalculateBytesTxTime(p->GetSize());
     Time txCompleteTime = txTime + m_tInterframeGap;
 
-    NS_LOG_LOGIC("Schedule TransmitCompleteEvent in " << txCompleteTime.As(Time::S));
-    Simulator::Schedule(txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+    // the per-packet traces of a batch would fire at its start and its end,
+    // not when each packet starts and ends, so do not batch while traced
+    bool traced = !m_snifferTrace.IsEmpty() || !m_promiscSnifferTrace.IsEmpty() ||
+                  !m_phyTxBeginTrace.IsEmpty() || !m_phyTxEndTrace.IsEmpty();
+    if (m_txBatchBytes == 0 || traced)
+    {
+        NS_LOG_LOGIC("Schedule TransmitCompleteEvent in " << txCompleteTime.As(Time::S));
+        Simulator::Schedule(txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+
+        bool result = m_channel->TransmitStart(p, this, txTime);
+        if (!result)
+        {
+            m_phyTxDropTrace(p);
+        }
+        return result;
+    }
 
     bool result = m_channel->TransmitStart(p, this, txTime);
     if (!result)
     {
         m_phyTxDropTrace(p);
     }
+
+    // Send the packets waiting in the device queue back to back, up to the byte
+    // budget. Their departure times are known now, hence the channel is given
+    // the time at which each packet ends and a single event ends the batch
+    uint32_t batchBytes = p->GetSize();
+    while (!m_queue->IsEmpty() && batchBytes + m_queue->Peek()->GetSize() <= m_txBatchBytes)
+    {
+        Ptr<Packet> next = m_queue->Dequeue();
+        batchBytes += next->GetSize();
+        txTime = m_bps.CalculateBytesTxTime(next->GetSize());
+        if (!m_channel->TransmitStart(next, this, txCompleteTime + txTime))
+        {
+            m_phyTxDropTrace(next);
+        }
+        txCompleteTime += txTime + m_tInterframeGap;
+        m_txBatchPackets++;
+    }
+
+    // The device queue reported the packets after p as transmitted when they
+    // were dequeued. Charge their bytes to BQL again until the batch ends, so
+    // that BQL still bounds the bytes which are not on the wire yet
+    Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface>();
+    if (m_txBatchPackets > 0 && ndqi)
+    {
+        m_txBatchChargedBytes = batchBytes - p->GetSize();
+        ndqi->GetTxQueue(0)->NotifyQueuedBytes(m_txBatchChargedBytes);
+    }
+
+    NS_LOG_LOGIC("Schedule TransmitCompleteEvent of a batch of " << m_txBatchPackets + 1
+                                                                 << " packets in "
+                                                                 << txCompleteTime.As(Time::S));
+    Simulator::Schedule(txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
     return result;
 }
 
@@ -284,6 +346,13 @@ PointToPointNetDevice::TransmitComplete()
 
     m_phyTxEndTrace(m_currentPkt);
     m_currentPkt = nullptr;
+    m_txBatchPackets = 0;
+    if (m_txBatchChargedBytes > 0)
+    {
+        GetObject<NetDeviceQueueInterface>()->GetTxQueue(0)->NotifyTransmittedBytes(
+            m_txBatchChargedBytes);
+        m_txBatchChargedBytes = 0;
+    }
 
     Ptr<Packet> p = m_queue->Dequeue();
 
@@ -246,6 +246,13 @@ class PointToPointNetDevice : public NetDevice
      * started sending signals.  An event is scheduled for the time at which
      * the bits have been completely transmitted.
      *
+     * If TxBatchBytes is not zero, the packets waiting in the device queue are
+     * sent back to back after p, up to the byte budget, and a single event is
+     * scheduled at the end of the batch. The bytes of the packets after p stay
+     * charged to the byte queue limits of the device queue until the end of
+     * the batch. Packets are not batched while the Sniffer, PromiscSniffer,
+     * PhyTxBegin or PhyTxEnd traces are connected.
+     *
      * \see PointToPointChannel::TransmitStart ()
      * \see TransmitComplete()
      * \param p a reference to the packet to send
@@ -444,6 +451,10 @@ class PointToPointNetDevice : public NetDevice
 
     Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+    uint32_t m_txBatchBytes;        //!< Byte budget of a batch, 0 to send packets one by one
+    uint32_t m_txBatchPackets;      //!< Number of packets of the current batch after m_currentPkt
+    uint32_t m_txBatchChargedBytes; //!< Bytes of the current batch charged again to BQL
+
     /**
      * \brief PPP to Ethernet protocol number mapping
      * \param protocol A PPP protocol number
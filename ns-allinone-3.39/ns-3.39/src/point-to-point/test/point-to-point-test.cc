@@ -21,10 +21,13 @@
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/point-to-point-net-device.h"
+#include "ns3/queue-limits.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
 
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -139,6 +142,201 @@ PointToPointTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \brief Queue limits which only count the bytes charged to them
+ */
+class InFlightQueueLimits : public QueueLimits
+{
+  public:
+    void Reset() override
+    {
+        m_inFlight = 0;
+    }
+
+    void Completed(uint32_t count) override
+    {
+        m_inFlight -= count;
+    }
+
+    int32_t Available() const override
+    {
+        return 1;
+    }
+
+    void Queued(uint32_t count) override
+    {
+        m_inFlight += count;
+    }
+
+    int64_t m_inFlight{0}; //!< bytes queued and not completed yet
+};
+
+/**
+ * \brief Test class for the batched transmission of PointToPoint devices
+ *
+ * It sends a burst of packets with and without TxBatchBytes and checks that
+ * the packets arrive at the same times, with fewer events when batched, that
+ * the packets of a batch stay charged to the byte queue limits until the
+ * batch ends, and that packets are not batched while the PhyTxBegin trace is
+ * connected.
+ */
+class PointToPointBatchTest : public TestCase
+{
+  public:
+    /**
+     * \brief Create the test
+     */
+    PointToPointBatchTest();
+
+    /**
+     * \brief Run the test
+     */
+    void DoRun() override;
+
+  private:
+    std::vector<Time> m_rxTimes;       //!< reception time of each packet
+    std::vector<Time> m_txTimes;       //!< transmission start time of each packet
+    int64_t m_inFlight;                //!< bytes charged to BQL while the second packet is sent
+    Ptr<InFlightQueueLimits> m_limits; //!< the queue limits of the sending device
+    /**
+     * \brief Send a burst of packets and record their reception times
+     *
+     * \param batchBytes The TxBatchBytes of the sending device.
+     * \param traced Whether to record the transmission start times.
+     * \return The number of events executed.
+     */
+    uint64_t RunBurst(uint32_t batchBytes, bool traced = false);
+    /**
+     * \brief Callback function which records the transmission start time
+     *
+     * \param pkt The packet.
+     */
+    void TxPacket(Ptr<const Packet> pkt);
+    /**
+     * \brief Callback function which records the reception time
+     *
+     * \param dev The receiving device.
+     * \param pkt The received packet.
+     * \param mode The protocol mode used.
+     * \param sender The sender address.
+     *
+     * \return A boolean indicating packet handled properly.
+     */
+    bool RxPacket(Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address& sender);
+};
+
+PointToPointBatchTest::PointToPointBatchTest()
+    : TestCase("PointToPoint batched transmission")
+{
+}
+
+bool
+PointToPointBatchTest::RxPacket(Ptr<NetDevice> dev,
+                                Ptr<const Packet> pkt,
+                                uint16_t mode,
+                                const Address& sender)
+{
+    m_rxTimes.push_back(Simulator::Now());
+    return true;
+}
+
+void
+PointToPointBatchTest::TxPacket(Ptr<const Packet> pkt)
+{
+    m_txTimes.push_back(Simulator::Now());
+}
+
+uint64_t
+PointToPointBatchTest::RunBurst(uint32_t batchBytes, bool traced)
+{
+    Ptr<Node> a = CreateObject<Node>();
+    Ptr<Node> b = CreateObject<Node>();
+    Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice>();
+    Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice>();
+    Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel>();
+
+    devA->SetAttribute("DataRate", DataRateValue(DataRate("8Mbps")));
+    devA->SetAttribute("TxBatchBytes", UintegerValue(batchBytes));
+    devA->Attach(channel);
+    devA->SetAddress(Mac48Address::Allocate());
+    Ptr<Queue<Packet>> queueA = CreateObject<DropTailQueue<Packet>>();
+    devA->SetQueue(queueA);
+    devB->Attach(channel);
+    devB->SetAddress(Mac48Address::Allocate());
+    devB->SetQueue(CreateObject<DropTailQueue<Packet>>());
+
+    a->AddDevice(devA);
+    b->AddDevice(devB);
+
+    // BQL, as configured by the PointToPointHelper and the TrafficControlHelper
+    Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface>();
+    devA->AggregateObject(ndqi);
+    ndqi->GetTxQueue(0)->ConnectQueueTraces(queueA);
+    m_limits = CreateObject<InFlightQueueLimits>();
+    ndqi->GetTxQueue(0)->SetQueueLimits(m_limits);
+
+    devB->SetReceiveCallback(MakeCallback(&PointToPointBatchTest::RxPacket, this));
+    if (traced)
+    {
+        devA->TraceConnectWithoutContext("PhyTxBegin",
+                                         MakeCallback(&PointToPointBatchTest::TxPacket, this));
+    }
+
+    m_rxTimes.clear();
+    m_txTimes.clear();
+    Simulator::Schedule(Seconds(1.0), [devA]() {
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            devA->Send(Create<Packet>(998), devA->GetBroadcast(), 0x800);
+        }
+    });
+
+    // the second packet is sent from 1 ms to 2 ms after the burst
+    Simulator::Schedule(Seconds(1.0015), [this]() { m_inFlight = m_limits->m_inFlight; });
+
+    Simulator::Run();
+    uint64_t events = Simulator::GetEventCount();
+    NS_TEST_EXPECT_MSG_EQ(m_limits->m_inFlight, 0, "All the bytes should be completed");
+    Simulator::Destroy();
+    return events;
+}
+
+void
+PointToPointBatchTest::DoRun()
+{
+    uint64_t events = RunBurst(0);
+    std::vector<Time> expected = m_rxTimes;
+    int64_t expectedInFlight = m_inFlight;
+    NS_TEST_ASSERT_MSG_EQ(expected.size(), 10, "All packets should be received");
+    NS_TEST_EXPECT_MSG_EQ(expectedInFlight,
+                          8000,
+                          "The packets left in the device queue should be charged");
+
+    // batches of three packets of 1000 bytes, after the first packet
+    uint64_t batchEvents = RunBurst(3000);
+    NS_TEST_ASSERT_MSG_EQ(m_rxTimes.size(), 10, "All packets should be received");
+    for (uint32_t i = 0; i < expected.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_rxTimes[i], expected[i], "Packet " << i << " arrives at a different time");
+    }
+    // the device queue also reports the packets of a batch to BQL at once
+    NS_TEST_EXPECT_MSG_EQ(events - batchEvents,
+                          12,
+                          "Two events per batch instead of two per packet");
+    NS_TEST_EXPECT_MSG_EQ(m_inFlight, expectedInFlight, "The batched packets should stay charged");
+
+    // while traced, each packet starts at its own time
+    RunBurst(0, true);
+    std::vector<Time> expectedTx = m_txTimes;
+    NS_TEST_ASSERT_MSG_EQ(expectedTx.size(), 10, "All packets should be traced");
+    RunBurst(3000, true);
+    NS_TEST_ASSERT_MSG_EQ(m_txTimes.size(), 10, "All packets should be traced");
+    for (uint32_t i = 0; i < expectedTx.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_txTimes[i], expectedTx[i], "Packet " << i << " starts at a different time");
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -155,6 +353,7 @@ PointToPointTestSuite::PointToPointTestSuite()
     : TestSuite("devices-point-to-point", UNIT)
 {
     AddTestCase(new PointToPointTest, TestCase::QUICK);
+    AddTestCase(new PointToPointBatchTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
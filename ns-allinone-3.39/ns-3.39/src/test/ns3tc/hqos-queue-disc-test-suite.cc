@@ -0,0 +1,282 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/hqos-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/prio-queue-dscp-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param size The size of the packet payload.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue, Ipv4Header::DscpType dscp, uint32_t size)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    Ptr<Packet> p = Create<Packet>(size);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * Dequeue packets from a queue disc and count them per DSCP.
+ * \param queue The queue disc.
+ * \param count The number of packets to dequeue.
+ * \return The number of dequeued packets per DSCP.
+ */
+static std::map<uint8_t, uint32_t>
+CountDequeued(Ptr<QueueDisc> queue, uint32_t count)
+{
+    std::map<uint8_t, uint32_t> counts;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Ptr<QueueDiscItem> item = queue->Dequeue();
+        if (!item)
+        {
+            break;
+        }
+        counts[DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader().GetDscp()]++;
+    }
+    return counts;
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests strict priority and weighted sharing in a two-level tree.
+ */
+class HqosQueueDiscHierarchy : public TestCase
+{
+  public:
+    HqosQueueDiscHierarchy();
+    ~HqosQueueDiscHierarchy() override;
+
+  private:
+    void DoRun() override;
+};
+
+HqosQueueDiscHierarchy::HqosQueueDiscHierarchy()
+    : TestCase("Test strict priority over WDRR and WFQ subtrees")
+{
+}
+
+HqosQueueDiscHierarchy::~HqosQueueDiscHierarchy()
+{
+}
+
+void
+HqosQueueDiscHierarchy::DoRun()
+{
+    Ptr<HqosQueueDisc> queueDisc = CreateObjectWithAttributes<HqosQueueDisc>(
+        "Tree",
+        StringValue("sp(leaf(46) wdrr(1500:leaf(8) 3000:leaf(16)))"));
+    queueDisc->Initialize();
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetNLeaves(), 3, "The tree has three leaves");
+
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 1000);
+    }
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 1000);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 1000);
+
+    std::map<uint8_t, uint32_t> counts = CountDequeued(queueDisc, 2);
+    NS_TEST_EXPECT_MSG_EQ(counts[Ipv4Header::DSCP_EF], 2, "EF must be served first");
+
+    counts = CountDequeued(queueDisc, 24);
+    NS_TEST_EXPECT_MSG_EQ_TOL(counts[Ipv4Header::DSCP_CS2],
+                              16,
+                              1,
+                              "The leaf with twice the quantum should get 2/3 of the link");
+
+    queueDisc = CreateObjectWithAttributes<HqosQueueDisc>(
+        "Tree",
+        StringValue("wfq(3:leaf(8) 1:leaf(*))"));
+    queueDisc->Initialize();
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_AF11, 1000);
+    }
+    counts = CountDequeued(queueDisc, 40);
+    NS_TEST_EXPECT_MSG_EQ_TOL(counts[Ipv4Header::DSCP_CS1],
+                              30,
+                              1,
+                              "The leaf with weight 3 should get 3/4 of the link");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a shaper node holds back its subtree when it runs
+ * out of tokens, while the rest of the tree keeps being served.
+ */
+class HqosQueueDiscShaper : public TestCase
+{
+  public:
+    HqosQueueDiscShaper();
+    ~HqosQueueDiscShaper() override;
+
+  private:
+    void DoRun() override;
+};
+
+HqosQueueDiscShaper::HqosQueueDiscShaper()
+    : TestCase("Test shaper nodes")
+{
+}
+
+HqosQueueDiscShaper::~HqosQueueDiscShaper()
+{
+}
+
+void
+HqosQueueDiscShaper::DoRun()
+{
+    Ptr<HqosQueueDisc> queueDisc = CreateObjectWithAttributes<HqosQueueDisc>(
+        "Tree",
+        StringValue("wdrr(1500:shaper(8Mbps 2000 leaf(8)) 1500:leaf(16))"));
+    queueDisc->Initialize();
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 1000);
+    }
+
+    // the bucket of 2000 bytes lets two packets of 1020 bytes through
+    std::map<uint8_t, uint32_t> counts = CountDequeued(queueDisc, 10);
+    NS_TEST_EXPECT_MSG_EQ(counts[Ipv4Header::DSCP_CS1], 2, "The shaper should stop CS1");
+    NS_TEST_EXPECT_MSG_EQ(counts[Ipv4Header::DSCP_CS2], 5, "CS2 is not shaped");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 3, "Three CS1 packets should be queued");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a shaper node of a HQoS queue disc child of a
+ * PrioQueueDscp queue disc is woken up, through the root queue disc.
+ */
+class HqosQueueDiscShapedChild : public TestCase
+{
+  public:
+    HqosQueueDiscShapedChild();
+    ~HqosQueueDiscShapedChild() override;
+
+  private:
+    void DoRun() override;
+
+    std::vector<Time> m_sent; //!< The times the packets were sent
+};
+
+HqosQueueDiscShapedChild::HqosQueueDiscShapedChild()
+    : TestCase("Test the wake-up of a shaper node of a child queue disc")
+{
+}
+
+HqosQueueDiscShapedChild::~HqosQueueDiscShapedChild()
+{
+}
+
+void
+HqosQueueDiscShapedChild::DoRun()
+{
+    // EF to a Fifo band, the rest to a HQoS band shaping all its traffic
+    Ptr<PrioQueueDscpDisc> root = CreateObject<PrioQueueDscpDisc>();
+    Ptr<QueueDiscClass> fifoClass = CreateObject<QueueDiscClass>();
+    fifoClass->SetQueueDisc(CreateObject<FifoQueueDisc>());
+    root->AddQueueDiscClass(fifoClass);
+    Ptr<HqosQueueDisc> child =
+        CreateObjectWithAttributes<HqosQueueDisc>("Tree",
+                                                  StringValue("shaper(8Mbps 2000 leaf(*))"));
+    Ptr<QueueDiscClass> hqosClass = CreateObject<QueueDiscClass>();
+    hqosClass->SetQueueDisc(child);
+    root->AddQueueDiscClass(hqosClass);
+    root->SetSendCallback([this](Ptr<QueueDiscItem> item) { m_sent.push_back(Simulator::Now()); });
+    root->Initialize();
+
+    // the bucket of 2000 bytes lets two packets of 1020 bytes through, then
+    // lacks 41 bytes, which take 41 us at 8 Mbps
+    Simulator::Schedule(MilliSeconds(1), [root]() {
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            AddPacket(root, Ipv4Header::DSCP_CS1, 1000);
+        }
+        root->Run();
+    });
+    Simulator::Stop(MilliSeconds(3));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 3, "All the packets should be sent");
+    NS_TEST_EXPECT_MSG_EQ(m_sent[1], MilliSeconds(1), "The second packet fits in the bucket");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(m_sent[2],
+                                MicroSeconds(1041),
+                                "The third packet is sent once the shaper can send");
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(m_sent[2],
+                                MicroSeconds(1043),
+                                "The third packet is sent as soon as the shaper can send");
+    NS_TEST_EXPECT_MSG_EQ(root->GetNPackets(), 0, "No packet should be left");
+
+    root->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * HQoS queue disc test suite.
+ */
+class HqosQueueDiscTestSuite : public TestSuite
+{
+  public:
+    HqosQueueDiscTestSuite();
+};
+
+HqosQueueDiscTestSuite::HqosQueueDiscTestSuite()
+    : TestSuite("hqos-queue-disc", UNIT)
+{
+    AddTestCase(new HqosQueueDiscHierarchy, TestCase::QUICK);
+    AddTestCase(new HqosQueueDiscShaper, TestCase::QUICK);
+    AddTestCase(new HqosQueueDiscShapedChild, TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static HqosQueueDiscTestSuite g_hqosQueueDiscTestSuite;
@@ -0,0 +1,255 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/marker-queue-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Create an item carrying a UDP packet.
+ * \param port The destination port.
+ * \return The item.
+ */
+static Ptr<Ipv4QueueDiscItem>
+CreateUdpItem(uint16_t port)
+{
+    Ptr<Packet> p = Create<Packet>(100);
+    UdpHeader udpHdr;
+    udpHdr.SetSourcePort(49153);
+    udpHdr.SetDestinationPort(port);
+    p->AddHeader(udpHdr);
+
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(p->GetSize());
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+
+    Address dest;
+    return Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the marker queue disc assigns the DSCP of the port
+ * range including the destination port, rewriting the header in place.
+ */
+class MarkerQueueDiscPortRanges : public TestCase
+{
+  public:
+    MarkerQueueDiscPortRanges();
+    ~MarkerQueueDiscPortRanges() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Enqueue a UDP packet and dequeue it again.
+     * \param queue The queue disc.
+     * \param port The destination port.
+     * \return The DSCP of the dequeued packet.
+     */
+    uint8_t MarkPacket(Ptr<MarkerQueueDisc> queue, uint16_t port);
+};
+
+MarkerQueueDiscPortRanges::MarkerQueueDiscPortRanges()
+    : TestCase("Test DSCP marking by destination port range")
+{
+}
+
+MarkerQueueDiscPortRanges::~MarkerQueueDiscPortRanges()
+{
+}
+
+uint8_t
+MarkerQueueDiscPortRanges::MarkPacket(Ptr<MarkerQueueDisc> queue, uint16_t port)
+{
+    Ptr<Ipv4QueueDiscItem> item = CreateUdpItem(port);
+    queue->Enqueue(item);
+    Ptr<QueueDiscItem> out = queue->Dequeue();
+    NS_TEST_EXPECT_MSG_EQ(out, item, "The marker should not build a new item");
+    return DynamicCast<Ipv4QueueDiscItem>(out)->GetHeader().GetDscp();
+}
+
+void
+MarkerQueueDiscPortRanges::DoRun()
+{
+    // The 8050 range overlaps the first 70 ports of the 8080 range, where it wins
+    Ptr<MarkerQueueDisc> queueDisc = CreateObjectWithAttributes<MarkerQueueDisc>(
+        "MarkingQueue",
+        StringValue("8080 8 9090 46 10800 16 8050 24"));
+    queueDisc->Initialize();
+
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 8080), 24, "Port 8080 belongs to the 8050 range");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 8149), 24, "Port 8149 was not marked as CS3");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 8150), 8, "Port 8150 was not marked as CS1");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 8179), 8, "Port 8179 was not marked as CS1");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 8180), 32, "Port 8180 is in no range (CS4)");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 9090), 46, "Port 9090 was not marked as EF");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 10899), 16, "Port 10899 was not marked as CS2");
+    NS_TEST_EXPECT_MSG_EQ(MarkPacket(queueDisc, 100), 32, "Port 100 is in no range (CS4)");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that an empty marker queue disc lets packets bypass it,
+ * remarked and accounted for, only when the bypass is enabled.
+ */
+class MarkerQueueDiscBypass : public TestCase
+{
+  public:
+    MarkerQueueDiscBypass();
+    ~MarkerQueueDiscBypass() override;
+
+  private:
+    void DoRun() override;
+};
+
+MarkerQueueDiscBypass::MarkerQueueDiscBypass()
+    : TestCase("Test the bypass of an empty marker queue disc")
+{
+}
+
+MarkerQueueDiscBypass::~MarkerQueueDiscBypass()
+{
+}
+
+void
+MarkerQueueDiscBypass::DoRun()
+{
+    std::vector<Ptr<QueueDiscItem>> sent;
+    Ptr<MarkerQueueDisc> queueDisc = CreateObjectWithAttributes<MarkerQueueDisc>(
+        "MarkingQueue",
+        StringValue("9090 46"));
+    queueDisc->SetSendCallback([&sent](Ptr<QueueDiscItem> item) { sent.push_back(item); });
+    queueDisc->Initialize();
+
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->Bypass(CreateUdpItem(9090)),
+                          false,
+                          "The bypass is disabled by default");
+    queueDisc->SetAttribute("Bypass", BooleanValue(true));
+
+    Ptr<Ipv4QueueDiscItem> item = CreateUdpItem(9090);
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->Bypass(item), true, "An empty queue disc can be bypassed");
+    NS_TEST_ASSERT_MSG_EQ(sent.size(), 1, "The item should have been sent");
+    NS_TEST_EXPECT_MSG_EQ(sent[0], item, "The bypassing item should have been sent");
+    NS_TEST_EXPECT_MSG_EQ(+item->GetHeader().GetDscp(), 46, "The bypassing item is remarked");
+
+    queueDisc->Enqueue(CreateUdpItem(9090));
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->Bypass(CreateUdpItem(9090)),
+                          false,
+                          "A backlogged queue disc cannot be bypassed");
+
+    const QueueDisc::Stats& stats = queueDisc->GetStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalBypassedPackets, 1, "One packet bypassed the queue disc");
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalReceivedPackets, 2, "Bypassed packets are received");
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalEnqueuedPackets, 2, "Bypassed packets are enqueued");
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalDequeuedPackets, 1, "Bypassed packets are dequeued");
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalSentPackets, 1, "Bypassed packets are sent");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 1, "Only the enqueued packet is queued");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the classification key cached in an item follows the
+ * remarking of its DSCP, which leaves the ECN bits untouched.
+ */
+class MarkerQueueDiscClassKey : public TestCase
+{
+  public:
+    MarkerQueueDiscClassKey();
+    ~MarkerQueueDiscClassKey() override;
+
+  private:
+    void DoRun() override;
+};
+
+MarkerQueueDiscClassKey::MarkerQueueDiscClassKey()
+    : TestCase("Test the classification key of a remarked item")
+{
+}
+
+MarkerQueueDiscClassKey::~MarkerQueueDiscClassKey()
+{
+}
+
+void
+MarkerQueueDiscClassKey::DoRun()
+{
+    Ptr<MarkerQueueDisc> queueDisc =
+        CreateObjectWithAttributes<MarkerQueueDisc>("MarkingQueue", StringValue("9090 46"));
+    queueDisc->Initialize();
+
+    Ptr<Ipv4QueueDiscItem> item = CreateUdpItem(9090);
+    item->SetUint8Value(QueueItem::IP_DSFIELD, Ipv4Header::ECN_ECT0);
+
+    // compute the key before the item is remarked
+    const QueueDiscItem::ClassKey& key = item->GetClassKey();
+    NS_TEST_EXPECT_MSG_EQ(key.ip, true, "The key should be read from the IPv4 header");
+    NS_TEST_EXPECT_MSG_EQ(+key.dscp, 0, "The packet was not marked yet");
+    NS_TEST_EXPECT_MSG_EQ(+key.l4Protocol, 17, "The L4 protocol should be UDP");
+    NS_TEST_EXPECT_MSG_EQ(key.srcPort, 49153, "Wrong source port");
+    NS_TEST_EXPECT_MSG_EQ(key.dstPort, 9090, "Wrong destination port");
+    NS_TEST_EXPECT_MSG_EQ(key.flowHash, item->Hash(0), "The key should cache the flow hash");
+
+    queueDisc->Enqueue(item);
+    queueDisc->Dequeue();
+    NS_TEST_EXPECT_MSG_EQ(+item->GetClassKey().dscp, 46, "The key should follow the remarking");
+    NS_TEST_EXPECT_MSG_EQ(item->GetHeader().GetDscp(), 46, "The header was not remarked");
+    NS_TEST_EXPECT_MSG_EQ(item->GetHeader().GetEcn(),
+                          Ipv4Header::ECN_ECT0,
+                          "The remarking should keep the ECN bits");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * Marker queue disc test suite.
+ */
+class MarkerQueueDiscTestSuite : public TestSuite
+{
+  public:
+    MarkerQueueDiscTestSuite();
+};
+
+MarkerQueueDiscTestSuite::MarkerQueueDiscTestSuite()
+    : TestSuite("marker-queue-disc", UNIT)
+{
+    AddTestCase(new MarkerQueueDiscPortRanges, TestCase::QUICK);
+    AddTestCase(new MarkerQueueDiscBypass, TestCase::QUICK);
+    AddTestCase(new MarkerQueueDiscClassKey, TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static MarkerQueueDiscTestSuite g_markerQueueDiscTestSuite;
@@ -0,0 +1,293 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/prio-queue-dscp-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param size The size of the packet payload.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue, Ipv4Header::DscpType dscp, uint32_t size)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    Ptr<Packet> p = Create<Packet>(size);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * Dequeue packets from a queue disc and record their DSCPs.
+ * \param queue The queue disc.
+ * \param count The number of packets to dequeue.
+ * \return The DSCPs of the dequeued packets, in order.
+ */
+static std::vector<uint8_t>
+DequeueDscps(Ptr<QueueDisc> queue, uint32_t count)
+{
+    std::vector<uint8_t> dscps;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Ptr<QueueDiscItem> item = queue->Dequeue();
+        if (!item)
+        {
+            break;
+        }
+        dscps.push_back(DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader().GetDscp());
+    }
+    return dscps;
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests the DSCP to band table and the strict priority order.
+ */
+class PrioQueueDscpDiscBands : public TestCase
+{
+  public:
+    PrioQueueDscpDiscBands();
+    ~PrioQueueDscpDiscBands() override;
+
+  private:
+    void DoRun() override;
+};
+
+PrioQueueDscpDiscBands::PrioQueueDscpDiscBands()
+    : TestCase("Test the DSCP to band mapping and the priority order")
+{
+}
+
+PrioQueueDscpDiscBands::~PrioQueueDscpDiscBands()
+{
+}
+
+void
+PrioQueueDscpDiscBands::DoRun()
+{
+    Ptr<PrioQueueDscpDisc> queueDisc = CreateObjectWithAttributes<PrioQueueDscpDisc>(
+        "MapQueue",
+        StringValue("46 0 34 1 8 3"),
+        "DefaultBand",
+        UintegerValue(2));
+    queueDisc->Initialize();
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetNQueueDiscClasses(), 4, "One class per band");
+    NS_TEST_EXPECT_MSG_EQ(+queueDisc->GetBandForDscp(Ipv4Header::DSCP_AF41),
+                          1,
+                          "AF41 is mapped to band 1");
+    NS_TEST_EXPECT_MSG_EQ(+queueDisc->GetBandForDscp(Ipv4Header::DscpDefault),
+                          2,
+                          "Unlisted DSCPs go to the default band");
+
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 100);
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, 100);
+    AddPacket(queueDisc, Ipv4Header::DSCP_AF41, 100);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 100);
+    AddPacket(queueDisc, Ipv4Header::DSCP_AF41, 100);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(queueDisc->GetQueueDiscClass(i)->GetQueueDisc()->GetNPackets(),
+                              (i == 1 ? 2 : 1),
+                              "Unexpected number of packets in band " << i);
+    }
+
+    std::vector<uint8_t> dscps = DequeueDscps(queueDisc, 10);
+    std::vector<uint8_t> expected{Ipv4Header::DSCP_EF,
+                                  Ipv4Header::DSCP_AF41,
+                                  Ipv4Header::DSCP_AF41,
+                                  Ipv4Header::DscpDefault,
+                                  Ipv4Header::DSCP_CS1};
+    NS_TEST_ASSERT_MSG_EQ(dscps.size(), expected.size(), "All packets should be dequeued");
+    for (uint32_t i = 0; i < dscps.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(+dscps[i], +expected[i], "Wrong order at position " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->Dequeue(), nullptr, "The queue disc should be empty");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a band over its rate cap yields to the lower bands
+ * and is still served when they are empty.
+ */
+class PrioQueueDscpDiscRateCap : public TestCase
+{
+  public:
+    PrioQueueDscpDiscRateCap();
+    ~PrioQueueDscpDiscRateCap() override;
+
+  private:
+    void DoRun() override;
+};
+
+PrioQueueDscpDiscRateCap::PrioQueueDscpDiscRateCap()
+    : TestCase("Test the rate cap starvation guard")
+{
+}
+
+PrioQueueDscpDiscRateCap::~PrioQueueDscpDiscRateCap()
+{
+}
+
+void
+PrioQueueDscpDiscRateCap::DoRun()
+{
+    Ptr<PrioQueueDscpDisc> queueDisc = CreateObjectWithAttributes<PrioQueueDscpDisc>(
+        "RateCap",
+        StringValue("8Mbps"),
+        "RateCapBurst",
+        UintegerValue(2000));
+    queueDisc->Initialize();
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_EF, 1000);
+    }
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+    }
+
+    // the bucket of 2000 bytes lets two packets of 1020 bytes through, then
+    // band 1 takes over until it is empty
+    std::vector<uint8_t> dscps = DequeueDscps(queueDisc, 5);
+    std::vector<uint8_t> expected{Ipv4Header::DSCP_EF,
+                                  Ipv4Header::DSCP_EF,
+                                  Ipv4Header::DSCP_CS1,
+                                  Ipv4Header::DSCP_CS1,
+                                  Ipv4Header::DSCP_CS1};
+    NS_TEST_ASSERT_MSG_EQ(dscps.size(), expected.size(), "Five packets should be dequeued");
+    for (uint32_t i = 0; i < dscps.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(+dscps[i], +expected[i], "Wrong order at position " << i);
+    }
+
+    // the band is over its cap, but the queue disc is work conserving
+    dscps = DequeueDscps(queueDisc, 5);
+    NS_TEST_EXPECT_MSG_EQ(dscps.size(), 3, "The capped band should be served when alone");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests the per class sojourn time histograms of the statistics.
+ */
+class PrioQueueDscpDiscSojourn : public TestCase
+{
+  public:
+    PrioQueueDscpDiscSojourn();
+    ~PrioQueueDscpDiscSojourn() override;
+
+  private:
+    void DoRun() override;
+};
+
+PrioQueueDscpDiscSojourn::PrioQueueDscpDiscSojourn()
+    : TestCase("Test the per class sojourn time histograms")
+{
+}
+
+PrioQueueDscpDiscSojourn::~PrioQueueDscpDiscSojourn()
+{
+}
+
+void
+PrioQueueDscpDiscSojourn::DoRun()
+{
+    Ptr<PrioQueueDscpDisc> queueDisc = CreateObject<PrioQueueDscpDisc>();
+    queueDisc->Initialize();
+
+    // EF waits 1 ms, then the 100 CS1 packets wait 2 ms to 2.099 ms
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 100);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 100);
+    }
+    Simulator::Schedule(MilliSeconds(1), [queueDisc]() { queueDisc->Dequeue(); });
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        Simulator::Schedule(MilliSeconds(2) + MicroSeconds(i),
+                            [queueDisc]() { queueDisc->Dequeue(); });
+    }
+    Simulator::Run();
+
+    const auto& sojourn = queueDisc->GetStats().classSojourn;
+    NS_TEST_ASSERT_MSG_EQ(sojourn.size(), 2, "Both classes should have a histogram");
+    NS_TEST_EXPECT_MSG_EQ(sojourn[0].GetCount(), 1, "One EF packet was dequeued");
+    NS_TEST_EXPECT_MSG_EQ(sojourn[0].GetMax(), MilliSeconds(1), "The maximum is exact");
+    NS_TEST_EXPECT_MSG_EQ(sojourn[1].GetCount(), 100, "100 CS1 packets were dequeued");
+    NS_TEST_EXPECT_MSG_EQ(sojourn[1].GetMax(), MicroSeconds(2099), "The maximum is exact");
+    // the 99th value is 2.098 ms, the bucket bounds are within 1%
+    NS_TEST_EXPECT_MSG_EQ_TOL(sojourn[1].GetPercentile(99).GetMicroSeconds(),
+                              2098,
+                              21,
+                              "Unexpected 99th percentile");
+    NS_TEST_EXPECT_MSG_EQ_TOL(sojourn[1].GetMean().GetNanoSeconds(),
+                              2049500,
+                              1,
+                              "The mean is exact");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * PrioQueueDscp queue disc test suite.
+ */
+class PrioQueueDscpDiscTestSuite : public TestSuite
+{
+  public:
+    PrioQueueDscpDiscTestSuite();
+};
+
+PrioQueueDscpDiscTestSuite::PrioQueueDscpDiscTestSuite()
+    : TestSuite("prio-queue-dscp-disc", UNIT)
+{
+    AddTestCase(new PrioQueueDscpDiscBands, TestCase::QUICK);
+    AddTestCase(new PrioQueueDscpDiscRateCap, TestCase::QUICK);
+    AddTestCase(new PrioQueueDscpDiscSojourn, TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static PrioQueueDscpDiscTestSuite g_prioQueueDscpDiscTestSuite;
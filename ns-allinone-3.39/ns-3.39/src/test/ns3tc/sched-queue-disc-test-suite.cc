@@ -0,0 +1,258 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/sched-queue-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/uinteger.h"
+
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a UDP packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param port The source port of the packet, identifying its flow.
+ * \param size The size of the packet, including the IP and UDP headers.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue, Ipv4Header::DscpType dscp, uint16_t port, uint32_t size = 1000)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size - 20);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    UdpHeader udp;
+    udp.SetSourcePort(port);
+    udp.SetDestinationPort(9);
+    Ptr<Packet> p = Create<Packet>(size - 28);
+    p->AddHeader(udp);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * Dequeue a packet from a queue disc.
+ * \param queue The queue disc.
+ * \param [out] port The source port of the packet.
+ * \return The packet, or nullptr if the queue disc is empty.
+ */
+static Ptr<Ipv4QueueDiscItem>
+DequeuePort(Ptr<QueueDisc> queue, uint16_t& port)
+{
+    Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem>(queue->Dequeue());
+    port = 0;
+    if (item)
+    {
+        UdpHeader udp;
+        item->GetPacket()->PeekHeader(udp);
+        port = udp.GetSourcePort();
+    }
+    return item;
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests the strict priority among the classes and the round robin
+ * among the flows of a class.
+ */
+class SchedQueueDiscFlows : public TestCase
+{
+  public:
+    SchedQueueDiscFlows();
+    ~SchedQueueDiscFlows() override;
+
+  private:
+    void DoRun() override;
+};
+
+SchedQueueDiscFlows::SchedQueueDiscFlows()
+    : TestCase("Test the priority among classes and the fairness among flows")
+{
+}
+
+SchedQueueDiscFlows::~SchedQueueDiscFlows()
+{
+}
+
+void
+SchedQueueDiscFlows::DoRun()
+{
+    Ptr<SchedQueueDisc> queueDisc =
+        CreateObjectWithAttributes<SchedQueueDisc>("DscpRanges",
+                                                   StringValue("46 46 0"),
+                                                   "Quantum",
+                                                   UintegerValue(1000));
+    queueDisc->Initialize();
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetClassForDscp(Ipv4Header::DSCP_EF), 0, "EF is class 0");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetClassForDscp(Ipv4Header::DSCP_AF41),
+                          1,
+                          "Unlisted DSCPs go to the default class");
+
+    // a backlogged flow followed by two flows of the same class
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DscpDefault, 1000);
+    }
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DscpDefault, 2000);
+        AddPacket(queueDisc, Ipv4Header::DscpDefault, 3000);
+    }
+
+    uint16_t port;
+    std::vector<uint16_t> expected{1000, 2000, 3000, 1000, 2000, 3000};
+    for (uint32_t i = 0; i < expected.size(); i++)
+    {
+        DequeuePort(queueDisc, port);
+        NS_TEST_EXPECT_MSG_EQ(port, expected[i], "Wrong flow at position " << i);
+    }
+
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 4000);
+    DequeuePort(queueDisc, port);
+    NS_TEST_EXPECT_MSG_EQ(port, 4000, "Class 0 is served first");
+
+    expected = {1000, 2000, 3000, 1000, 1000, 1000};
+    for (uint32_t i = 0; i < expected.size(); i++)
+    {
+        DequeuePort(queueDisc, port);
+        NS_TEST_EXPECT_MSG_EQ(port, expected[i], "Wrong flow at position " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->Dequeue(), nullptr, "The queue disc should be empty");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 0, "The queue disc should be empty");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the flows sharing a set of flow queues keep their
+ * packets in order, and that an overload drops from the fattest flow.
+ */
+class SchedQueueDiscSetAssociative : public TestCase
+{
+  public:
+    SchedQueueDiscSetAssociative();
+    ~SchedQueueDiscSetAssociative() override;
+
+  private:
+    void DoRun() override;
+};
+
+SchedQueueDiscSetAssociative::SchedQueueDiscSetAssociative()
+    : TestCase("Test the set associative flow queues and the overload drops")
+{
+}
+
+SchedQueueDiscSetAssociative::~SchedQueueDiscSetAssociative()
+{
+}
+
+void
+SchedQueueDiscSetAssociative::DoRun()
+{
+    // a single set of 4 queues for 6 flows
+    Ptr<SchedQueueDisc> queueDisc = CreateObjectWithAttributes<SchedQueueDisc>("Flows",
+                                                                               UintegerValue(4),
+                                                                               "SetWays",
+                                                                               UintegerValue(4));
+    queueDisc->Initialize();
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        for (uint16_t flow = 0; flow < 6; flow++)
+        {
+            AddPacket(queueDisc, Ipv4Header::DscpDefault, 5000 + flow);
+        }
+    }
+
+    std::map<uint16_t, uint64_t> lastUid;
+    uint16_t port;
+    Ptr<Ipv4QueueDiscItem> item;
+    uint32_t count = 0;
+    while ((item = DequeuePort(queueDisc, port)))
+    {
+        // uids grow with the creation of the packets, store them plus one
+        uint64_t uid = item->GetPacket()->GetUid() + 1;
+        NS_TEST_EXPECT_MSG_GT(uid, lastUid[port], "Packets of flow " << port << " reordered");
+        lastUid[port] = uid;
+        count++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(count, 30, "All the packets should be dequeued");
+    queueDisc->Dispose();
+
+    // a fat flow and a thin one, in distinct flow queues
+    queueDisc = CreateObjectWithAttributes<SchedQueueDisc>("MaxSize", StringValue("40p"));
+    queueDisc->Initialize();
+    for (uint32_t i = 0; i < 38; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DscpDefault, 6000);
+    }
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, 7000);
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, 7000);
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetStats().GetNDroppedPackets(SchedQueueDisc::OVERLIMIT_DROP),
+                          0,
+                          "The queue disc is not overloaded yet");
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, 7000);
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetStats().GetNDroppedPackets(SchedQueueDisc::OVERLIMIT_DROP),
+                          19,
+                          "Half the backlog of the fat flow should be dropped");
+
+    uint32_t thin = 0;
+    while ((item = DequeuePort(queueDisc, port)))
+    {
+        thin += (port == 7000);
+    }
+    NS_TEST_EXPECT_MSG_EQ(thin, 3, "The thin flow should lose no packet");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * Sched queue disc test suite.
+ */
+class SchedQueueDiscTestSuite : public TestSuite
+{
+  public:
+    SchedQueueDiscTestSuite();
+};
+
+SchedQueueDiscTestSuite::SchedQueueDiscTestSuite()
+    : TestSuite("sched-queue-disc", UNIT)
+{
+    AddTestCase(new SchedQueueDiscFlows, TestCase::QUICK);
+    AddTestCase(new SchedQueueDiscSetAssociative, TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static SchedQueueDiscTestSuite g_schedQueueDiscTestSuite;
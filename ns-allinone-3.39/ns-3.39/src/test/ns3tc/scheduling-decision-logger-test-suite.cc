@@ -0,0 +1,205 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/scheduling-decision-logger.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/wdrr-queue-disc.h"
+
+#include <fstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param size The size of the packet payload.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue, Ipv4Header::DscpType dscp, uint32_t size)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    Ptr<Packet> p = Create<Packet>(size);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a SchedulingDecisionLogger connected to a Wdrr queue
+ * disc writes one fixed-size record every SamplingInterval decisions, with
+ * the values of the SchedulingDecision trace, including the records still
+ * in the ring buffer when it is disposed.
+ */
+class SchedulingDecisionLoggerSampling : public TestCase
+{
+  public:
+    SchedulingDecisionLoggerSampling();
+    ~SchedulingDecisionLoggerSampling() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Record a scheduling decision.
+     * \param index The index of the selected class.
+     * \param size The size of the dequeued packet.
+     * \param deficit The deficit of the class after the decision.
+     * \param timestamp The time of the decision.
+     */
+    void Decision(uint32_t index, uint32_t size, int32_t deficit, Time timestamp);
+
+    std::vector<SchedulingDecisionLogger::Record> m_decisions; //!< All the decisions
+};
+
+SchedulingDecisionLoggerSampling::SchedulingDecisionLoggerSampling()
+    : TestCase("Test the sampled binary records of the scheduling decisions")
+{
+}
+
+SchedulingDecisionLoggerSampling::~SchedulingDecisionLoggerSampling()
+{
+}
+
+void
+SchedulingDecisionLoggerSampling::Decision(uint32_t index,
+                                           uint32_t size,
+                                           int32_t deficit,
+                                           Time timestamp)
+{
+    m_decisions.push_back({timestamp.GetNanoSeconds(), index, size, deficit, 0});
+}
+
+void
+SchedulingDecisionLoggerSampling::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("sched-decision.bin");
+
+    Ptr<WdrrQueueDisc> queueDisc =
+        CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                  StringValue("1500 3000"),
+                                                  "MapQueue",
+                                                  StringValue("8 0 16 1"));
+    queueDisc->Initialize();
+
+    // halves of two records: most of the records are written by the writer
+    // thread while the simulation runs, the last one when the logger is disposed
+    Ptr<SchedulingDecisionLogger> logger =
+        CreateObjectWithAttributes<SchedulingDecisionLogger>("FileName",
+                                                             StringValue(fileName),
+                                                             "BufferSize",
+                                                             UintegerValue(4),
+                                                             "SamplingInterval",
+                                                             UintegerValue(3));
+    NS_TEST_ASSERT_MSG_EQ(logger->ConnectQueueDisc(queueDisc),
+                          true,
+                          "A Wdrr queue disc has a SchedulingDecision trace");
+    NS_TEST_EXPECT_MSG_EQ(logger->ConnectQueueDisc(CreateObject<FifoQueueDisc>()),
+                          false,
+                          "A Fifo queue disc has no SchedulingDecision trace");
+    queueDisc->TraceConnectWithoutContext(
+        "SchedulingDecision",
+        MakeCallback(&SchedulingDecisionLoggerSampling::Decision, this));
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 500 + i);
+    }
+
+    // one decision per millisecond, so that each has its own timestamp
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        Simulator::Schedule(MilliSeconds(i), [queueDisc]() { queueDisc->Dequeue(); });
+    }
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_decisions.size(), 20, "Every packet should be a decision");
+    logger->Dispose();
+
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    NS_TEST_ASSERT_MSG_EQ(file.is_open(), true, "The logger should have written " << fileName);
+    auto fileSize = static_cast<uint64_t>(file.tellg());
+    NS_TEST_EXPECT_MSG_EQ(sizeof(SchedulingDecisionLogger::Record), 24, "Records are 24 bytes");
+    NS_TEST_EXPECT_MSG_EQ(fileSize % sizeof(SchedulingDecisionLogger::Record),
+                          0,
+                          "The file should hold whole records");
+
+    // decisions 0, 3, ..., 18
+    std::vector<SchedulingDecisionLogger::Record> records(
+        fileSize / sizeof(SchedulingDecisionLogger::Record));
+    NS_TEST_ASSERT_MSG_EQ(records.size(), 7, "One decision every three should be logged");
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(records.data()), fileSize);
+    NS_TEST_ASSERT_MSG_EQ(file.good(), true, "The records should be read back");
+
+    for (uint32_t i = 0; i < records.size(); i++)
+    {
+        const SchedulingDecisionLogger::Record& expected = m_decisions[3 * i];
+        NS_TEST_EXPECT_MSG_EQ(records[i].timestamp,
+                              MilliSeconds(3 * i).GetNanoSeconds(),
+                              "Wrong timestamp of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(records[i].timestamp,
+                              expected.timestamp,
+                              "Wrong timestamp of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(records[i].index, expected.index, "Wrong class of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(records[i].size, expected.size, "Wrong size of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(records[i].deficit,
+                              expected.deficit,
+                              "Wrong deficit of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(records[i].reserved, 0, "Record " << i << " is not padded with 0");
+    }
+    // the first decision serves the CS1 band (1020 bytes) out of its quantum
+    NS_TEST_EXPECT_MSG_EQ(records[0].index, 0, "The first class is served first");
+    NS_TEST_EXPECT_MSG_EQ(records[0].size, 1020, "Wrong size of the first packet");
+    NS_TEST_EXPECT_MSG_EQ(records[0].deficit, 1500 - 1020, "Wrong deficit after the first packet");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * SchedulingDecisionLogger test suite.
+ */
+class SchedulingDecisionLoggerTestSuite : public TestSuite
+{
+  public:
+    SchedulingDecisionLoggerTestSuite();
+};
+
+SchedulingDecisionLoggerTestSuite::SchedulingDecisionLoggerTestSuite()
+    : TestSuite("scheduling-decision-logger", UNIT)
+{
+    AddTestCase(new SchedulingDecisionLoggerSampling, TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static SchedulingDecisionLoggerTestSuite g_schedulingDecisionLoggerTestSuite;
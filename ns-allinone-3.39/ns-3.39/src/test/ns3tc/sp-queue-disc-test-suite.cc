@@ -0,0 +1,277 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/simulator.h"
+#include "ns3/sp-queue-disc.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param ecn The ECN codepoint of the packet.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue,
+          Ipv4Header::DscpType dscp,
+          Ipv4Header::EcnType ecn = Ipv4Header::ECN_NotECT)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(100);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+    hdr.SetEcn(ecn);
+
+    Ptr<Packet> p = Create<Packet>(100);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * Dequeue a packet from a queue disc.
+ * \param queue The queue disc.
+ * \return The IPv4 header of the packet, with the default DSCP and ECT(0) if the
+ *         queue disc is empty.
+ */
+static Ipv4Header
+DequeueHeader(Ptr<QueueDisc> queue)
+{
+    Ptr<QueueDiscItem> item = queue->Dequeue();
+    if (!item)
+    {
+        Ipv4Header hdr;
+        hdr.SetEcn(Ipv4Header::ECN_ECT0);
+        return hdr;
+    }
+    return DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests the DSCP ranges, the strict priority order and the limit.
+ */
+class SpQueueDiscBands : public TestCase
+{
+  public:
+    SpQueueDiscBands();
+    ~SpQueueDiscBands() override;
+
+  private:
+    void DoRun() override;
+};
+
+SpQueueDiscBands::SpQueueDiscBands()
+    : TestCase("Test the DSCP ranges and the priority order")
+{
+}
+
+SpQueueDiscBands::~SpQueueDiscBands()
+{
+}
+
+void
+SpQueueDiscBands::DoRun()
+{
+    Ptr<SpQueueDisc> queueDisc =
+        CreateObjectWithAttributes<SpQueueDisc>("DscpRanges",
+                                                StringValue("46 46 0 40 47 1 8 15 2"),
+                                                "DefaultBand",
+                                                UintegerValue(3),
+                                                "MaxSize",
+                                                StringValue("6p"));
+    queueDisc->Initialize();
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetNQueueDiscClasses(), 4, "One class per band");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetBandForDscp(Ipv4Header::DSCP_EF),
+                          0,
+                          "The earlier range takes precedence");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetBandForDscp(Ipv4Header::DSCP_CS5),
+                          1,
+                          "CS5 is in the second range");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetBandForDscp(Ipv4Header::DSCP_AF13),
+                          2,
+                          "AF13 is in the third range");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetBandForDscp(Ipv4Header::DSCP_AF21),
+                          3,
+                          "DSCPs outside the ranges go to the default band");
+
+    AddPacket(queueDisc, Ipv4Header::DscpDefault);
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS1);
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS5);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF);
+    NS_TEST_EXPECT_MSG_EQ(+DequeueHeader(queueDisc).GetDscp(),
+                          +Ipv4Header::DSCP_EF,
+                          "Band 0 is served first");
+    NS_TEST_EXPECT_MSG_EQ(+DequeueHeader(queueDisc).GetDscp(),
+                          +Ipv4Header::DSCP_CS5,
+                          "Band 1 is served next");
+
+    // refill a band which has just been emptied
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF);
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS1);
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS5);
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS5);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF);
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 6, "The queue disc should be full");
+    NS_TEST_EXPECT_MSG_EQ(
+        queueDisc->GetStats().GetNDroppedPackets(SpQueueDisc::LIMIT_EXCEEDED_DROP),
+        1,
+        "The packet beyond MaxSize should be dropped");
+
+    std::vector<uint8_t> expected{Ipv4Header::DSCP_EF,
+                                  Ipv4Header::DSCP_CS5,
+                                  Ipv4Header::DSCP_CS5,
+                                  Ipv4Header::DSCP_CS1,
+                                  Ipv4Header::DSCP_CS1,
+                                  Ipv4Header::DscpDefault};
+    for (uint32_t i = 0; i < expected.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(+DequeueHeader(queueDisc).GetDscp(),
+                              +expected[i],
+                              "Wrong order at position " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->Dequeue(), nullptr, "The queue disc should be empty");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the packets which stay longer than the CE threshold of
+ * their band are CE marked (only the ECT1 ones with L4S) and never dropped.
+ */
+class SpQueueDiscCeMarking : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param useL4s whether L4S is enabled
+     */
+    SpQueueDiscCeMarking(bool useL4s);
+    ~SpQueueDiscCeMarking() override;
+
+  private:
+    void DoRun() override;
+
+    bool m_useL4s; //!< whether L4S is enabled
+};
+
+SpQueueDiscCeMarking::SpQueueDiscCeMarking(bool useL4s)
+    : TestCase(std::string("Test the sojourn time CE marking") + (useL4s ? " with L4S" : "")),
+      m_useL4s(useL4s)
+{
+}
+
+SpQueueDiscCeMarking::~SpQueueDiscCeMarking()
+{
+}
+
+void
+SpQueueDiscCeMarking::DoRun()
+{
+    Ptr<SpQueueDisc> queueDisc =
+        CreateObjectWithAttributes<SpQueueDisc>("CeThresholds",
+                                                StringValue("0s 1ms"),
+                                                "UseL4s",
+                                                BooleanValue(m_useL4s));
+    queueDisc->Initialize();
+
+    // backlog of both bands, served after 2ms
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, Ipv4Header::ECN_ECT0);
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, Ipv4Header::ECN_ECT0);
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, Ipv4Header::ECN_ECT1);
+    AddPacket(queueDisc, Ipv4Header::DscpDefault, Ipv4Header::ECN_NotECT);
+
+    std::vector<Ipv4Header> late;
+    Simulator::Schedule(MilliSeconds(2), [&]() {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            late.push_back(DequeueHeader(queueDisc));
+        }
+    });
+
+    // a packet served at once
+    Ipv4Header early;
+    Simulator::Schedule(MilliSeconds(3), [&]() {
+        AddPacket(queueDisc, Ipv4Header::DscpDefault, Ipv4Header::ECN_ECT1);
+        early = DequeueHeader(queueDisc);
+    });
+
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(late.size(), 4, "All the packets should be dequeued");
+    NS_TEST_EXPECT_MSG_EQ(late[0].GetEcn(),
+                          Ipv4Header::ECN_ECT0,
+                          "Band 0 has no CE threshold");
+    NS_TEST_EXPECT_MSG_EQ(late[1].GetEcn(),
+                          (m_useL4s ? Ipv4Header::ECN_ECT0 : Ipv4Header::ECN_CE),
+                          "ECT0 packets are only marked without L4S");
+    NS_TEST_EXPECT_MSG_EQ(late[2].GetEcn(),
+                          Ipv4Header::ECN_CE,
+                          "ECT1 packets above the threshold are marked");
+    NS_TEST_EXPECT_MSG_EQ(late[3].GetEcn(),
+                          Ipv4Header::ECN_NotECT,
+                          "Packets which are not ECN-capable are sent unmarked");
+    NS_TEST_EXPECT_MSG_EQ(early.GetEcn(),
+                          Ipv4Header::ECN_ECT1,
+                          "Packets below the threshold are not marked");
+
+    QueueDisc::Stats st = queueDisc->GetStats();
+    NS_TEST_EXPECT_MSG_EQ(st.GetNMarkedPackets(SpQueueDisc::CE_THRESHOLD_EXCEEDED_MARK),
+                          (m_useL4s ? 1 : 2),
+                          "Unexpected number of marked packets");
+    NS_TEST_EXPECT_MSG_EQ(st.nTotalDroppedPackets, 0, "No packet should be dropped");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * Sp queue disc test suite.
+ */
+class SpQueueDiscTestSuite : public TestSuite
+{
+  public:
+    SpQueueDiscTestSuite();
+};
+
+SpQueueDiscTestSuite::SpQueueDiscTestSuite()
+    : TestSuite("sp-queue-disc", UNIT)
+{
+    AddTestCase(new SpQueueDiscBands, TestCase::QUICK);
+    AddTestCase(new SpQueueDiscCeMarking(false), TestCase::QUICK);
+    AddTestCase(new SpQueueDiscCeMarking(true), TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static SpQueueDiscTestSuite g_spQueueDiscTestSuite;
@@ -0,0 +1,277 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/data-rate.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/prio-queue-dscp-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/tas-queue-disc.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param size The size of the packet payload.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue, Ipv4Header::DscpType dscp, uint32_t size)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    Ptr<Packet> p = Create<Packet>(size);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that packets are only sent while the gate of their band
+ * is open.
+ */
+class TasQueueDiscGates : public TestCase
+{
+  public:
+    TasQueueDiscGates();
+    ~TasQueueDiscGates() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Dequeue a packet and check its DSCP.
+     * \param queue The queue disc.
+     * \param dscp The expected DSCP, or -1 if no packet is expected.
+     */
+    void Check(Ptr<TasQueueDisc> queue, int dscp);
+};
+
+TasQueueDiscGates::TasQueueDiscGates()
+    : TestCase("Test the gate control list")
+{
+}
+
+TasQueueDiscGates::~TasQueueDiscGates()
+{
+}
+
+void
+TasQueueDiscGates::Check(Ptr<TasQueueDisc> queue, int dscp)
+{
+    Ptr<QueueDiscItem> item = queue->Dequeue();
+    if (dscp < 0)
+    {
+        NS_TEST_EXPECT_MSG_EQ(item, nullptr, "No packet expected at " << Simulator::Now());
+        return;
+    }
+    NS_TEST_EXPECT_MSG_NE(item, nullptr, "A packet was expected at " << Simulator::Now());
+    if (item)
+    {
+        NS_TEST_EXPECT_MSG_EQ(+DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader().GetDscp(),
+                              dscp,
+                              "Unexpected band at " << Simulator::Now());
+    }
+}
+
+void
+TasQueueDiscGates::DoRun()
+{
+    // band 0 (EF) open during the first 100 us of a 300 us cycle, band 1 then
+    Ptr<TasQueueDisc> queueDisc = CreateObjectWithAttributes<TasQueueDisc>(
+        "GateControlList",
+        StringValue("100us 1 100us 2 100us 2"));
+    queueDisc->Initialize();
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetOpenGates(), 1, "Only band 0 is open at start");
+
+    AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 100);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 100);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 100);
+
+    Simulator::Schedule(MicroSeconds(10), &TasQueueDiscGates::Check, this, queueDisc,
+                        Ipv4Header::DSCP_EF);
+    Simulator::Schedule(MicroSeconds(20), &TasQueueDiscGates::Check, this, queueDisc,
+                        Ipv4Header::DSCP_EF);
+    Simulator::Schedule(MicroSeconds(30), &TasQueueDiscGates::Check, this, queueDisc, -1);
+    Simulator::Schedule(MicroSeconds(120), &AddPacket, queueDisc, Ipv4Header::DSCP_EF, 100);
+    Simulator::Schedule(MicroSeconds(150), &TasQueueDiscGates::Check, this, queueDisc,
+                        Ipv4Header::DSCP_CS1);
+    Simulator::Schedule(MicroSeconds(250), &TasQueueDiscGates::Check, this, queueDisc, -1);
+    Simulator::Schedule(MicroSeconds(310), &TasQueueDiscGates::Check, this, queueDisc,
+                        Ipv4Header::DSCP_EF);
+    Simulator::Stop(MicroSeconds(400));
+    Simulator::Run();
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the guard band holds back a frame that cannot be
+ * sent before its gate closes.
+ */
+class TasQueueDiscGuardBand : public TestCase
+{
+  public:
+    TasQueueDiscGuardBand();
+    ~TasQueueDiscGuardBand() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Dequeue a packet and check whether one was expected.
+     * \param queue The queue disc.
+     * \param expected Whether a packet is expected.
+     */
+    void Check(Ptr<TasQueueDisc> queue, bool expected);
+};
+
+TasQueueDiscGuardBand::TasQueueDiscGuardBand()
+    : TestCase("Test the guard band")
+{
+}
+
+TasQueueDiscGuardBand::~TasQueueDiscGuardBand()
+{
+}
+
+void
+TasQueueDiscGuardBand::Check(Ptr<TasQueueDisc> queue, bool expected)
+{
+    NS_TEST_EXPECT_MSG_EQ((queue->Dequeue() != nullptr),
+                          expected,
+                          "Unexpected guard band decision at " << Simulator::Now());
+}
+
+void
+TasQueueDiscGuardBand::DoRun()
+{
+    // a packet of 1020 bytes takes 81.6 us at 100 Mbps
+    Ptr<TasQueueDisc> queueDisc = CreateObjectWithAttributes<TasQueueDisc>(
+        "GateControlList",
+        StringValue("100us 1 100us 2"),
+        "LinkRate",
+        DataRateValue(DataRate("100Mbps")));
+    queueDisc->Initialize();
+
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 1000);
+    AddPacket(queueDisc, Ipv4Header::DSCP_EF, 1000);
+
+    Simulator::Schedule(MicroSeconds(10), &TasQueueDiscGuardBand::Check, this, queueDisc, true);
+    Simulator::Schedule(MicroSeconds(30), &TasQueueDiscGuardBand::Check, this, queueDisc, false);
+    Simulator::Schedule(MicroSeconds(210), &TasQueueDiscGuardBand::Check, this, queueDisc, true);
+    Simulator::Stop(MicroSeconds(300));
+    Simulator::Run();
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a Tas queue disc added as a class of another queue
+ * disc restarts the transmission of its root queue disc when a gate opens.
+ */
+class TasQueueDiscChild : public TestCase
+{
+  public:
+    TasQueueDiscChild();
+    ~TasQueueDiscChild() override;
+
+  private:
+    void DoRun() override;
+
+    std::vector<Time> m_sent; //!< The times the packets were sent
+};
+
+TasQueueDiscChild::TasQueueDiscChild()
+    : TestCase("Test the gate opening of a child queue disc")
+{
+}
+
+TasQueueDiscChild::~TasQueueDiscChild()
+{
+}
+
+void
+TasQueueDiscChild::DoRun()
+{
+    // EF to a Fifo band, the rest to a Tas band whose band 1 opens at 100 us
+    Ptr<PrioQueueDscpDisc> root = CreateObject<PrioQueueDscpDisc>();
+    Ptr<QueueDiscClass> fifoClass = CreateObject<QueueDiscClass>();
+    fifoClass->SetQueueDisc(CreateObject<FifoQueueDisc>());
+    root->AddQueueDiscClass(fifoClass);
+    Ptr<TasQueueDisc> child =
+        CreateObjectWithAttributes<TasQueueDisc>("GateControlList", StringValue("100us 1 100us 2"));
+    Ptr<QueueDiscClass> tasClass = CreateObject<QueueDiscClass>();
+    tasClass->SetQueueDisc(child);
+    root->AddQueueDiscClass(tasClass);
+    root->SetSendCallback([this](Ptr<QueueDiscItem> item) { m_sent.push_back(Simulator::Now()); });
+    root->Initialize();
+
+    // the packet finds its gate closed, hence nothing runs the root again
+    // until the gate opens
+    Simulator::Schedule(MicroSeconds(10), [root]() {
+        AddPacket(root, Ipv4Header::DSCP_CS1, 100);
+        root->Run();
+    });
+    Simulator::Stop(MicroSeconds(150));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 1, "The packet should be sent");
+    NS_TEST_EXPECT_MSG_EQ(m_sent[0], MicroSeconds(100), "The packet is sent when its gate opens");
+    NS_TEST_EXPECT_MSG_EQ(root->GetNPackets(), 0, "No packet should be left");
+
+    root->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * Tas queue disc test suite.
+ */
+class TasQueueDiscTestSuite : public TestSuite
+{
+  public:
+    TasQueueDiscTestSuite();
+};
+
+TasQueueDiscTestSuite::TasQueueDiscTestSuite()
+    : TestSuite("tas-queue-disc", UNIT)
+{
+    AddTestCase(new TasQueueDiscGates, TestCase::QUICK);
+    AddTestCase(new TasQueueDiscGuardBand, TestCase::QUICK);
+    AddTestCase(new TasQueueDiscChild, TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static TasQueueDiscTestSuite g_tasQueueDiscTestSuite;
@@ -0,0 +1,575 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/pointer.h"
+#include "ns3/prio-queue-dscp-disc.h"
+#include "ns3/quantum-tuner.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/wdrr-queue-disc.h"
+#include "ns3/wrr-queue-disc.h"
+
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Enqueue a packet in a queue disc.
+ * \param queue The queue disc.
+ * \param dscp The DSCP of the packet.
+ * \param size The size of the packet payload.
+ */
+static void
+AddPacket(Ptr<QueueDisc> queue, Ipv4Header::DscpType dscp, uint32_t size)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    Ptr<Packet> p = Create<Packet>(size);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+/**
+ * Dequeue packets from a queue disc and count them per DSCP.
+ * \param queue The queue disc.
+ * \param count The number of packets to dequeue.
+ * \return The number of dequeued packets per DSCP.
+ */
+static std::map<uint8_t, uint32_t>
+CountDequeued(Ptr<QueueDisc> queue, uint32_t count)
+{
+    std::map<uint8_t, uint32_t> counts;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Ptr<QueueDiscItem> item = queue->Dequeue();
+        if (!item)
+        {
+            break;
+        }
+        counts[DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader().GetDscp()]++;
+    }
+    return counts;
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the bands share the link according to their quantum.
+ */
+class WdrrQueueDiscWeightedShare : public TestCase
+{
+  public:
+    WdrrQueueDiscWeightedShare();
+    ~WdrrQueueDiscWeightedShare() override;
+
+  private:
+    void DoRun() override;
+};
+
+WdrrQueueDiscWeightedShare::WdrrQueueDiscWeightedShare()
+    : TestCase("Test weighted share of the bands")
+{
+}
+
+WdrrQueueDiscWeightedShare::~WdrrQueueDiscWeightedShare()
+{
+}
+
+void
+WdrrQueueDiscWeightedShare::DoRun()
+{
+    Ptr<WdrrQueueDisc> queueDisc =
+        CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                  StringValue("1500 3000"),
+                                                  "MapQueue",
+                                                  StringValue("8 0 16 1"));
+    queueDisc->Initialize();
+
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 1000);
+    }
+
+    std::map<uint8_t, uint32_t> counts = CountDequeued(queueDisc, 30);
+    NS_TEST_EXPECT_MSG_EQ_TOL(counts[Ipv4Header::DSCP_CS2],
+                              20,
+                              1,
+                              "The band with twice the quantum should get 2/3 of the link");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that inline classes share the link as child queue discs do
+ * and that a full class drops the arriving packet.
+ */
+class WdrrQueueDiscInlineClasses : public TestCase
+{
+  public:
+    WdrrQueueDiscInlineClasses();
+    ~WdrrQueueDiscInlineClasses() override;
+
+  private:
+    void DoRun() override;
+};
+
+WdrrQueueDiscInlineClasses::WdrrQueueDiscInlineClasses()
+    : TestCase("Test inline class queues")
+{
+}
+
+WdrrQueueDiscInlineClasses::~WdrrQueueDiscInlineClasses()
+{
+}
+
+void
+WdrrQueueDiscInlineClasses::DoRun()
+{
+    Ptr<WdrrQueueDisc> queueDisc =
+        CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                  StringValue("1500 3000"),
+                                                  "MapQueue",
+                                                  StringValue("8 0 16 1"),
+                                                  "ClassMaxSize",
+                                                  StringValue("25p"),
+                                                  "InlineClasses",
+                                                  BooleanValue(true));
+    queueDisc->Initialize();
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNQueueDiscClasses(),
+                          0,
+                          "Inline classes should not create queue disc classes");
+
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 1000);
+    }
+
+    QueueDisc::Stats stats = queueDisc->GetStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.GetNDroppedPackets(WdrrQueueDisc::CLASS_LIMIT_DROP),
+                          10,
+                          "Each class should drop the packets beyond its limit");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 50, "The classes should hold 50 packets");
+
+    std::map<uint8_t, uint32_t> counts = CountDequeued(queueDisc, 30);
+    NS_TEST_EXPECT_MSG_EQ_TOL(counts[Ipv4Header::DSCP_CS2],
+                              20,
+                              1,
+                              "The band with twice the quantum should get 2/3 of the link");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 20, "The classes should hold 20 packets");
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNBytes(),
+                          queueDisc->GetNPackets() * 1020,
+                          "The byte count should follow the packets");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a shaped band is held back when its bucket is empty
+ * and served again once it has been refilled, while the other bands keep
+ * being served.
+ */
+class WdrrQueueDiscShaper : public TestCase
+{
+  public:
+    WdrrQueueDiscShaper();
+    ~WdrrQueueDiscShaper() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Dequeue packets and check the number of packets of the shaped band.
+     * \param queue The queue disc.
+     * \param expected The expected number of packets of the shaped band.
+     */
+    void DequeueAndCheck(Ptr<QueueDisc> queue, uint32_t expected);
+};
+
+WdrrQueueDiscShaper::WdrrQueueDiscShaper()
+    : TestCase("Test two-rate shaping of a band")
+{
+}
+
+WdrrQueueDiscShaper::~WdrrQueueDiscShaper()
+{
+}
+
+void
+WdrrQueueDiscShaper::DequeueAndCheck(Ptr<QueueDisc> queue, uint32_t expected)
+{
+    std::map<uint8_t, uint32_t> counts = CountDequeued(queue, 10);
+    NS_TEST_EXPECT_MSG_EQ(counts[Ipv4Header::DSCP_CS1],
+                          expected,
+                          "Unexpected number of packets of the shaped band at "
+                              << Simulator::Now().As(Time::MS));
+}
+
+void
+WdrrQueueDiscShaper::DoRun()
+{
+    // 8 Mbps refill 1000 bytes per ms; the committed bucket holds one packet
+    // of 1020 bytes, and the peak bucket does not hold back the first one
+    Ptr<WdrrQueueDisc> queueDisc =
+        CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                  StringValue("1500 1500"),
+                                                  "MapQueue",
+                                                  StringValue("8 0 16 1"),
+                                                  "CommittedRate",
+                                                  StringValue("8Mbps"),
+                                                  "CommittedBurst",
+                                                  StringValue("2000"),
+                                                  "PeakRate",
+                                                  StringValue("100Mbps"),
+                                                  "PeakBurst",
+                                                  StringValue("1500"));
+    queueDisc->Initialize();
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 1000);
+    }
+
+    std::map<uint8_t, uint32_t> counts = CountDequeued(queueDisc, 10);
+    NS_TEST_EXPECT_MSG_EQ(counts[Ipv4Header::DSCP_CS1], 1, "The shaper should stop CS1");
+    NS_TEST_EXPECT_MSG_EQ(counts[Ipv4Header::DSCP_CS2], 5, "CS2 is not shaped");
+
+    // the buckets are still short after 0.01 ms, and full again after 2 ms
+    Simulator::Schedule(MicroSeconds(10),
+                        &WdrrQueueDiscShaper::DequeueAndCheck,
+                        this,
+                        queueDisc,
+                        0);
+    Simulator::Schedule(MilliSeconds(2),
+                        &WdrrQueueDiscShaper::DequeueAndCheck,
+                        this,
+                        queueDisc,
+                        1);
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(queueDisc->GetNPackets(), 3, "Three CS1 packets should be queued");
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a shaped band parked by a root queue disc after the
+ * start of the simulation is woken up when it conforms again, not earlier.
+ * A packet of another band, enqueued without running the queue disc, is sent
+ * by the same wake-up, which must not happen before it was enqueued.
+ */
+class WdrrQueueDiscShaperWake : public TestCase
+{
+  public:
+    WdrrQueueDiscShaperWake();
+    ~WdrrQueueDiscShaperWake() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Enqueue two packets of the shaped band, run the queue disc, then enqueue
+     * a packet of the other band.
+     * \param queue The queue disc.
+     */
+    static void EnqueueAndRun(Ptr<QueueDisc> queue);
+
+    std::vector<Time> m_sent; //!< The times the packets were sent
+};
+
+WdrrQueueDiscShaperWake::WdrrQueueDiscShaperWake()
+    : TestCase("Test the wake-up of a band shaped after the start")
+{
+}
+
+WdrrQueueDiscShaperWake::~WdrrQueueDiscShaperWake()
+{
+}
+
+void
+WdrrQueueDiscShaperWake::EnqueueAndRun(Ptr<QueueDisc> queue)
+{
+    AddPacket(queue, Ipv4Header::DSCP_CS1, 1000);
+    AddPacket(queue, Ipv4Header::DSCP_CS1, 972);
+    queue->Run();
+    AddPacket(queue, Ipv4Header::DSCP_CS2, 1000);
+}
+
+void
+WdrrQueueDiscShaperWake::DoRun()
+{
+    // after the first packet (1020 bytes), the committed bucket lacks the 12
+    // bytes the second one (992 bytes) needs, which take 12 us at 8 Mbps
+    Ptr<WdrrQueueDisc> queueDisc =
+        CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                  StringValue("1500 1500"),
+                                                  "MapQueue",
+                                                  StringValue("8 0 16 1"),
+                                                  "CommittedRate",
+                                                  StringValue("8Mbps"),
+                                                  "CommittedBurst",
+                                                  StringValue("2000"));
+    queueDisc->SetSendCallback([this](Ptr<QueueDiscItem> item) {
+        m_sent.push_back(Simulator::Now());
+    });
+    queueDisc->Initialize();
+
+    Simulator::Schedule(MilliSeconds(1), &WdrrQueueDiscShaperWake::EnqueueAndRun, queueDisc);
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 3, "All the packets should be sent");
+    NS_TEST_EXPECT_MSG_EQ(m_sent[0], MilliSeconds(1), "The first packet conforms");
+    for (uint32_t i = 1; i < 3; i++)
+    {
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(m_sent[i],
+                                    MicroSeconds(1012),
+                                    "The packets are sent once the shaped band conforms");
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(m_sent[i],
+                                    MicroSeconds(1014),
+                                    "The packets are sent as soon as the shaped band conforms");
+    }
+
+    queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a shaped band of a Wdrr queue disc child of a
+ * PrioQueueDscp queue disc is woken up, through the root queue disc.
+ */
+class WdrrQueueDiscShapedChild : public TestCase
+{
+  public:
+    WdrrQueueDiscShapedChild();
+    ~WdrrQueueDiscShapedChild() override;
+
+  private:
+    void DoRun() override;
+
+    std::vector<Time> m_sent; //!< The times the packets were sent
+};
+
+WdrrQueueDiscShapedChild::WdrrQueueDiscShapedChild()
+    : TestCase("Test the wake-up of a shaped band of a child queue disc")
+{
+}
+
+WdrrQueueDiscShapedChild::~WdrrQueueDiscShapedChild()
+{
+}
+
+void
+WdrrQueueDiscShapedChild::DoRun()
+{
+    // EF to a Fifo band, the rest to a Wdrr band shaping CS1
+    Ptr<PrioQueueDscpDisc> root = CreateObject<PrioQueueDscpDisc>();
+    Ptr<QueueDiscClass> fifoClass = CreateObject<QueueDiscClass>();
+    fifoClass->SetQueueDisc(CreateObject<FifoQueueDisc>());
+    root->AddQueueDiscClass(fifoClass);
+    Ptr<WdrrQueueDisc> child =
+        CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                  StringValue("1500"),
+                                                  "MapQueue",
+                                                  StringValue("8 0"),
+                                                  "CommittedRate",
+                                                  StringValue("8Mbps"),
+                                                  "CommittedBurst",
+                                                  StringValue("2000"));
+    Ptr<QueueDiscClass> wdrrClass = CreateObject<QueueDiscClass>();
+    wdrrClass->SetQueueDisc(child);
+    root->AddQueueDiscClass(wdrrClass);
+    root->SetSendCallback([this](Ptr<QueueDiscItem> item) { m_sent.push_back(Simulator::Now()); });
+    root->Initialize();
+
+    NS_TEST_EXPECT_MSG_EQ(child->GetRootQueueDisc(),
+                          PeekPointer(root),
+                          "The Prio queue disc is the root of the Wdrr one");
+
+    Simulator::Schedule(MilliSeconds(1), [root]() {
+        AddPacket(root, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(root, Ipv4Header::DSCP_CS1, 972);
+        root->Run();
+    });
+    Simulator::Stop(MilliSeconds(3));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 2, "Both packets should be sent");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(m_sent[1],
+                                MicroSeconds(1012),
+                                "The second packet is sent once it conforms");
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(m_sent[1],
+                                MicroSeconds(1014),
+                                "The second packet is sent as soon as it conforms");
+    NS_TEST_EXPECT_MSG_EQ(root->GetNPackets(), 0, "No packet should be left");
+
+    root->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that a quantum tuner drives two saturated bands to their
+ * target shares of the served bytes and converges.
+ */
+class WdrrQueueDiscQuantumTuner : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * \param wrr Whether to tune a WRR queue disc rather than a WDRR one.
+     */
+    WdrrQueueDiscQuantumTuner(bool wrr);
+    ~WdrrQueueDiscQuantumTuner() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Enqueue a CS1 and a CS2 packet and dequeue a packet, as a saturated link would.
+     */
+    void Tick();
+
+    bool m_wrr;                              //!< Whether the queue disc is WRR.
+    Ptr<QueueDisc> m_queueDisc;              //!< The queue disc.
+    std::map<uint8_t, uint64_t> m_lastBytes; //!< Bytes served per DSCP in the last 50 ms.
+};
+
+WdrrQueueDiscQuantumTuner::WdrrQueueDiscQuantumTuner(bool wrr)
+    : TestCase(wrr ? "Test WRR weight tuning" : "Test WDRR quantum tuning"),
+      m_wrr(wrr)
+{
+}
+
+WdrrQueueDiscQuantumTuner::~WdrrQueueDiscQuantumTuner()
+{
+}
+
+void
+WdrrQueueDiscQuantumTuner::Tick()
+{
+    // CS1 packets are a third of the size of CS2 packets
+    AddPacket(m_queueDisc, Ipv4Header::DSCP_CS1, 480);
+    AddPacket(m_queueDisc, Ipv4Header::DSCP_CS2, 1480);
+    Ptr<QueueDiscItem> item = m_queueDisc->Dequeue();
+    if (item && Simulator::Now() >= MilliSeconds(150))
+    {
+        m_lastBytes[DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader().GetDscp()] +=
+            item->GetSize();
+    }
+    Simulator::Schedule(MicroSeconds(10), &WdrrQueueDiscQuantumTuner::Tick, this);
+}
+
+void
+WdrrQueueDiscQuantumTuner::DoRun()
+{
+    // WDRR serves bytes, so the quanta converge to 750 and 2250. WRR serves
+    // packets, so equal byte shares need three times more CS1 packets: the
+    // weights converge to 15 and 5
+    double cs2Share = m_wrr ? 0.5 : 0.75;
+    Ptr<QuantumTuner> tuner = CreateObjectWithAttributes<QuantumTuner>(
+        "Interval",
+        StringValue("1ms"),
+        "TargetShares",
+        StringValue(m_wrr ? "0.5 0.5" : "0.25 0.75"));
+    if (m_wrr)
+    {
+        m_queueDisc = CreateObjectWithAttributes<WrrQueueDisc>("Quantum",
+                                                               StringValue("10 10"),
+                                                               "MapQueue",
+                                                               StringValue("8 0 16 1"),
+                                                               "ClassMaxSize",
+                                                               StringValue("100p"),
+                                                               "Tuner",
+                                                               PointerValue(tuner));
+    }
+    else
+    {
+        m_queueDisc = CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                                StringValue("1500 1500"),
+                                                                "MapQueue",
+                                                                StringValue("8 0 16 1"),
+                                                                "ClassMaxSize",
+                                                                StringValue("100p"),
+                                                                "Tuner",
+                                                                PointerValue(tuner));
+    }
+    m_queueDisc->Initialize();
+    Simulator::ScheduleNow(&WdrrQueueDiscQuantumTuner::Tick, this);
+    // the tuner runs periodically
+    Simulator::Stop(MilliSeconds(200));
+    Simulator::Run();
+
+    double cs2 = m_lastBytes[Ipv4Header::DSCP_CS2];
+    NS_TEST_EXPECT_MSG_EQ_TOL(cs2 / (cs2 + m_lastBytes[Ipv4Header::DSCP_CS1]),
+                              cs2Share,
+                              0.03,
+                              "The CS2 band should get its target share");
+    NS_TEST_EXPECT_MSG_EQ(tuner->IsConverged(), true, "The quanta should have converged");
+    NS_TEST_EXPECT_MSG_EQ_TOL(double(tuner->GetQuantum(1)) / tuner->GetQuantum(0),
+                              (m_wrr ? 1.0 / 3 : 3.0),
+                              0.1,
+                              "Unexpected ratio of the converged quanta");
+
+    m_queueDisc->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * WDRR queue disc test suite.
+ */
+class WdrrQueueDiscTestSuite : public TestSuite
+{
+  public:
+    WdrrQueueDiscTestSuite();
+};
+
+WdrrQueueDiscTestSuite::WdrrQueueDiscTestSuite()
+    : TestSuite("wdrr-queue-disc", UNIT)
+{
+    AddTestCase(new WdrrQueueDiscWeightedShare, TestCase::QUICK);
+    AddTestCase(new WdrrQueueDiscShaper, TestCase::QUICK);
+    AddTestCase(new WdrrQueueDiscShaperWake, TestCase::QUICK);
+    AddTestCase(new WdrrQueueDiscShapedChild, TestCase::QUICK);
+    AddTestCase(new WdrrQueueDiscInlineClasses, TestCase::QUICK);
+    AddTestCase(new WdrrQueueDiscQuantumTuner(false), TestCase::QUICK);
+    AddTestCase(new WdrrQueueDiscQuantumTuner(true), TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static WdrrQueueDiscTestSuite g_wdrrQueueDiscTestSuite;
@@ -0,0 +1,159 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/wfq-queue-disc.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * This class tests that the virtual clock of the WFQ queue disc shares the
+ * link according to the class weights and always produces the same schedule.
+ */
+class WfqQueueDiscWeightedShare : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param mode the scheduling mode ("WFQ" or "WF2Q+")
+     */
+    WfqQueueDiscWeightedShare(std::string mode);
+    ~WfqQueueDiscWeightedShare() override;
+
+  private:
+    void DoRun() override;
+    /**
+     * Enqueue a packet.
+     * \param queue The queue disc.
+     * \param dscp The DSCP of the packet.
+     * \param size The size of the packet payload.
+     */
+    void AddPacket(Ptr<WfqQueueDisc> queue, Ipv4Header::DscpType dscp, uint32_t size);
+    /**
+     * Fill two classes and record the DSCP of the first dequeued packets.
+     * \param count The number of packets to dequeue.
+     * \return The DSCP of the dequeued packets, in order.
+     */
+    std::vector<uint8_t> RunSchedule(uint32_t count);
+
+    std::string m_mode; //!< the scheduling mode
+};
+
+WfqQueueDiscWeightedShare::WfqQueueDiscWeightedShare(std::string mode)
+    : TestCase("Test weighted share and determinism in " + mode + " mode"),
+      m_mode(mode)
+{
+}
+
+WfqQueueDiscWeightedShare::~WfqQueueDiscWeightedShare()
+{
+}
+
+void
+WfqQueueDiscWeightedShare::AddPacket(Ptr<WfqQueueDisc> queue,
+                                     Ipv4Header::DscpType dscp,
+                                     uint32_t size)
+{
+    Ipv4Header hdr;
+    hdr.SetPayloadSize(size);
+    hdr.SetSource(Ipv4Address("10.10.1.1"));
+    hdr.SetDestination(Ipv4Address("10.10.1.2"));
+    hdr.SetProtocol(17);
+    hdr.SetDscp(dscp);
+
+    Ptr<Packet> p = Create<Packet>(size);
+    Address dest;
+    Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem>(p, dest, 0, hdr);
+    queue->Enqueue(item);
+}
+
+std::vector<uint8_t>
+WfqQueueDiscWeightedShare::RunSchedule(uint32_t count)
+{
+    Ptr<WfqQueueDisc> queueDisc = CreateObjectWithAttributes<WfqQueueDisc>("Quantum",
+                                                                           StringValue("75 25"),
+                                                                           "MapQueue",
+                                                                           StringValue("8 0 16 1"),
+                                                                           "Mode",
+                                                                           StringValue(m_mode));
+    queueDisc->Initialize();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS1, 1000);
+        AddPacket(queueDisc, Ipv4Header::DSCP_CS2, 1000);
+    }
+
+    std::vector<uint8_t> order;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Ptr<QueueDiscItem> item = queueDisc->Dequeue();
+        NS_TEST_EXPECT_MSG_NE(item, nullptr, "A packet should have been dequeued");
+        if (!item)
+        {
+            break;
+        }
+        order.push_back(DynamicCast<Ipv4QueueDiscItem>(item)->GetHeader().GetDscp());
+    }
+    return order;
+}
+
+void
+WfqQueueDiscWeightedShare::DoRun()
+{
+    std::vector<uint8_t> first = RunSchedule(40);
+    uint32_t nHigh = 0;
+    for (auto dscp : first)
+    {
+        nHigh += (dscp == Ipv4Header::DSCP_CS1);
+    }
+    NS_TEST_EXPECT_MSG_EQ_TOL(nHigh, 30, 1, "The class with weight 75 should get 3/4 of the link");
+
+    std::vector<uint8_t> second = RunSchedule(40);
+    NS_TEST_EXPECT_MSG_EQ((first == second), true, "The schedule should be deterministic");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup system-tests-tc
+ *
+ * WFQ queue disc test suite.
+ */
+class WfqQueueDiscTestSuite : public TestSuite
+{
+  public:
+    WfqQueueDiscTestSuite();
+};
+
+WfqQueueDiscTestSuite::WfqQueueDiscTestSuite()
+    : TestSuite("wfq-queue-disc", UNIT)
+{
+    AddTestCase(new WfqQueueDiscWeightedShare("WFQ"), TestCase::QUICK);
+    AddTestCase(new WfqQueueDiscWeightedShare("WF2Q+"), TestCase::QUICK);
+}
+
+/// Do not forget to allocate an instance of this TestSuite.
+static WfqQueueDiscTestSuite g_wfqQueueDiscTestSuite;
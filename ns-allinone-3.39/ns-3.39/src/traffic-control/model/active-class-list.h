@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ACTIVE_CLASS_LIST_H
+#define ACTIVE_CLASS_LIST_H
+
+#include "ns3/assert.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief FIFO list of active class indices for round-robin schedulers
+ *
+ * The list is linked through an array indexed by the class index, which is
+ * allocated once by Reset. Pushing, popping and rotating the head never
+ * allocate memory. A class can be in at most one position of the list, which
+ * the schedulers already guarantee through the status of their flows.
+ */
+class ActiveClassList
+{
+  public:
+    ActiveClassList();
+
+    /**
+     * \brief Empty the list and size it for the given number of classes
+     * \param nClasses the number of classes
+     */
+    void Reset(uint32_t nClasses);
+
+    /**
+     * \brief Check whether the list is empty
+     * \return true if the list is empty
+     */
+    bool IsEmpty() const;
+
+    /**
+     * \brief Get the class at the head of the list, which must not be empty
+     * \return the index of the class at the head of the list
+     */
+    uint32_t Front() const;
+
+    /**
+     * \brief Append a class, which must not be in the list, at the tail
+     * \param index the index of the class
+     */
+    void PushBack(uint32_t index);
+
+    /**
+     * \brief Remove the class at the head of the list, which must not be empty
+     */
+    void PopFront();
+
+    /**
+     * \brief Move the class at the head of the list to the tail
+     */
+    void RotateFront();
+
+  private:
+    /// Marker for the end of the list
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> m_next; //!< the class following each class in the list
+    uint32_t m_head;              //!< the class at the head of the list
+    uint32_t m_tail;              //!< the class at the tail of the list
+};
+
+inline ActiveClassList::ActiveClassList()
+    : m_head(NONE),
+      m_tail(NONE)
+{
+}
+
+inline void
+ActiveClassList::Reset(uint32_t nClasses)
+{
+    m_next.assign(nClasses, NONE);
+    m_head = NONE;
+    m_tail = NONE;
+}
+
+inline bool
+ActiveClassList::IsEmpty() const
+{
+    return m_head == NONE;
+}
+
+inline uint32_t
+ActiveClassList::Front() const
+{
+    NS_ASSERT(!IsEmpty());
+    return m_head;
+}
+
+inline void
+ActiveClassList::PushBack(uint32_t index)
+{
+    NS_ASSERT(index < m_next.size() && m_next[index] == NONE && m_tail != index);
+    if (m_tail == NONE)
+    {
+        m_head = index;
+    }
+    else
+    {
+        m_next[m_tail] = index;
+    }
+    m_tail = index;
+}
+
+inline void
+ActiveClassList::PopFront()
+{
+    NS_ASSERT(!IsEmpty());
+    uint32_t index = m_head;
+    m_head = m_next[index];
+    m_next[index] = NONE;
+    if (m_head == NONE)
+    {
+        m_tail = NONE;
+    }
+}
+
+inline void
+ActiveClassList::RotateFront()
+{
+    NS_ASSERT(!IsEmpty());
+    if (m_head != m_tail)
+    {
+        uint32_t index = m_head;
+        m_head = m_next[index];
+        m_next[index] = NONE;
+        m_next[m_tail] = index;
+        m_tail = index;
+    }
+}
+
+} // namespace ns3
+
+#endif /* ACTIVE_CLASS_LIST_H */
@@ -0,0 +1,78 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "band-attributes.h"
+
+#include "ns3/fatal-error.h"
+
+namespace ns3
+{
+
+ATTRIBUTE_HELPER_CPP(TimeList);
+
+std::ostream&
+operator<<(std::ostream& os, const TimeList& times)
+{
+    for (auto it = times.begin(); it != times.end(); ++it)
+    {
+        os << (it == times.begin() ? "" : " ") << *it;
+    }
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, TimeList& times)
+{
+    Time time;
+    while (!(is.eof()))
+    {
+        if (!(is >> time))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        times.push_back(time);
+    }
+    return is;
+}
+
+ATTRIBUTE_HELPER_CPP(DscpRangeList);
+
+std::ostream&
+operator<<(std::ostream& os, const DscpRangeList& ranges)
+{
+    for (auto it = ranges.begin(); it != ranges.end(); ++it)
+    {
+        os << (it == ranges.begin() ? "" : " ") << it->first << " " << it->last << " "
+           << it->band;
+    }
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, DscpRangeList& ranges)
+{
+    DscpRange range;
+    while (!(is.eof()))
+    {
+        if (!(is >> range.first >> range.last >> range.band))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        ranges.push_back(range);
+    }
+    return is;
+}
+
+} // namespace ns3
@@ -0,0 +1,89 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BAND_ATTRIBUTES_H
+#define BAND_ATTRIBUTES_H
+
+#include "ns3/attribute-helper.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+/// Time (e.g., delay budget or marking threshold) of each band
+typedef std::vector<Time> TimeList;
+
+/**
+ * \brief A range of DSCPs assigned to a band
+ */
+struct DscpRange
+{
+    uint32_t first; //!< the first DSCP of the range
+    uint32_t last;  //!< the last DSCP of the range
+    uint32_t band;  //!< the band of the DSCPs of the range
+};
+
+/// DSCP ranges, the earlier ones taking precedence
+typedef std::vector<DscpRange> DscpRangeList;
+
+/**
+ * Serialize the times to the given ostream
+ *
+ * \param os
+ * \param times
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const TimeList& times);
+
+/**
+ * Serialize from the given istream to these times.
+ *
+ * \param is
+ * \param times
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, TimeList& times);
+
+ATTRIBUTE_HELPER_HEADER(TimeList);
+
+/**
+ * Serialize the DSCP ranges to the given ostream
+ *
+ * \param os
+ * \param ranges
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const DscpRangeList& ranges);
+
+/**
+ * Serialize from the given istream to these DSCP ranges.
+ *
+ * \param is
+ * \param ranges
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, DscpRangeList& ranges);
+
+ATTRIBUTE_HELPER_HEADER(DscpRangeList);
+
+} // namespace ns3
+
+#endif /* BAND_ATTRIBUTES_H */
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "class-backlog-heap.h"
+
+#include "ns3/assert.h"
+
+#include <utility>
+
+namespace ns3
+{
+
+ClassBacklogHeap::ClassBacklogHeap()
+{
+}
+
+void
+ClassBacklogHeap::Reset(uint32_t nClasses)
+{
+    m_heap.resize(nClasses);
+    m_position.resize(nClasses);
+    m_bytes.assign(nClasses, 0);
+    for (uint32_t i = 0; i < nClasses; i++)
+    {
+        // with equal keys, ascending indices already satisfy the heap order
+        m_heap[i] = i;
+        m_position[i] = i;
+    }
+}
+
+void
+ClassBacklogHeap::Update(uint32_t index, uint32_t bytes)
+{
+    NS_ASSERT(index < m_bytes.size());
+
+    uint32_t old = m_bytes[index];
+    m_bytes[index] = bytes;
+    uint32_t pos = m_position[index];
+
+    if (bytes > old)
+    {
+        while (pos > 0 && Fatter(pos, (pos - 1) / 2))
+        {
+            Swap(pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+    }
+    else if (bytes < old)
+    {
+        uint32_t n = m_heap.size();
+        while (true)
+        {
+            uint32_t fattest = pos;
+            uint32_t left = 2 * pos + 1;
+            uint32_t right = left + 1;
+            if (left < n && Fatter(left, fattest))
+            {
+                fattest = left;
+            }
+            if (right < n && Fatter(right, fattest))
+            {
+                fattest = right;
+            }
+            if (fattest == pos)
+            {
+                break;
+            }
+            Swap(pos, fattest);
+            pos = fattest;
+        }
+    }
+}
+
+uint32_t
+ClassBacklogHeap::GetFattest() const
+{
+    NS_ASSERT(!m_heap.empty());
+    return m_heap[0];
+}
+
+uint32_t
+ClassBacklogHeap::GetBacklog(uint32_t index) const
+{
+    NS_ASSERT(index < m_bytes.size());
+    return m_bytes[index];
+}
+
+bool
+ClassBacklogHeap::Fatter(uint32_t a, uint32_t b) const
+{
+    uint32_t ia = m_heap[a];
+    uint32_t ib = m_heap[b];
+    return m_bytes[ia] > m_bytes[ib] || (m_bytes[ia] == m_bytes[ib] && ia < ib);
+}
+
+void
+ClassBacklogHeap::Swap(uint32_t a, uint32_t b)
+{
+    std::swap(m_heap[a], m_heap[b]);
+    m_position[m_heap[a]] = a;
+    m_position[m_heap[b]] = b;
+}
+
+} // namespace ns3
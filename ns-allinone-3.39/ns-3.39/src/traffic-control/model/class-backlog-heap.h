@@ -0,0 +1,88 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CLASS_BACKLOG_HEAP_H
+#define CLASS_BACKLOG_HEAP_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Indexed max-heap of the byte backlog of the classes of a queue disc
+ *
+ * The queue discs report the backlog of a class whenever it changes, which
+ * costs O(log n), so that the fattest class, needed to handle an overload,
+ * is known in O(1) instead of scanning all the classes. Among classes with
+ * the same backlog the one with the lowest index is the fattest.
+ */
+class ClassBacklogHeap
+{
+  public:
+    ClassBacklogHeap();
+
+    /**
+     * \brief Size the heap for the given number of classes, all with no backlog
+     * \param nClasses the number of classes
+     */
+    void Reset(uint32_t nClasses);
+
+    /**
+     * \brief Set the backlog of a class
+     * \param index the index of the class
+     * \param bytes the backlog of the class, in bytes
+     */
+    void Update(uint32_t index, uint32_t bytes);
+
+    /**
+     * \brief Get the class with the largest backlog. The heap must not be empty
+     * \return the index of the class with the largest backlog
+     */
+    uint32_t GetFattest() const;
+
+    /**
+     * \brief Get the backlog of a class
+     * \param index the index of the class
+     * \return the backlog of the class, in bytes
+     */
+    uint32_t GetBacklog(uint32_t index) const;
+
+  private:
+    /**
+     * \brief Check whether the class at a heap position must be above another one
+     * \param a the first heap position
+     * \param b the second heap position
+     * \return true if the class at position a is fatter than the class at position b
+     */
+    bool Fatter(uint32_t a, uint32_t b) const;
+    /**
+     * \brief Swap two heap positions, updating the position of their classes
+     * \param a the first heap position
+     * \param b the second heap position
+     */
+    void Swap(uint32_t a, uint32_t b);
+
+    std::vector<uint32_t> m_heap;     //!< class indices, in heap order
+    std::vector<uint32_t> m_position; //!< heap position of each class
+    std::vector<uint32_t> m_bytes;    //!< backlog of each class
+};
+
+} // namespace ns3
+
+#endif /* CLASS_BACKLOG_HEAP_H */
@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CLASS_ITEM_RING_H
+#define CLASS_ITEM_RING_H
+
+#include "ns3/assert.h"
+#include "ns3/ptr.h"
+#include "ns3/queue-item.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Growable FIFO ring of the items of a class of a queue disc
+ *
+ * A lightweight replacement for a child FifoQueueDisc: the ring only stores
+ * the items and counts their packets and bytes, while drops, marks and
+ * statistics are handled by the queue disc that owns it. The capacity is a
+ * power of two which doubles when the ring is full, hence an empty class
+ * costs no more than a few words and pushing does not allocate once the ring
+ * has grown to the usual backlog of the class.
+ */
+class ClassItemRing
+{
+  public:
+    ClassItemRing();
+
+    /**
+     * \brief Check whether the ring is empty
+     * \return true if the ring holds no item
+     */
+    bool IsEmpty() const;
+
+    /**
+     * \brief Get the number of items in the ring
+     * \return the number of items
+     */
+    uint32_t GetNPackets() const;
+
+    /**
+     * \brief Get the total size of the items in the ring
+     * \return the number of bytes
+     */
+    uint32_t GetNBytes() const;
+
+    /**
+     * \brief Append an item at the tail of the ring
+     * \param item the item
+     */
+    void Push(Ptr<QueueDiscItem> item);
+
+    /**
+     * \brief Remove the item at the head of the ring
+     * \return the item, or null if the ring is empty
+     */
+    Ptr<QueueDiscItem> Pop();
+
+    /**
+     * \brief Get the item at the head of the ring
+     * \return the item, or null if the ring is empty
+     */
+    Ptr<const QueueDiscItem> Peek() const;
+
+    /**
+     * \brief Remove all the items and release the memory of the ring
+     */
+    void Clear();
+
+  private:
+    /// Grow the ring to twice its capacity, keeping the items in order
+    void Grow();
+
+    std::vector<Ptr<QueueDiscItem>> m_items; //!< the slots, a power of two of them
+    uint32_t m_head;                         //!< the slot of the head item
+    uint32_t m_nPackets;                     //!< the number of items
+    uint32_t m_nBytes;                       //!< the total size of the items
+};
+
+inline ClassItemRing::ClassItemRing()
+    : m_head(0),
+      m_nPackets(0),
+      m_nBytes(0)
+{
+}
+
+inline bool
+ClassItemRing::IsEmpty() const
+{
+    return m_nPackets == 0;
+}
+
+inline uint32_t
+ClassItemRing::GetNPackets() const
+{
+    return m_nPackets;
+}
+
+inline uint32_t
+ClassItemRing::GetNBytes() const
+{
+    return m_nBytes;
+}
+
+inline void
+ClassItemRing::Push(Ptr<QueueDiscItem> item)
+{
+    if (m_nPackets == m_items.size())
+    {
+        Grow();
+    }
+    m_nBytes += item->GetSize();
+    m_items[(m_head + m_nPackets++) & (m_items.size() - 1)] = item;
+}
+
+inline Ptr<QueueDiscItem>
+ClassItemRing::Pop()
+{
+    if (m_nPackets == 0)
+    {
+        return nullptr;
+    }
+    Ptr<QueueDiscItem> item = m_items[m_head];
+    m_items[m_head] = nullptr;
+    m_head = (m_head + 1) & (m_items.size() - 1);
+    m_nPackets--;
+    m_nBytes -= item->GetSize();
+    return item;
+}
+
+inline Ptr<const QueueDiscItem>
+ClassItemRing::Peek() const
+{
+    return m_nPackets ? m_items[m_head] : nullptr;
+}
+
+inline void
+ClassItemRing::Clear()
+{
+    std::vector<Ptr<QueueDiscItem>>().swap(m_items);
+    m_head = 0;
+    m_nPackets = 0;
+    m_nBytes = 0;
+}
+
+inline void
+ClassItemRing::Grow()
+{
+    uint32_t capacity = m_items.size();
+    std::vector<Ptr<QueueDiscItem>> items(capacity ? 2 * capacity : 4);
+    for (uint32_t i = 0; i < m_nPackets; i++)
+    {
+        items[i] = m_items[(m_head + i) & (capacity - 1)];
+    }
+    m_items.swap(items);
+    m_head = 0;
+}
+
+} // namespace ns3
+
+#endif /* CLASS_ITEM_RING_H */
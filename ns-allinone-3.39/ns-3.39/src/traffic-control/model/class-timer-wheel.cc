@@ -0,0 +1,246 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "class-timer-wheel.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+ClassTimerWheel::ClassTimerWheel()
+    : m_now(0),
+      m_nScheduled(0),
+      m_expiredTail(NONE)
+{
+    m_occupied.fill(0);
+    m_head.fill(NONE);
+}
+
+void
+ClassTimerWheel::Reset(uint32_t nClasses, uint64_t now)
+{
+    m_now = now;
+    m_nScheduled = 0;
+    m_occupied.fill(0);
+    m_head.fill(NONE);
+    m_expiredTail = NONE;
+    m_next.assign(nClasses, NONE);
+    m_prev.assign(nClasses, NONE);
+    m_location.assign(nClasses, UNSCHEDULED);
+    m_expiry.assign(nClasses, 0);
+}
+
+bool
+ClassTimerWheel::IsEmpty() const
+{
+    return m_nScheduled == 0;
+}
+
+bool
+ClassTimerWheel::IsScheduled(uint32_t index) const
+{
+    NS_ASSERT(index < m_location.size());
+    return m_location[index] != UNSCHEDULED;
+}
+
+void
+ClassTimerWheel::Schedule(uint32_t index, uint64_t expiry)
+{
+    NS_ASSERT(index < m_location.size());
+    NS_ASSERT_MSG(m_location[index] == UNSCHEDULED, "Class " << index << " already scheduled");
+
+    m_expiry[index] = expiry;
+    m_nScheduled++;
+    Insert(index);
+}
+
+void
+ClassTimerWheel::Cancel(uint32_t index)
+{
+    NS_ASSERT(index < m_location.size());
+    if (m_location[index] == UNSCHEDULED)
+    {
+        return;
+    }
+    Unlink(index);
+    m_location[index] = UNSCHEDULED;
+    m_nScheduled--;
+}
+
+void
+ClassTimerWheel::Advance(uint64_t now)
+{
+    for (uint64_t next = GetNextTick(); next <= now; next = GetNextTick())
+    {
+        m_now = next;
+        // The slots starting at this tick are emptied from the top level down;
+        // their classes end up either expired or in a lower level, never in a
+        // slot that starts at this tick
+        for (uint32_t level = LEVELS; level-- > 0;)
+        {
+            uint32_t slot = (m_now >> (level * SLOT_BITS)) & (SLOTS - 1);
+            if (!(m_occupied[level] & (uint64_t(1) << slot)))
+            {
+                continue;
+            }
+            uint32_t pos = level * SLOTS + slot;
+            uint32_t index = m_head[pos];
+            m_head[pos] = NONE;
+            m_occupied[level] &= ~(uint64_t(1) << slot);
+            while (index != NONE)
+            {
+                uint32_t next = m_next[index];
+                Insert(index);
+                index = next;
+            }
+        }
+    }
+    m_now = std::max(m_now, now);
+}
+
+uint32_t
+ClassTimerWheel::PopExpired()
+{
+    uint32_t index = m_head[EXPIRED];
+    if (index != NONE)
+    {
+        Unlink(index);
+        m_location[index] = UNSCHEDULED;
+        m_nScheduled--;
+    }
+    return index;
+}
+
+uint64_t
+ClassTimerWheel::GetNextTick() const
+{
+    uint64_t next = NEVER;
+    for (uint32_t level = 0; level < LEVELS; level++)
+    {
+        next = std::min(next, NextSlotTick(level));
+    }
+    return next;
+}
+
+void
+ClassTimerWheel::Insert(uint32_t index)
+{
+    uint64_t expiry = m_expiry[index];
+    if (expiry <= m_now)
+    {
+        Expire(index);
+        return;
+    }
+
+    // The lowest level where the slot of the expiry is less than a turn away.
+    // Such a slot is never the current one, which would be ambiguous
+    uint32_t level = 0;
+    uint64_t slotTick = expiry;
+    while (level < LEVELS &&
+           (expiry >> (level * SLOT_BITS)) - (m_now >> (level * SLOT_BITS)) >= SLOTS)
+    {
+        level++;
+    }
+    if (level == LEVELS)
+    {
+        // beyond the reach of the wheel: park in the farthest slot of the top
+        // level, the class is filed again when that slot is cascaded
+        level = LEVELS - 1;
+        slotTick = ((m_now >> (level * SLOT_BITS)) + SLOTS - 1) << (level * SLOT_BITS);
+    }
+
+    uint32_t slot = (slotTick >> (level * SLOT_BITS)) & (SLOTS - 1);
+    uint32_t pos = level * SLOTS + slot;
+    m_prev[index] = NONE;
+    m_next[index] = m_head[pos];
+    if (m_head[pos] != NONE)
+    {
+        m_prev[m_head[pos]] = index;
+    }
+    m_head[pos] = index;
+    m_location[index] = pos;
+    m_occupied[level] |= uint64_t(1) << slot;
+}
+
+void
+ClassTimerWheel::Expire(uint32_t index)
+{
+    m_next[index] = NONE;
+    m_prev[index] = m_expiredTail;
+    if (m_expiredTail != NONE)
+    {
+        m_next[m_expiredTail] = index;
+    }
+    else
+    {
+        m_head[EXPIRED] = index;
+    }
+    m_expiredTail = index;
+    m_location[index] = EXPIRED;
+}
+
+void
+ClassTimerWheel::Unlink(uint32_t index)
+{
+    uint32_t pos = m_location[index];
+    uint32_t prev = m_prev[index];
+    uint32_t next = m_next[index];
+
+    if (prev != NONE)
+    {
+        m_next[prev] = next;
+    }
+    else
+    {
+        m_head[pos] = next;
+    }
+
+    if (next != NONE)
+    {
+        m_prev[next] = prev;
+    }
+    else if (pos == EXPIRED)
+    {
+        m_expiredTail = prev;
+    }
+
+    if (pos < EXPIRED && m_head[pos] == NONE)
+    {
+        m_occupied[pos / SLOTS] &= ~(uint64_t(1) << (pos % SLOTS));
+    }
+}
+
+uint64_t
+ClassTimerWheel::NextSlotTick(uint32_t level) const
+{
+    uint64_t occupied = m_occupied[level];
+    if (!occupied)
+    {
+        return NEVER;
+    }
+
+    // rotate the bitmap so that bit d stands for the slot d slots ahead of
+    // the current one; the current slot itself is never occupied
+    uint64_t base = m_now >> (level * SLOT_BITS);
+    uint32_t current = base & (SLOTS - 1);
+    uint64_t ahead = (occupied >> current) | (current ? occupied << (SLOTS - current) : 0);
+    uint32_t distance = __builtin_ctzll(ahead);
+    return (base + distance) << (level * SLOT_BITS);
+}
+
+} // namespace ns3
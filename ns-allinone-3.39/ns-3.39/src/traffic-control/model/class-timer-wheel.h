@@ -0,0 +1,151 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CLASS_TIMER_WHEEL_H
+#define CLASS_TIMER_WHEEL_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Hierarchical timer wheel of the eligibility times of the classes of a queue disc
+ *
+ * Times are integer ticks. The wheel has LEVELS levels of SLOTS slots; a slot
+ * of level L spans SLOTS^L ticks. A class is filed in the lowest level whose
+ * window still holds its expiry, and is moved down (cascaded) when the wheel
+ * reaches the start of its slot, so that every class is touched at most once
+ * per level. A bitmap of the occupied slots of each level gives the next
+ * tick of interest without scanning empty slots, hence a queue disc needs a
+ * single pending event, at GetNextTick, however many classes are waiting.
+ *
+ * Each class can be scheduled at most once. Schedule, Cancel and PopExpired
+ * never allocate memory.
+ */
+class ClassTimerWheel
+{
+  public:
+    /// Marker for no class
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    /// Marker for no tick
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+    ClassTimerWheel();
+
+    /**
+     * \brief Size the wheel for the given number of classes, none scheduled
+     * \param nClasses the number of classes
+     * \param now the current tick
+     */
+    void Reset(uint32_t nClasses, uint64_t now);
+
+    /**
+     * \brief Check whether no class is scheduled or expired
+     * \return true if the wheel is empty
+     */
+    bool IsEmpty() const;
+
+    /**
+     * \brief Check whether a class is scheduled or expired and not popped yet
+     * \param index the index of the class
+     * \return true if the class is in the wheel
+     */
+    bool IsScheduled(uint32_t index) const;
+
+    /**
+     * \brief Schedule a class, which must not be in the wheel
+     * \param index the index of the class
+     * \param expiry the tick at which the class expires; if not in the
+     *        future, the class expires at the next Advance
+     */
+    void Schedule(uint32_t index, uint64_t expiry);
+
+    /**
+     * \brief Remove a class from the wheel, if it is there
+     * \param index the index of the class
+     */
+    void Cancel(uint32_t index);
+
+    /**
+     * \brief Move the wheel forward, collecting the classes that expire
+     * \param now the current tick, which must not be in the past of the wheel
+     */
+    void Advance(uint64_t now);
+
+    /**
+     * \brief Get and remove a class expired by Advance, earliest first
+     * \return the index of the class, or NONE
+     */
+    uint32_t PopExpired();
+
+    /**
+     * \brief Get the first tick at which Advance has work to do. It may be
+     *        earlier than the first expiry, when a class has to be cascaded
+     * \return the tick, or NEVER if no class is scheduled
+     */
+    uint64_t GetNextTick() const;
+
+  private:
+    static constexpr uint32_t SLOT_BITS = 6;              //!< log2 of the number of slots
+    static constexpr uint32_t SLOTS = 1 << SLOT_BITS;     //!< slots per level
+    static constexpr uint32_t LEVELS = 4;                 //!< levels
+    static constexpr uint32_t EXPIRED = LEVELS * SLOTS;   //!< location of expired classes
+    static constexpr uint32_t UNSCHEDULED = EXPIRED + 1;  //!< location of idle classes
+
+    /**
+     * \brief File a class in the slot of its expiry, relative to m_now
+     * \param index the index of the class
+     */
+    void Insert(uint32_t index);
+
+    /**
+     * \brief Append a class to the expired classes
+     * \param index the index of the class
+     */
+    void Expire(uint32_t index);
+
+    /**
+     * \brief Unlink a class from its slot
+     * \param index the index of the class
+     */
+    void Unlink(uint32_t index);
+
+    /**
+     * \brief Get the start tick of the next occupied slot of a level
+     * \param level the level
+     * \return the tick, or NEVER if the level is empty
+     */
+    uint64_t NextSlotTick(uint32_t level) const;
+
+    uint64_t m_now;                              //!< the tick reached by the wheel
+    uint32_t m_nScheduled;                       //!< the number of classes in the slots
+    std::array<uint64_t, LEVELS> m_occupied;     //!< occupied slots of each level
+    std::array<uint32_t, EXPIRED + 1> m_head;    //!< first class of each slot and of the expired
+    uint32_t m_expiredTail;                      //!< last expired class
+    std::vector<uint32_t> m_next;                //!< next class in the same slot
+    std::vector<uint32_t> m_prev;                //!< previous class in the same slot
+    std::vector<uint32_t> m_location;            //!< slot (or EXPIRED, UNSCHEDULED) of each class
+    std::vector<uint64_t> m_expiry;              //!< expiry of each class
+};
+
+} // namespace ns3
+
+#endif /* CLASS_TIMER_WHEEL_H */
@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "classful-scheduler-queue-disc.h"
+
+#include "ns3/fatal-error.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace ns3
+{
+
+ATTRIBUTE_HELPER_CPP(Quantum);
+
+std::ostream&
+operator<<(std::ostream& os, const Quantum& Quantum)
+{
+    if (Quantum.empty())
+    {
+        return os;
+    }
+    std::copy(Quantum.begin(), Quantum.end() - 1, std::ostream_iterator<uint16_t>(os, " "));
+    os << Quantum.back();
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, Quantum& Quantum)
+{
+
+    int temp;
+    while(!(is.eof()))
+    {   
+        
+        if (!(is >> temp))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        
+        Quantum.push_back(temp);
+
+    }
+    return is;
+}
+
+ATTRIBUTE_HELPER_CPP(MapQueue);
+std::ostream&
+operator<<(std::ostream& os, const MapQueue& map2)
+{
+    if (map2.empty())
+    {
+        return os;
+    }
+
+    // Copy all key-value pairs to the out stream except the last pair
+    for (auto it = map2.begin(); it != std::prev(map2.end()); ++it) {
+        os << it->first << " " << it->second << " ";
+    }
+    
+    // Copy the last key-value pair
+    if (!map2.empty()) {
+        os << map2.rbegin()->first << " " << map2.rbegin()->second;
+    }
+
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, MapQueue& map2)
+{
+    int key;
+    int value;
+    while (!(is.eof()))
+    {
+        if (!(is >> key >> value))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        map2.insert(std::pair<int, int>(key, value));
+    }
+    return is;
+}
+
+ATTRIBUTE_HELPER_CPP(RateList);
+
+std::ostream&
+operator<<(std::ostream& os, const RateList& rates)
+{
+    for (auto it = rates.begin(); it != rates.end(); ++it)
+    {
+        os << (it == rates.begin() ? "" : " ") << *it;
+    }
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, RateList& rates)
+{
+    DataRate rate;
+    while (!(is.eof()))
+    {
+        if (!(is >> rate))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        rates.push_back(rate);
+    }
+    return is;
+}
+
+} // namespace ns3
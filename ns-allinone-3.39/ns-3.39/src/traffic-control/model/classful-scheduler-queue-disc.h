@@ -0,0 +1,638 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CLASSFUL_SCHEDULER_QUEUE_DISC_H
+#define CLASSFUL_SCHEDULER_QUEUE_DISC_H
+
+#include "class-backlog-heap.h"
+#include "class-item-ring.h"
+#include "quantum-tuner.h"
+
+#include "ns3/attribute-helper.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/object-factory.h"
+#include "ns3/queue-disc.h"
+#include "ns3/queue.h"
+#include "ns3/simulator.h"
+#include "ns3/traced-callback.h"
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// Quantum (or weight) of each band
+typedef std::vector<int> Quantum;
+
+/// DSCP to band mapping
+typedef std::map<int, int> MapQueue;
+
+/// Rate of each band
+typedef std::vector<DataRate> RateList;
+
+/// DSCP to class index table, compiled from a MapQueue
+typedef std::array<uint16_t, 64> DscpClassMap;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief State of a class of a ClassfulSchedulerQueueDisc
+ *
+ * The classes of a scheduler are stored by value in a contiguous array
+ * indexed by band. The scheduling policy reads and updates the fields it
+ * needs and ignores the others.
+ */
+struct SchedClass
+{
+    /// Status of the class with respect to the scheduler
+    enum Status : uint8_t
+    {
+        INACTIVE,
+        NEW_CLASS,
+        OLD_CLASS,
+        SHAPED
+    };
+
+    QueueDisc* queue;   //!< the child queue disc, owned by the queue disc class, or null
+    ClassItemRing ring; //!< the packets of the class, if it has no child queue disc
+    int32_t quantum;    //!< the quantum (or weight) of the class
+    int32_t deficit;    //!< the deficit of the class
+    Status status;      //!< the status of the class
+    uint64_t tagStep;   //!< fixed-point virtual time per byte
+    uint64_t startTag;  //!< virtual start tag of the head packet
+    uint64_t finishTag; //!< virtual finish tag of the head packet
+
+    /**
+     * \brief Get the head packet of the class
+     * \return the head packet, or null if the class is empty
+     */
+    Ptr<const QueueDiscItem> Peek() const
+    {
+        return queue ? queue->Peek() : ring.Peek();
+    }
+
+    /**
+     * \brief Get the number of packets of the class
+     * \return the number of packets
+     */
+    uint32_t GetNPackets() const
+    {
+        return queue ? queue->GetNPackets() : ring.GetNPackets();
+    }
+
+    /**
+     * \brief Get the number of bytes of the class
+     * \return the number of bytes
+     */
+    uint32_t GetNBytes() const
+    {
+        return queue ? queue->GetNBytes() : ring.GetNBytes();
+    }
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Classful DSCP scheduler, specialised at compile time on a policy
+ *
+ * The queue disc classifies packets into bands through a flat DSCP table
+ * compiled from the MapQueue attribute, creates one FIFO child queue disc per
+ * band of the Quantum attribute and, on overload, drops from the class with
+ * the largest byte backlog. The choice of the class to serve is delegated to
+ * the Policy, which is a plain class whose methods are called directly (and
+ * usually inlined) on the array of class states:
+ *
+ * \verbatim
+   static uint32_t DefaultQuantum(uint32_t mtu);    // quantum used when null
+   void Reset(std::vector<SchedClass>& classes);    // at initialization time
+   void UpdateWeights(std::vector<SchedClass>& classes); // a quantum changed
+   void Activate(uint32_t index, SchedClass& cls);  // a class gets backlogged
+   bool Select(std::vector<SchedClass>& classes, uint32_t& index);
+   void Emptied(uint32_t index, SchedClass& cls);   // the selected class was empty
+   void Served(uint32_t index, SchedClass& cls, uint32_t size);
+   Time GetWakeTime() const;                        // a class may be eligible
+   \endverbatim
+ *
+ * When no class can be selected although some are backlogged (e.g., they
+ * are shaped), the queue disc arms a single event to run its root queue disc
+ * (itself, unless it is a child queue disc) at the time returned by
+ * GetWakeTime, as TbfQueueDisc does. A parent, such as PrioQueueDscpDisc,
+ * does not poll its children, so the root is run even if other classes keep
+ * it idle until then.
+ *
+ * The queue disc classes are still added to the queue disc, so that they can
+ * be inspected as usual, but the scheduler never goes through them.
+ *
+ * If the InlineClasses attribute is set, the classes have no child queue disc
+ * (and no queue disc class is added): the packets of each class are kept in a
+ * ClassItemRing owned by the queue disc, whose statistics and traces account
+ * for them directly. A class exceeding its size limit drops the arriving
+ * packet for the CLASS_LIMIT_DROP reason.
+ *
+ * A QuantumTuner set through the Tuner attribute (WRR and WDRR) is reported
+ * every dequeued packet and updates the quanta at run time.
+ */
+template <class Policy>
+class ClassfulSchedulerQueueDisc : public QueueDisc
+{
+  public:
+    ~ClassfulSchedulerQueueDisc() override;
+
+    /**
+     * \brief Set the quantum value of a band.
+     *
+     * \param id The band
+     * \param quantum The quantum (or weight) of the band
+     */
+    void SetQuantum(uint32_t id, uint32_t quantum);
+
+    /**
+     * \brief Get the quantum value of a band.
+     *
+     * \param id The band
+     * \returns The quantum (or weight) of the band
+     */
+    uint32_t GetQuantum(uint32_t id) const;
+
+    /**
+     * TracedCallback signature for scheduling decisions.
+     *
+     * \param [in] index The index of the selected class.
+     * \param [in] size The size of the dequeued packet.
+     * \param [in] deficit The deficit (or weight) of the class after the decision.
+     * \param [in] timestamp The time of the decision.
+     */
+    typedef void (*SchedulingDecisionTracedCallback)(uint32_t index,
+                                                     uint32_t size,
+                                                     int32_t deficit,
+                                                     Time timestamp);
+
+    // Reasons for dropping packets
+    static constexpr const char* UNCLASSIFIED_DROP =
+        "Unclassified drop"; //!< No packet filter able to classify packet
+    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    static constexpr const char* CLASS_LIMIT_DROP =
+        "Class queue limit exceeded"; //!< Packet dropped by a full inline class
+
+  protected:
+    /**
+     * \brief Constructor
+     * \param logComponent the name of the log component of the queue disc
+     * \param classTid the type of the queue disc classes
+     */
+    ClassfulSchedulerQueueDisc(const std::string& logComponent, TypeId classTid);
+
+    void DoDispose() override;
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+
+    /**
+     * \brief Make sure the root queue disc runs at the given time, if it sends packets
+     * \param when the time, or Time::Max () if no wake-up is needed
+     */
+    void ScheduleWake(Time when);
+
+    /**
+     * \brief Drop packets from the head of the class with the largest byte backlog
+     * \return the index of the class with the largest byte backlog
+     */
+    uint32_t FatClassDrop();
+
+    /**
+     * \brief Remove the head packet of a class
+     * \param cls the class
+     * \return the packet, or null if the class is empty
+     */
+    Ptr<QueueDiscItem> PopHead(SchedClass& cls);
+
+    uint32_t m_dropBatchSize;         //!< Max number of packets dropped from the fat flow
+    DscpClassMap m_dscpToClass;       //!< Class index for each DSCP, compiled from the MapQueue
+    ClassBacklogHeap m_backlog;       //!< Byte backlog of the classes, to find the fat flow
+    QueueSize m_classMaxSize;         //!< Max size of each class queue (0 to use MaxSize)
+    QueueSize m_classLimit;           //!< Max size of each class queue, as applied
+    bool m_inlineClasses;             //!< Whether the classes are rings instead of queue discs
+    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
+    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+
+    Quantum m_quantum; //!< Deficit assigned to flows at each round
+    MapQueue mapuca;   //!< DSCP to band mapping
+
+    std::vector<SchedClass> m_classes; //!< State of the classes, indexed by band
+    Policy m_policy;                   //!< The scheduling policy
+    EventId m_wakeEvent;               //!< The event to run the queue disc again
+    Ptr<QuantumTuner> m_tuner;         //!< The controller of the quanta, if any
+
+    /// Traced callback: fired for every packet selected by the scheduler
+    TracedCallback<uint32_t, uint32_t, int32_t, Time> m_schedulingDecisionTrace;
+
+    NS_LOG_TEMPLATE_DECLARE; //!< the log component
+};
+
+/**
+ * Serialize the quantum to the given ostream
+ *
+ * \param os
+ * \param quantum
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const Quantum& quantum);
+
+/**
+ * Serialize from the given istream to this quantum.
+ *
+ * \param is
+ * \param quantum
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, Quantum& quantum);
+
+ATTRIBUTE_HELPER_HEADER(Quantum);
+
+/**
+ * Serialize the DSCP to band mapping to the given ostream
+ *
+ * \param os
+ * \param map2
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const MapQueue& map2);
+
+/**
+ * Serialize from the given istream to this DSCP to band mapping.
+ *
+ * \param is
+ * \param map2
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, MapQueue& map2);
+
+ATTRIBUTE_HELPER_HEADER(MapQueue);
+
+/**
+ * Serialize the rates to the given ostream
+ *
+ * \param os
+ * \param rates
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const RateList& rates);
+
+/**
+ * Serialize from the given istream to these rates.
+ *
+ * \param is
+ * \param rates
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, RateList& rates);
+
+ATTRIBUTE_HELPER_HEADER(RateList);
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <class Policy>
+ClassfulSchedulerQueueDisc<Policy>::ClassfulSchedulerQueueDisc(const std::string& logComponent,
+                                                               TypeId classTid)
+    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+      m_inlineClasses(false),
+      m_quantum(0),
+      NS_LOG_TEMPLATE_DEFINE(logComponent)
+{
+    NS_LOG_FUNCTION(this);
+    m_flowFactory.SetTypeId(classTid);
+}
+
+template <class Policy>
+ClassfulSchedulerQueueDisc<Policy>::~ClassfulSchedulerQueueDisc()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+template <class Policy>
+void
+ClassfulSchedulerQueueDisc<Policy>::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_wakeEvent.Cancel();
+    m_classes.clear();
+    if (m_tuner)
+    {
+        m_tuner->Dispose();
+        m_tuner = nullptr;
+    }
+    QueueDisc::DoDispose();
+}
+
+template <class Policy>
+void
+ClassfulSchedulerQueueDisc<Policy>::SetQuantum(uint32_t id, uint32_t quantum)
+{
+    NS_LOG_FUNCTION(this << id << quantum);
+    m_quantum[id] = quantum;
+    if (id < m_classes.size())
+    {
+        m_classes[id].quantum = quantum;
+        m_policy.UpdateWeights(m_classes);
+    }
+}
+
+template <class Policy>
+uint32_t
+ClassfulSchedulerQueueDisc<Policy>::GetQuantum(uint32_t id) const
+{
+    return m_quantum[id];
+}
+
+template <class Policy>
+bool
+ClassfulSchedulerQueueDisc<Policy>::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+
+    // The DSCP table holds the class of every DSCP (band 0 if not configured)
+    uint32_t band = m_dscpToClass[item->GetClassKey().dscp];
+    SchedClass& cls = m_classes[band];
+
+    bool retval;
+    if (cls.queue)
+    {
+        retval = cls.queue->Enqueue(item);
+    }
+    else if (QueueSize(m_classLimit.GetUnit(),
+                       m_classLimit.GetUnit() == QueueSizeUnit::PACKETS ? cls.ring.GetNPackets()
+                                                                        : cls.ring.GetNBytes()) +
+                 item >
+             m_classLimit)
+    {
+        DropBeforeEnqueue(item, CLASS_LIMIT_DROP);
+        retval = false;
+    }
+    else
+    {
+        cls.ring.Push(item);
+        PacketEnqueued(item);
+        retval = true;
+    }
+    m_backlog.Update(band, cls.GetNBytes());
+
+    if (retval && cls.status == SchedClass::INACTIVE)
+    {
+        m_policy.Activate(band, cls);
+    }
+
+    NS_LOG_INFO("Enqueue: number of packets in band " << band << ": " << cls.GetNPackets());
+
+    if (GetCurrentSize() > GetMaxSize())
+    {
+        NS_LOG_DEBUG("Overload; enter FatClassDrop ()");
+        FatClassDrop();
+    }
+    return retval;
+}
+
+template <class Policy>
+Ptr<QueueDiscItem>
+ClassfulSchedulerQueueDisc<Policy>::DoDequeue()
+{
+    NS_LOG_FUNCTION(this);
+
+    uint32_t index;
+    Ptr<QueueDiscItem> item;
+    do
+    {
+        if (!m_policy.Select(m_classes, index))
+        {
+            NS_LOG_DEBUG("No flow found to dequeue a packet");
+            ScheduleWake(m_policy.GetWakeTime());
+            return nullptr;
+        }
+
+        item = PopHead(m_classes[index]);
+
+        if (!item)
+        {
+            NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
+            m_policy.Emptied(index, m_classes[index]);
+        }
+    } while (!item);
+
+    SchedClass& cls = m_classes[index];
+    m_backlog.Update(index, cls.GetNBytes());
+    m_policy.Served(index, cls, item->GetSize());
+    this->RecordClassSojourn(index, item);
+    if (m_tuner)
+    {
+        m_tuner->Served(index,
+                        item->GetSize(),
+                        Simulator::Now() - item->GetTimeStamp(),
+                        cls.GetNPackets() > 0);
+    }
+
+    NS_LOG_INFO("Flow " << index << " has been selected with deficit " << cls.deficit);
+    NS_LOG_DEBUG("Dequeued packet " << item->GetPacket()->GetSize());
+
+    m_schedulingDecisionTrace(index, item->GetSize(), cls.deficit, Simulator::Now());
+
+    return item;
+}
+
+template <class Policy>
+bool
+ClassfulSchedulerQueueDisc<Policy>::CheckConfig()
+{
+    NS_LOG_FUNCTION(this);
+    if (GetNQueueDiscClasses() > 0)
+    {
+        NS_LOG_ERROR("The queue disc cannot have classes");
+        return false;
+    }
+
+    if (GetNInternalQueues() > 0)
+    {
+        NS_LOG_ERROR("The queue disc cannot have internal queues");
+        return false;
+    }
+
+    // we are at initialization time. If the user has not set a quantum value,
+    // let the policy pick one, based on the MTU of the device (if any)
+    for (auto& quantum : m_quantum)
+    {
+        if (!quantum)
+        {
+            uint32_t mtu = 0;
+            Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface();
+            Ptr<NetDevice> dev;
+            // if the NetDeviceQueueInterface object is aggregated to a
+            // NetDevice, get the MTU of such NetDevice
+            if (ndqi && (dev = ndqi->GetObject<NetDevice>()))
+            {
+                mtu = dev->GetMtu();
+            }
+            quantum = Policy::DefaultQuantum(mtu);
+            NS_LOG_DEBUG("Setting the quantum to its default value: " << quantum);
+
+            if (!quantum)
+            {
+                NS_LOG_ERROR("The quantum parameter cannot be null");
+                return false;
+            }
+        }
+    }
+
+    // Compile the MapQueue into a flat DSCP to class table. Every class is
+    // created at initialization time, one per band, with class index == band
+    m_dscpToClass.fill(0);
+    for (const auto& entry : mapuca)
+    {
+        if (entry.first < 0 || entry.first >= static_cast<int>(m_dscpToClass.size()))
+        {
+            NS_LOG_ERROR("Invalid DSCP value " << entry.first << " in the MapQueue");
+            return false;
+        }
+        if (entry.second < 0 || entry.second >= static_cast<int>(m_quantum.size()))
+        {
+            NS_LOG_ERROR("The MapQueue maps DSCP " << entry.first << " to band " << entry.second
+                                                   << ", which has no Quantum");
+            return false;
+        }
+        m_dscpToClass[entry.first] = entry.second;
+    }
+
+    return true;
+}
+
+template <class Policy>
+void
+ClassfulSchedulerQueueDisc<Policy>::ScheduleWake(Time when)
+{
+    NS_LOG_FUNCTION(this << when);
+
+    QueueDisc* root = GetRootQueueDisc();
+    if (when == Time::Max() || !root->GetSendCallback())
+    {
+        return;
+    }
+    if (m_wakeEvent.IsRunning() && m_wakeEvent.GetTs() <= uint64_t(when.GetTimeStep()))
+    {
+        return;
+    }
+    m_wakeEvent.Cancel();
+    m_wakeEvent = Simulator::Schedule(when - Simulator::Now(), &QueueDisc::Run, root);
+    NS_LOG_LOGIC("Waking event scheduled at " << when.As(Time::S));
+}
+
+template <class Policy>
+uint32_t
+ClassfulSchedulerQueueDisc<Policy>::FatClassDrop()
+{
+    NS_LOG_FUNCTION(this);
+
+    /* Queue is full! Drop packet(s) from the fat flow, tracked by the backlog heap */
+    uint32_t index = m_backlog.GetFattest();
+    uint32_t maxBacklog = m_backlog.GetBacklog(index);
+    SchedClass& cls = m_classes[index];
+
+    /* Our goal is to drop half of this fat flow backlog */
+    uint32_t len = 0;
+    uint32_t count = 0;
+    uint32_t threshold = maxBacklog >> 1;
+    Ptr<QueueDiscItem> item;
+
+    do
+    {
+        NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
+                                                       << " threshold: " << threshold);
+        // bypass the child queue disc, if any, which would record a dequeue
+        item = cls.queue ? cls.queue->GetInternalQueue(0)->Dequeue() : PopHead(cls);
+        DropAfterDequeue(item, OVERLIMIT_DROP);
+        len += item->GetSize();
+    } while (++count < m_dropBatchSize && len < threshold);
+
+    m_backlog.Update(index, cls.GetNBytes());
+    return index;
+}
+
+template <class Policy>
+Ptr<QueueDiscItem>
+ClassfulSchedulerQueueDisc<Policy>::PopHead(SchedClass& cls)
+{
+    if (cls.queue)
+    {
+        return cls.queue->Dequeue();
+    }
+
+    Ptr<QueueDiscItem> item = cls.ring.Pop();
+    if (item)
+    {
+        PacketDequeued(item);
+    }
+    return item;
+}
+
+template <class Policy>
+void
+ClassfulSchedulerQueueDisc<Policy>::InitializeParams()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_classLimit = m_classMaxSize.GetValue() ? m_classMaxSize : GetMaxSize();
+    m_queueDiscFactory.SetTypeId("ns3::FifoQueueDisc");
+    m_queueDiscFactory.Set("MaxSize", QueueSizeValue(m_classLimit));
+    m_backlog.Reset(m_quantum.size());
+
+    m_classes.assign(m_quantum.size(), SchedClass());
+    for (uint32_t band = 0; band < m_quantum.size(); band++)
+    {
+        SchedClass& cls = m_classes[band];
+        cls.queue = nullptr;
+        if (!m_inlineClasses)
+        {
+            Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
+            Ptr<QueueDiscClass> flow = m_flowFactory.Create<QueueDiscClass>();
+            flow->SetQueueDisc(qd);
+            AddQueueDiscClass(flow);
+            cls.queue = PeekPointer(qd);
+        }
+        cls.quantum = m_quantum[band];
+        cls.deficit = m_quantum[band];
+        cls.status = SchedClass::INACTIVE;
+    }
+    m_policy.Reset(m_classes);
+
+    if (m_tuner)
+    {
+        m_tuner->Start(m_quantum, MakeCallback(&ClassfulSchedulerQueueDisc::SetQuantum, this));
+    }
+}
+
+} // namespace ns3
+
+#endif /* CLASSFUL_SCHEDULER_QUEUE_DISC_H */
@@ -80,6 +80,14 @@ FifoQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     return retval;
 }
 
+bool
+FifoQueueDisc::DoBypass(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+    // an empty FIFO would dequeue the item right away
+    return true;
+}
+
 Ptr<QueueDiscItem>
 FifoQueueDisc::DoDequeue()
 {
@@ -56,6 +56,7 @@ class FifoQueueDisc : public QueueDisc
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
     Ptr<const QueueDiscItem> DoPeek() override;
+    bool DoBypass(Ptr<QueueDiscItem> item) override;
     bool CheckConfig() override;
     void InitializeParams() override;
 };
@@ -0,0 +1,647 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "hqos-queue-disc.h"
+
+#include "ns3/drop-tail-queue.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HqosQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED(HqosQueueDisc);
+
+/// Fixed-point shift of the WFQ virtual clock
+static constexpr uint32_t HQOS_TAG_SHIFT = 12;
+
+TypeId
+HqosQueueDisc::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::HqosQueueDisc")
+            .SetParent<QueueDisc>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<HqosQueueDisc>()
+            .AddAttribute("MaxSize",
+                          "The max queue size",
+                          QueueSizeValue(QueueSize("1000p")),
+                          MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
+                          MakeQueueSizeChecker())
+            .AddAttribute("LeafMaxSize",
+                          "The max size of the queue of each leaf",
+                          QueueSizeValue(QueueSize("1000p")),
+                          MakeQueueSizeAccessor(&HqosQueueDisc::m_leafMaxSize),
+                          MakeQueueSizeChecker())
+            .AddAttribute("Tree",
+                          "The scheduling tree, e.g., sp(leaf(46) wdrr(1500:leaf(8) 3000:leaf(*)))",
+                          StringValue("sp(leaf(46) leaf(*))"),
+                          MakeStringAccessor(&HqosQueueDisc::m_tree),
+                          MakeStringChecker());
+    return tid;
+}
+
+HqosQueueDisc::HqosQueueDisc()
+    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+      m_defaultLeaf(NONE),
+      m_epoch(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+HqosQueueDisc::~HqosQueueDisc()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+HqosQueueDisc::GetNLeaves() const
+{
+    return m_leaves.size();
+}
+
+void
+HqosQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_id.Cancel();
+    QueueDisc::DoDispose();
+}
+
+bool
+HqosQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+
+    if (GetCurrentSize() + item > GetMaxSize())
+    {
+        NS_LOG_LOGIC("Queue full -- dropping pkt");
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        return false;
+    }
+
+    uint32_t leaf = m_defaultLeaf;
+    const QueueDiscItem::ClassKey& key = item->GetClassKey();
+    if (key.ip)
+    {
+        leaf = m_dscpToLeaf[key.dscp];
+    }
+
+    // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+    // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+    if (!GetInternalQueue(m_nodes[leaf].queue)->Enqueue(item))
+    {
+        return false;
+    }
+
+    // activate the leaf and the ancestors that were not backlogged
+    uint32_t index = leaf;
+    while (true)
+    {
+        Node& node = m_nodes[index];
+        bool activated = (node.backlog++ == 0);
+        if (node.parent == NONE)
+        {
+            break;
+        }
+        Node& parent = m_nodes[node.parent];
+        if (activated)
+        {
+            parent.nBacklogged++;
+            if (parent.type == WDRR)
+            {
+                node.deficit = node.quantum;
+                parent.active.PushBack(node.slot);
+            }
+            else if (parent.type == WFQ)
+            {
+                node.tag = std::max(parent.virtualTime, node.tag);
+            }
+        }
+        index = node.parent;
+    }
+
+    NS_LOG_LOGIC("Number packets leaf " << m_nodes[leaf].queue << ": "
+                                        << GetInternalQueue(m_nodes[leaf].queue)->GetNPackets());
+    return true;
+}
+
+Ptr<QueueDiscItem>
+HqosQueueDisc::DoDequeue()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_wakeTime = Time::Max();
+    m_epoch++;
+    uint32_t leaf = Select(0);
+
+    if (leaf == NONE)
+    {
+        // every backlogged subtree is shaped: run the root queue disc (only the
+        // root sends packets) when the first shaper can send
+        QueueDisc* root = GetRootQueueDisc();
+        if (m_wakeTime != Time::Max() && root->GetSendCallback() &&
+            (m_id.IsExpired() || m_wakeTime.GetTimeStep() < static_cast<int64_t>(m_id.GetTs())))
+        {
+            m_id.Cancel();
+            m_id = Simulator::Schedule(m_wakeTime - Simulator::Now(), &QueueDisc::Run, root);
+            NS_LOG_LOGIC("Waking Event Scheduled at " << m_wakeTime.As(Time::S));
+        }
+        NS_LOG_LOGIC("No leaf can be served");
+        return nullptr;
+    }
+
+    Ptr<QueueDiscItem> item = GetInternalQueue(m_nodes[leaf].queue)->Dequeue();
+    NS_ASSERT(item);
+    Charge(leaf, item->GetSize());
+
+    NS_LOG_LOGIC("Popped from leaf " << m_nodes[leaf].queue << ": " << item);
+    return item;
+}
+
+uint32_t
+HqosQueueDisc::Select(uint32_t index)
+{
+    Node& node = m_nodes[index];
+    if (node.backlog == 0)
+    {
+        return NONE;
+    }
+
+    switch (node.type)
+    {
+    case LEAF:
+        return index;
+
+    case SHAPER:
+        Refill(node);
+        if (node.tokens <= 0)
+        {
+            auto missing = static_cast<uint32_t>(std::ceil(-node.tokens)) + 1;
+            m_wakeTime =
+                std::min(m_wakeTime, Simulator::Now() + node.rate.CalculateBytesTxTime(missing));
+            return NONE;
+        }
+        return Select(m_children[node.firstChild]);
+
+    case SP:
+        for (uint32_t slot = 0; slot < node.nChildren; slot++)
+        {
+            uint32_t leaf = Select(m_children[node.firstChild + slot]);
+            if (leaf != NONE)
+            {
+                return leaf;
+            }
+        }
+        return NONE;
+
+    case WDRR: {
+        // stop when every backlogged child has been found shaped in this dequeue
+        uint32_t blocked = 0;
+        while (blocked < node.nBacklogged)
+        {
+            uint32_t childIndex = m_children[node.firstChild + node.active.Front()];
+            Node& child = m_nodes[childIndex];
+            if (child.shapedEpoch == m_epoch)
+            {
+                node.active.RotateFront();
+                continue;
+            }
+            if (child.deficit <= 0)
+            {
+                child.deficit += child.quantum;
+                node.active.RotateFront();
+                continue;
+            }
+            uint32_t leaf = Select(childIndex);
+            if (leaf != NONE)
+            {
+                return leaf;
+            }
+            child.shapedEpoch = m_epoch;
+            blocked++;
+            node.active.RotateFront();
+        }
+        return NONE;
+    }
+
+    case WFQ: {
+        // try the backlogged children by increasing start tag, skipping shaped ones
+        uint64_t tried = 0;
+        while (true)
+        {
+            uint32_t best = NONE;
+            for (uint32_t slot = 0; slot < node.nChildren; slot++)
+            {
+                const Node& child = m_nodes[m_children[node.firstChild + slot]];
+                if (child.backlog > 0 && !(tried & (uint64_t(1) << slot)) &&
+                    (best == NONE || child.tag < m_nodes[m_children[node.firstChild + best]].tag))
+                {
+                    best = slot;
+                }
+            }
+            if (best == NONE)
+            {
+                return NONE;
+            }
+            uint32_t leaf = Select(m_children[node.firstChild + best]);
+            if (leaf != NONE)
+            {
+                return leaf;
+            }
+            tried |= uint64_t(1) << best;
+        }
+    }
+    }
+    return NONE;
+}
+
+void
+HqosQueueDisc::Charge(uint32_t leaf, uint32_t size)
+{
+    uint32_t index = leaf;
+    while (true)
+    {
+        Node& node = m_nodes[index];
+        node.backlog--;
+        if (node.type == SHAPER)
+        {
+            node.tokens -= size;
+        }
+        if (node.parent == NONE)
+        {
+            break;
+        }
+
+        Node& parent = m_nodes[node.parent];
+        if (parent.type == WDRR)
+        {
+            node.deficit -= size;
+            if (node.backlog == 0)
+            {
+                // the served child is always at the head of the active list
+                NS_ASSERT(parent.active.Front() == node.slot);
+                parent.active.PopFront();
+            }
+        }
+        else if (parent.type == WFQ)
+        {
+            parent.virtualTime = node.tag;
+            node.tag += size * node.tagStep;
+        }
+        if (node.backlog == 0)
+        {
+            parent.nBacklogged--;
+        }
+        index = node.parent;
+    }
+}
+
+void
+HqosQueueDisc::Refill(Node& node)
+{
+    Time now = Simulator::Now();
+    double tokens = node.tokens + (now - node.lastRefill).GetSeconds() * node.rate.GetBitRate() / 8;
+    node.tokens = std::min(static_cast<double>(node.burst), tokens);
+    node.lastRefill = now;
+}
+
+uint32_t
+HqosQueueDisc::ParseNode(const std::vector<std::string>& tokens, size_t& pos, uint32_t parent)
+{
+    // the helpers log the syntax errors and return false
+    auto next = [&tokens, &pos](std::string& token) {
+        if (pos >= tokens.size())
+        {
+            NS_LOG_ERROR("Incomplete HQoS tree specification");
+            return false;
+        }
+        token = tokens[pos++];
+        return true;
+    };
+    auto expect = [&next](const std::string& expected) {
+        std::string token;
+        if (!next(token))
+        {
+            return false;
+        }
+        if (token != expected)
+        {
+            NS_LOG_ERROR("Invalid HQoS tree specification: expected " << expected << ", got "
+                                                                      << token);
+            return false;
+        }
+        return true;
+    };
+    auto toUint = [](const std::string& token, uint32_t& value) {
+        if (token.empty() || token.size() > 9 ||
+            !std::all_of(token.begin(), token.end(), ::isdigit))
+        {
+            NS_LOG_ERROR("Invalid HQoS tree specification: " << token << " is not a number");
+            return false;
+        }
+        value = std::stoul(token);
+        return true;
+    };
+
+    std::string type;
+    if (!next(type))
+    {
+        return NONE;
+    }
+    Node node{};
+    node.parent = parent;
+    node.tag = 0;
+    node.virtualTime = 0;
+
+    if (type == "sp")
+    {
+        node.type = SP;
+    }
+    else if (type == "wdrr")
+    {
+        node.type = WDRR;
+    }
+    else if (type == "wfq")
+    {
+        node.type = WFQ;
+    }
+    else if (type == "shaper")
+    {
+        node.type = SHAPER;
+    }
+    else if (type == "leaf")
+    {
+        node.type = LEAF;
+    }
+    else
+    {
+        NS_LOG_ERROR("Unknown HQoS tree node type " << type);
+        return NONE;
+    }
+    if (!expect("("))
+    {
+        return NONE;
+    }
+
+    uint32_t index = m_nodes.size();
+    m_nodes.push_back(node);
+    std::vector<uint32_t> children;
+
+    if (node.type == LEAF)
+    {
+        m_nodes[index].queue = m_leaves.size();
+        m_leaves.push_back(index);
+        while (pos < tokens.size() && tokens[pos] != ")")
+        {
+            std::string token = tokens[pos++];
+            if (token == "*")
+            {
+                m_defaultLeaf = index;
+                continue;
+            }
+            uint32_t dscp;
+            if (!toUint(token, dscp))
+            {
+                return NONE;
+            }
+            if (dscp >= m_dscpToLeaf.size())
+            {
+                NS_LOG_ERROR("Invalid DSCP value " << dscp);
+                return NONE;
+            }
+            if (m_dscpToLeaf[dscp] != NONE)
+            {
+                NS_LOG_ERROR("DSCP " << dscp << " is in two leaves");
+                return NONE;
+            }
+            m_dscpToLeaf[dscp] = index;
+        }
+    }
+    else if (node.type == SHAPER)
+    {
+        std::string rate;
+        std::string burst;
+        if (!next(rate) || !next(burst))
+        {
+            return NONE;
+        }
+        std::istringstream iss(rate);
+        if (!(iss >> m_nodes[index].rate))
+        {
+            NS_LOG_ERROR("Invalid HQoS tree specification: " << rate << " is not a data rate");
+            return NONE;
+        }
+        if (!toUint(burst, m_nodes[index].burst))
+        {
+            return NONE;
+        }
+        m_nodes[index].tokens = m_nodes[index].burst;
+        uint32_t child = ParseNode(tokens, pos, index);
+        if (child == NONE)
+        {
+            return NONE;
+        }
+        children.push_back(child);
+    }
+    else
+    {
+        while (pos < tokens.size() && tokens[pos] != ")")
+        {
+            uint32_t weight = 0;
+            if (node.type != SP)
+            {
+                std::string token;
+                if (!next(token) || !toUint(token, weight))
+                {
+                    return NONE;
+                }
+                if (weight == 0)
+                {
+                    NS_LOG_ERROR("HQoS tree weights and quanta must be positive");
+                    return NONE;
+                }
+                if (!expect(":"))
+                {
+                    return NONE;
+                }
+            }
+            uint32_t child = ParseNode(tokens, pos, index);
+            if (child == NONE)
+            {
+                return NONE;
+            }
+            m_nodes[child].quantum = weight;
+            children.push_back(child);
+        }
+    }
+    if (!expect(")"))
+    {
+        return NONE;
+    }
+
+    if (node.type != LEAF && children.empty())
+    {
+        NS_LOG_ERROR("HQoS tree node " << type << " has no children");
+        return NONE;
+    }
+    if (node.type == WFQ && children.size() > 64)
+    {
+        NS_LOG_ERROR("HQoS tree WFQ nodes support at most 64 children");
+        return NONE;
+    }
+
+    m_nodes[index].firstChild = m_children.size();
+    m_nodes[index].nChildren = children.size();
+    uint64_t weightSum = 0;
+    for (uint32_t slot = 0; slot < children.size(); slot++)
+    {
+        m_nodes[children[slot]].slot = slot;
+        m_children.push_back(children[slot]);
+        weightSum += m_nodes[children[slot]].quantum;
+    }
+
+    if (node.type == WDRR)
+    {
+        m_nodes[index].active.Reset(children.size());
+    }
+    else if (node.type == WFQ)
+    {
+        for (auto child : children)
+        {
+            m_nodes[child].tagStep = (weightSum << HQOS_TAG_SHIFT) / m_nodes[child].quantum;
+        }
+    }
+    return index;
+}
+
+bool
+HqosQueueDisc::CheckConfig()
+{
+    NS_LOG_FUNCTION(this);
+    if (GetNQueueDiscClasses() > 0)
+    {
+        NS_LOG_ERROR("HqosQueueDisc cannot have classes");
+        return false;
+    }
+
+    if (GetNPacketFilters() > 0)
+    {
+        NS_LOG_ERROR("HqosQueueDisc needs no packet filter");
+        return false;
+    }
+
+    if (GetNInternalQueues() > 0)
+    {
+        NS_LOG_ERROR("HqosQueueDisc creates its internal queues from the tree");
+        return false;
+    }
+
+    // Compile the tree: tokenize the specification and parse it from the root
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char c : m_tree)
+    {
+        if (std::isspace(static_cast<unsigned char>(c)) || c == '(' || c == ')' || c == ':')
+        {
+            if (!token.empty())
+            {
+                tokens.push_back(token);
+                token.clear();
+            }
+            if (c == '(' || c == ')' || c == ':')
+            {
+                tokens.emplace_back(1, c);
+            }
+        }
+        else
+        {
+            token += c;
+        }
+    }
+    if (!token.empty())
+    {
+        tokens.push_back(token);
+    }
+
+    m_nodes.clear();
+    m_children.clear();
+    m_leaves.clear();
+    m_dscpToLeaf.fill(NONE);
+    m_defaultLeaf = NONE;
+
+    size_t pos = 0;
+    if (ParseNode(tokens, pos, NONE) == NONE)
+    {
+        NS_LOG_ERROR("Cannot parse the HQoS tree " << m_tree);
+        return false;
+    }
+    if (pos != tokens.size())
+    {
+        NS_LOG_ERROR("Trailing tokens in the HQoS tree specification");
+        return false;
+    }
+    if (m_leaves.empty())
+    {
+        NS_LOG_ERROR("The HQoS tree has no leaves");
+        return false;
+    }
+
+    // the DSCPs no leaf claims go to the default leaf, or else to the first one
+    if (m_defaultLeaf == NONE)
+    {
+        m_defaultLeaf = m_leaves[0];
+    }
+    for (auto& leaf : m_dscpToLeaf)
+    {
+        if (leaf == NONE)
+        {
+            leaf = m_defaultLeaf;
+        }
+    }
+
+    ObjectFactory factory;
+    factory.SetTypeId("ns3::DropTailQueue<QueueDiscItem>");
+    factory.Set("MaxSize", QueueSizeValue(m_leafMaxSize));
+    for (uint32_t i = 0; i < m_leaves.size(); i++)
+    {
+        AddInternalQueue(factory.Create<InternalQueue>());
+    }
+
+    NS_LOG_LOGIC("HQoS tree compiled into " << m_nodes.size() << " nodes and "
+                                            << m_leaves.size() << " leaves");
+    return true;
+}
+
+void
+HqosQueueDisc::InitializeParams()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& node : m_nodes)
+    {
+        node.lastRefill = Simulator::Now();
+    }
+}
+
+} // namespace ns3
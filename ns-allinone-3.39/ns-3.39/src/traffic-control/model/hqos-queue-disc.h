@@ -0,0 +1,181 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HQOS_QUEUE_DISC_H
+#define HQOS_QUEUE_DISC_H
+
+#include "active-class-list.h"
+
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/queue-disc.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A hierarchical QoS queue disc compiled from a scheduling tree
+ *
+ * The whole hierarchy (e.g., port, slice, service class) is a single queue
+ * disc. The Tree attribute describes it with the following grammar:
+ *
+ * \verbatim
+   node := sp( node ... )
+         | wdrr( quantum:node ... )
+         | wfq( weight:node ... )
+         | shaper( rate burst node )
+         | leaf( dscp ... )
+   \endverbatim
+ *
+ * For instance, "sp(leaf(46) wdrr(1500:leaf(8) 3000:leaf(16 24)))" serves
+ * EF first and shares the rest between CS1 and CS2/CS3 in a 1:2 ratio.
+ *
+ * SP nodes serve their children in order of declaration. WDRR nodes serve
+ * their children with deficit round robin, with the given quantum in bytes.
+ * WFQ nodes serve the backlogged child with the smallest virtual start tag,
+ * with the given weight. Shaper nodes limit their child to rate with a token
+ * bucket of burst bytes, which may overdraw by one packet. A leaf is a FIFO
+ * queue receiving the packets whose DSCP is listed; a "*" marks the leaf of
+ * the unlisted DSCPs, otherwise they go to the first leaf.
+ *
+ * The tree is compiled into a flat table of nodes, addressed by index, and
+ * every leaf is an internal queue of the queue disc. A packet is classified
+ * with a table lookup, and a dequeue walks the tree once from the root to
+ * select a leaf and once from the leaf back to the root to charge it.
+ */
+class HqosQueueDisc : public QueueDisc
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    /**
+     * \brief HqosQueueDisc constructor
+     */
+    HqosQueueDisc();
+
+    ~HqosQueueDisc() override;
+
+    /**
+     * \brief Get the number of leaves of the compiled tree
+     * \return the number of leaves
+     */
+    uint32_t GetNLeaves() const;
+
+    // Reasons for dropping packets
+    static constexpr const char* LIMIT_EXCEEDED_DROP =
+        "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+
+    /// Type of a node of the scheduling tree
+    enum NodeType
+    {
+        SP,
+        WDRR,
+        WFQ,
+        SHAPER,
+        LEAF
+    };
+
+    /// Marker for no node
+    static constexpr uint32_t NONE = 0xffffffff;
+
+    /**
+     * \brief A node of the compiled scheduling tree
+     */
+    struct Node
+    {
+        NodeType type;          //!< the type of the node
+        uint32_t parent;        //!< the index of the parent node (NONE for the root)
+        uint32_t slot;          //!< the position of the node among its siblings
+        uint32_t firstChild;    //!< the position of the first child in m_children
+        uint32_t nChildren;     //!< the number of children
+        uint32_t backlog;       //!< the number of packets queued in the subtree
+        uint32_t nBacklogged;   //!< the number of children with a backlog
+        uint32_t queue;         //!< leaves: the index of the internal queue
+        int64_t quantum;        //!< child of WDRR: the quantum, in bytes
+        int64_t deficit;        //!< child of WDRR: the deficit, in bytes
+        uint64_t shapedEpoch;   //!< child of WDRR: the last dequeue that found it shaped
+        uint64_t tagStep;       //!< child of WFQ: fixed-point virtual time per byte
+        uint64_t tag;           //!< child of WFQ: the virtual start tag
+        ActiveClassList active; //!< WDRR: the backlogged children, by slot
+        uint64_t virtualTime;   //!< WFQ: the virtual clock
+        DataRate rate;          //!< shapers: the rate
+        uint32_t burst;         //!< shapers: the bucket size, in bytes
+        double tokens;          //!< shapers: the bucket content, in bytes
+        Time lastRefill;        //!< shapers: the last time tokens were added
+    };
+
+    /**
+     * \brief Parse a node of the Tree attribute and add it to the table
+     * \param tokens the tokens of the Tree attribute
+     * \param pos the position of the next token, updated
+     * \param parent the index of the parent node
+     * \return the index of the new node, or NONE if the specification is invalid
+     */
+    uint32_t ParseNode(const std::vector<std::string>& tokens, size_t& pos, uint32_t parent);
+
+    /**
+     * \brief Select the leaf to serve in the subtree of a node, if any
+     * \param index the index of the node
+     * \return the index of the selected leaf, or NONE if the subtree is empty or shaped
+     */
+    uint32_t Select(uint32_t index);
+
+    /**
+     * \brief Charge a packet dequeued from a leaf to the leaf and its ancestors
+     * \param leaf the index of the leaf
+     * \param size the size of the packet
+     */
+    void Charge(uint32_t leaf, uint32_t size);
+
+    /**
+     * \brief Add the tokens accumulated by a shaper since its last refill
+     * \param node the shaper
+     */
+    void Refill(Node& node);
+
+    std::string m_tree;                     //!< the Tree attribute
+    QueueSize m_leafMaxSize;                //!< the capacity of each leaf
+    std::vector<Node> m_nodes;              //!< the nodes, the root first
+    std::vector<uint32_t> m_children;       //!< the children of every node, contiguous
+    std::vector<uint32_t> m_leaves;         //!< the leaf node of each internal queue
+    std::array<uint32_t, 64> m_dscpToLeaf;  //!< the leaf node of each DSCP
+    uint32_t m_defaultLeaf;                 //!< the leaf node of the unlisted DSCPs
+    Time m_wakeTime;                        //!< the earliest time a shaper can send again
+    uint64_t m_epoch;                       //!< the number of dequeue attempts
+    EventId m_id;                           //!< the event to wake a shaped queue disc
+};
+
+} // namespace ns3
+
+#endif /* HQOS_QUEUE_DISC_H */
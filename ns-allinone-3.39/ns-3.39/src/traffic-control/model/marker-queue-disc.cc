@@ -25,10 +25,7 @@
 #include "ns3/object-factory.h"
 #include "ns3/queue.h"
 #include "ns3/socket.h"
-#include "ns3/ipv4-queue-disc-item.h"
-#include "ns3/udp-header.h"
 #include "ns3/ipv4-header.h"
-#include "ns3/udp-l4-protocol.h"
 
 
 #include "ns3/pointer.h"
@@ -36,6 +33,8 @@
 #include "ns3/string.h"
 #include "ns3/test.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -77,6 +76,35 @@ MarkerQueueDisc::~MarkerQueueDisc()
 
 
 
+Ipv4Header::DscpType
+MarkerQueueDisc::LookupDscp(uint16_t port) const
+{
+    auto it = std::upper_bound(m_portRanges.begin(),
+                               m_portRanges.end(),
+                               port,
+                               [](uint32_t p, const PortRange& r) { return p < r.start; });
+    if (it != m_portRanges.begin() && port < (--it)->end)
+    {
+        return it->dscp;
+    }
+    // If the port was not found in any range, assign a default DSCP value (CS4)
+    return Ipv4Header::DSCP_CS4;
+}
+
+void
+MarkerQueueDisc::Remark(Ptr<QueueDiscItem> item) const
+{
+    // The ports are read once and cached in the item, which updates the cached
+    // DSCP as well when it is remarked
+    uint16_t destPort = item->GetClassKey().dstPort;
+
+    Ipv4Header::DscpType dscp = LookupDscp(destPort);
+    NS_LOG_INFO("Port " << destPort << " marked with DSCP " << dscp);
+    uint8_t tos = 0;
+    item->GetUint8Value(QueueItem::IP_DSFIELD, tos);
+    item->SetUint8Value(QueueItem::IP_DSFIELD, (dscp << 2) | (tos & 0x3));
+}
+
 bool
 MarkerQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 {
@@ -90,64 +118,26 @@ MarkerQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     }
 
     int band = 0;
-    Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
-    Ipv4Header ipHeader = ipItem->GetHeader();
-    Ptr<Packet> writablePacket = ipItem->GetPacket()->Copy(); // Copia para no modificar el original
-
-    Ipv4Header ipv4Header;
-    UdpHeader udpHeader;
-
-    // Parse the IPv4 header
-    writablePacket->RemoveHeader(ipv4Header);
-    // Parse the UDP header
-    writablePacket->RemoveHeader(udpHeader);
-    
-    // Obtain the source port
-    uint16_t udpDestPort = udpHeader.GetDestinationPort();
-
-    // Get an iterator pointing to the first element in the map
-    std::map<int, int>::iterator it = markingMap.begin();
-
-    // Initialize a variable to track whether the port was found in the range
-    bool portFound = false;
- 
-    // Iterate over the map to find the port within the range
-    while (it != markingMap.end()) {
-        // Check if the port is within the range
-        if (udpDestPort >= it->first && udpDestPort < (it->first + 100)) {
-            // If found, set the corresponding DSCP value
-            ipHeader.SetDscp(ns3::Ipv4Header::DscpType(it->second));
-            band = 0;
-            portFound = true;
-            break; // Exit the loop once found
-        }
-        ++it;
-    }
-
-    // If the port was not found in the range, assign a default DSCP value (e.g., CS4)
-    if (!portFound) {
-        NS_LOG_INFO("Src Port");
-        ipHeader.SetDscp(Ipv4Header::DSCP_CS4);
-        band = 0;
-    }
-    
-  
-    Ptr<Packet> modpkt = ipItem->GetPacket()->Copy();
-    modpkt->RemoveHeader(ipHeader);
-    Ptr<QueueDiscItem> modifiedQueueItem = Create<Ipv4QueueDiscItem>(modpkt, ipItem->GetAddress(), ipItem->GetProtocol(), ipHeader);
-
+    Remark(item);
 
-    bool retval = GetInternalQueue(band)->Enqueue(modifiedQueueItem);
+    bool retval = GetInternalQueue(band)->Enqueue(item);
     if (!retval)
     {
         NS_LOG_WARN("Packet enqueue failed. Check the size of the internal queues");
     }
 
-   
-
     return retval;
 }
 
+bool
+MarkerQueueDisc::DoBypass(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+    // marking is all the work done on a packet that does not wait
+    Remark(item);
+    return true;
+}
+
 Ptr<QueueDiscItem>
 MarkerQueueDisc::DoDequeue()
 {
@@ -244,6 +234,27 @@ MarkerQueueDisc::CheckConfig()
         }
     }
 
+    // Compile the marking map into sorted, disjoint port ranges. Entries are
+    // visited by increasing port, so on overlapping ranges the lowest key
+    // wins, as it does when the map is walked in order
+    m_portRanges.clear();
+    uint32_t covered = 0;
+    for (const auto& entry : markingMap)
+    {
+        if (entry.first < 0 || entry.first > 65535)
+        {
+            NS_LOG_ERROR("Invalid port " << entry.first << " in the MarkingQueue");
+            return false;
+        }
+        uint32_t start = std::max<uint32_t>(entry.first, covered);
+        uint32_t end = entry.first + MARKING_PORT_RANGE;
+        if (start < end)
+        {
+            m_portRanges.push_back({start, end, Ipv4Header::DscpType(entry.second)});
+        }
+        covered = std::max(covered, end);
+    }
+
     return true;
 }
 
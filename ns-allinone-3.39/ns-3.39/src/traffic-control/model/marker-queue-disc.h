@@ -25,6 +25,9 @@
 #include "ns3/queue-disc.h"
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/wdrr-queue-disc.h"
+
+#include <vector>
+
 namespace ns3
 {
 
@@ -71,7 +74,35 @@ class MarkerQueueDisc : public QueueDisc
     static constexpr const char* LIMIT_EXCEEDED_DROP =
         "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
 
+    /// Number of destination ports marked by each MarkingQueue entry, starting at its key
+    static constexpr uint32_t MARKING_PORT_RANGE = 100;
+
   private:
+    /**
+     * \brief A range of destination ports marked with the same DSCP
+     */
+    struct PortRange
+    {
+        uint32_t start;            //!< first port of the range
+        uint32_t end;              //!< one past the last port of the range
+        Ipv4Header::DscpType dscp; //!< DSCP assigned to the range
+    };
+
+    /**
+     * \brief Find the DSCP for a destination port by binary search on the port ranges
+     * \param port the destination port
+     * \return the DSCP of the range including the port, or CS4 if none does
+     */
+    Ipv4Header::DscpType LookupDscp(uint16_t port) const;
+
+    /**
+     * \brief Set the DSCP of an item from the destination port of its packet
+     * \param item the item, which must carry an IP header
+     */
+    void Remark(Ptr<QueueDiscItem> item) const;
+
+    std::vector<PortRange> m_portRanges; //!< Sorted, disjoint port ranges compiled from markingMap
+
     /**
      * Priority to band map. Values are taken from the prio2band array used by
      * the Linux pfifo_fast queue disc.
@@ -82,6 +113,7 @@ class MarkerQueueDisc : public QueueDisc
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override ;
     Ptr<const QueueDiscItem> DoPeek() override;
+    bool DoBypass(Ptr<QueueDiscItem> item) override;
     bool CheckConfig() override;
     void InitializeParams() override;
 };
@@ -19,19 +19,12 @@
 
 #include "prio-queue-dscp-disc.h"
 
-
-
-
-
 #include "ns3/log.h"
 #include "ns3/object-factory.h"
-#include "ns3/pointer.h"
-#include "ns3/socket.h"
-#include "ns3/ipv4-queue-disc-item.h"
-#include "ns3/net-device-queue-interface.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
-#include <iterator>
 
 namespace ns3
 {
@@ -40,8 +33,6 @@ NS_LOG_COMPONENT_DEFINE("PrioQueueDscpDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(PrioQueueDscpDisc);
 
-
-
 TypeId
 PrioQueueDscpDisc::GetTypeId()
 {
@@ -49,15 +40,39 @@ PrioQueueDscpDisc::GetTypeId()
         TypeId("ns3::PrioQueueDscpDisc")
             .SetParent<QueueDisc>()
             .SetGroupName("TrafficControl")
-            .AddConstructor<PrioQueueDscpDisc>();
+            .AddConstructor<PrioQueueDscpDisc>()
+            .AddAttribute("MapQueue",
+                          "The band of each listed DSCP (DSCP band pairs)",
+                          MapQueueValue(MapQueue{{46, 0}}),
+                          MakeMapQueueAccessor(&PrioQueueDscpDisc::m_dscpMap),
+                          MakeMapQueueChecker())
+            .AddAttribute("DefaultBand",
+                          "The band of the DSCPs not listed in MapQueue",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&PrioQueueDscpDisc::m_defaultBand),
+                          MakeUintegerChecker<uint32_t>(0, MAX_BANDS - 1))
+            .AddAttribute("RateCap",
+                          "The rate cap of each band, 0 or missing for no cap",
+                          RateListValue(RateList{}),
+                          MakeRateListAccessor(&PrioQueueDscpDisc::m_rateCap),
+                          MakeRateListChecker())
+            .AddAttribute("RateCapBurst",
+                          "The size in bytes of the token bucket of the rate caps",
+                          UintegerValue(3000),
+                          MakeUintegerAccessor(&PrioQueueDscpDisc::m_capBurst),
+                          MakeUintegerChecker<uint32_t>(1));
 
     return tid;
 }
 
 PrioQueueDscpDisc::PrioQueueDscpDisc()
-    : QueueDisc(QueueDiscSizePolicy::NO_LIMITS)
+    : QueueDisc(QueueDiscSizePolicy::NO_LIMITS),
+      m_nonEmpty(0),
+      m_capped(0)
 {
     NS_LOG_FUNCTION(this);
+    m_dscpToBand.fill(0);
+    m_bands.fill(nullptr);
 }
 
 PrioQueueDscpDisc::~PrioQueueDscpDisc()
@@ -65,86 +80,151 @@ PrioQueueDscpDisc::~PrioQueueDscpDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+PrioQueueDscpDisc::SetBandForDscp(uint8_t dscp, uint8_t band)
+{
+    NS_LOG_FUNCTION(this << +dscp << +band);
+
+    NS_ASSERT_MSG(dscp < 64, "DSCP must be a value between 0 and 63");
+    NS_ASSERT_MSG(band < MAX_BANDS, "Band must be less than " << MAX_BANDS);
+
+    m_dscpMap[dscp] = band;
+    m_dscpToBand[dscp] = band;
+}
+
+uint8_t
+PrioQueueDscpDisc::GetBandForDscp(uint8_t dscp) const
+{
+    NS_LOG_FUNCTION(this << +dscp);
 
+    NS_ASSERT_MSG(dscp < 64, "DSCP must be a value between 0 and 63");
+
+    return m_dscpToBand[dscp];
+}
 
 bool
 PrioQueueDscpDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 {
     NS_LOG_FUNCTION(this << item);
 
-    
-    uint32_t band = 0;
-
-    Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
-    Ipv4Header ipHeader = ipItem->GetHeader();
+    uint32_t band = m_defaultBand;
+    const QueueDiscItem::ClassKey& key = item->GetClassKey();
+    if (key.ip)
+    {
+        band = m_dscpToBand[key.dscp];
+    }
+    NS_LOG_LOGIC("Packet assigned to band " << band);
 
-    // Extract DSCP value from the IP header
-    int dscp = ipHeader.GetDscp();
-    // Map DSCP to band
-    // Implement logic for mapping DSCP to bands here according to some RFC
-   
-    if (dscp == 46)
+    bool retval = m_bands[band]->Enqueue(item);
+    if (retval)
     {
-        band = 0;
-        NS_LOG_LOGIC("DSCP value: " << dscp << " band 0");
-    }else{
-        band = 1;
-        NS_LOG_LOGIC("DSCP value: " << dscp << " band " << band << "- EF");
+        m_nonEmpty |= 1U << band;
     }
-    
-
-    NS_ASSERT_MSG(band < GetNQueueDiscClasses(), "Selected band out of range");
-    bool retval = GetQueueDiscClass(band)->GetQueueDisc()->Enqueue(item);
-    NS_LOG_INFO(Simulator::Now().GetSeconds() << " PRIO Enqueue: Number packets band " << band << ": " <<  GetQueueDiscClass(band)->GetQueueDisc()->GetNPackets() << " from: " << ipHeader.GetSource());
-    NS_LOG_LOGIC("Number packets band " << band << ": "
-                                        << GetQueueDiscClass(band)->GetQueueDisc()->GetNPackets());
-    
+
+    NS_LOG_LOGIC("Number packets band " << band << ": " << m_bands[band]->GetNPackets());
+
     return retval;
 }
 
+bool
+PrioQueueDscpDisc::WithinCap(uint32_t band)
+{
+    if (!(m_capped & (1U << band)))
+    {
+        return true;
+    }
+
+    BandCap& cap = m_caps[band];
+    Time now = Simulator::Now();
+    cap.tokens = std::min<double>(m_capBurst,
+                                  cap.tokens + cap.rate.GetBitRate() *
+                                                   (now - cap.lastRefill).GetSeconds() / 8);
+    cap.lastRefill = now;
+    return cap.tokens > 0;
+}
+
+uint32_t
+PrioQueueDscpDisc::SelectBand(uint32_t bands)
+{
+    // the highest priority band within its cap, else the highest priority band
+    for (uint32_t left = bands; left; left &= left - 1)
+    {
+        uint32_t band = __builtin_ctz(left);
+        if (WithinCap(band))
+        {
+            return band;
+        }
+    }
+    return bands ? __builtin_ctz(bands) : MAX_BANDS;
+}
+
 Ptr<QueueDiscItem>
 PrioQueueDscpDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
+    return DequeueFrom(m_nonEmpty);
+}
+
+Ptr<const QueueDiscItem>
+PrioQueueDscpDisc::DoPeek()
+{
+    NS_LOG_FUNCTION(this);
+    return PeekFrom(m_nonEmpty);
+}
 
-    Ptr<QueueDiscItem> item;
+Ptr<QueueDiscItem>
+PrioQueueDscpDisc::DequeueFrom(uint32_t bands)
+{
+    NS_LOG_FUNCTION(this << bands);
 
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    // a child may hold packets it is not willing to send yet, in which case
+    // the next band is tried
+    for (uint32_t band = SelectBand(bands); band != MAX_BANDS; band = SelectBand(bands))
     {
-        if ((item = GetQueueDiscClass(i)->GetQueueDisc()->Dequeue()))
+        bands &= ~(1U << band);
+        Ptr<QueueDiscItem> item = m_bands[band]->Dequeue();
+        if (!m_bands[band]->GetNPackets())
         {
-            // NS_LOG_INFO("Popped from band " << i << ": " << item);
-            NS_LOG_LOGIC("Number packets band "
-                         << i << ": " << GetQueueDiscClass(i)->GetQueueDisc()->GetNPackets());
-            NS_LOG_INFO(Simulator::Now().GetSeconds() << " PRIO Dequeue: Number packets band " << i << ": " <<  GetQueueDiscClass(i)->GetQueueDisc()->GetNPackets());
-            return item;
+            m_nonEmpty &= ~(1U << band);
+        }
+        if (!item)
+        {
+            continue;
+        }
+
+        if ((m_capped & (1U << band)) && m_caps[band].tokens > 0)
+        {
+            m_caps[band].tokens -= item->GetSize();
         }
+        RecordClassSojourn(band, item);
+
+        NS_LOG_LOGIC("Popped from band " << band << ": " << item);
+        NS_LOG_LOGIC("Number packets band " << band << ": " << m_bands[band]->GetNPackets());
+        return item;
     }
-   
+
     NS_LOG_LOGIC("Queue empty");
-    return item;
+    return nullptr;
 }
 
 Ptr<const QueueDiscItem>
-PrioQueueDscpDisc::DoPeek()
+PrioQueueDscpDisc::PeekFrom(uint32_t bands)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << bands);
 
-    Ptr<const QueueDiscItem> item;
-
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    for (uint32_t band = SelectBand(bands); band != MAX_BANDS; band = SelectBand(bands))
     {
-        if ((item = GetQueueDiscClass(i)->GetQueueDisc()->Peek()))
+        bands &= ~(1U << band);
+        Ptr<const QueueDiscItem> item = m_bands[band]->Peek();
+        if (item)
         {
-            NS_LOG_LOGIC("Peeked from band " << i << ": " << item);
-            NS_LOG_LOGIC("Number packets band "
-                         << i << ": " << GetQueueDiscClass(i)->GetQueueDisc()->GetNPackets());
+            NS_LOG_LOGIC("Peeked from band " << band << ": " << item);
             return item;
         }
     }
 
     NS_LOG_LOGIC("Queue empty");
-    return item;
+    return nullptr;
 }
 
 bool
@@ -157,12 +237,23 @@ PrioQueueDscpDisc::CheckConfig()
         return false;
     }
 
+    uint32_t nBands = std::max<uint32_t>(2, m_defaultBand + 1);
+    for (const auto& [dscp, band] : m_dscpMap)
+    {
+        if (dscp < 0 || dscp > 63 || band < 0 || band >= static_cast<int>(MAX_BANDS))
+        {
+            NS_LOG_ERROR("Invalid DSCP to band mapping " << dscp << " " << band);
+            return false;
+        }
+        nBands = std::max<uint32_t>(nBands, band + 1);
+    }
+
     if (GetNQueueDiscClasses() == 0)
     {
-        // create 3 fifo queue discs
+        // create one fifo queue disc per band
         ObjectFactory factory;
         factory.SetTypeId("ns3::FifoQueueDisc");
-        for (uint8_t i = 0; i < 2; i++)
+        for (uint32_t i = 0; i < nBands; i++)
         {
             Ptr<QueueDisc> qd = factory.Create<QueueDisc>();
             qd->Initialize();
@@ -172,12 +263,31 @@ PrioQueueDscpDisc::CheckConfig()
         }
     }
 
-    if (GetNQueueDiscClasses() < 2)
+    if (GetNQueueDiscClasses() < 2 || GetNQueueDiscClasses() > MAX_BANDS)
+    {
+        NS_LOG_ERROR("PrioQueueDscpDisc needs between 2 and " << MAX_BANDS << " classes");
+        return false;
+    }
+
+    if (nBands > GetNQueueDiscClasses())
+    {
+        NS_LOG_ERROR("A DSCP is mapped to band " << nBands - 1 << " but there are only "
+                                                 << GetNQueueDiscClasses() << " classes");
+        return false;
+    }
+
+    if (m_rateCap.size() > GetNQueueDiscClasses())
     {
-        NS_LOG_ERROR("PrioQueueDscpDisc needs at least 2 classes");
+        NS_LOG_ERROR("More rate caps than classes");
         return false;
     }
 
+    m_dscpToBand.fill(m_defaultBand);
+    for (const auto& [dscp, band] : m_dscpMap)
+    {
+        m_dscpToBand[dscp] = band;
+    }
+
     return true;
 }
 
@@ -185,6 +295,19 @@ void
 PrioQueueDscpDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
+
+    m_nonEmpty = 0;
+    m_capped = 0;
+    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    {
+        m_bands[i] = PeekPointer(GetQueueDiscClass(i)->GetQueueDisc());
+        m_caps[i] = {DataRate(0), double(m_capBurst), Simulator::Now()};
+        if (i < m_rateCap.size() && m_rateCap[i].GetBitRate() > 0)
+        {
+            m_caps[i].rate = m_rateCap[i];
+            m_capped |= 1U << i;
+        }
+    }
 }
 
 } // namespace ns3
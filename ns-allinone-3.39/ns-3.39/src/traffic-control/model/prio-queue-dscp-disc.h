@@ -20,6 +20,10 @@
 #ifndef PRIO_QUEUE_DSCP_DISC_H
 #define PRIO_QUEUE_DSCP_DISC_H
 
+#include "classful-scheduler-queue-disc.h"
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
 #include "ns3/queue-disc.h"
 
 #include <array>
@@ -33,20 +37,21 @@ typedef std::array<uint16_t, 16> Priomap;
 /**
  * \ingroup traffic-control
  *
- * The Prio qdisc is a simple classful queueing discipline that contains an
- * arbitrary number of classes of differing priority. The classes are dequeued
- * in numerical descending order of priority. By default, three Fifo queue
- * discs are created, unless the user provides (at least two) child queue
+ * The PrioQueueDscp qdisc is a strict priority queueing discipline with up
+ * to 8 bands, band 0 being the highest priority. Packets are assigned a band
+ * through a DSCP table compiled from the MapQueue attribute; DSCPs that are
+ * not listed go to DefaultBand. By default (EF to band 0, the rest to band 1)
+ * two Fifo queue discs are created, unless the user provides child queue
  * discs.
  *
- * If no packet filter is installed or able to classify a packet, then the
- * packet is assigned a priority band based on its priority (modulo 16), which
- * is used as an index into an array called priomap. If a packet is classified
- * by a packet filter and the returned value is non-negative and less than the
- * number of priority bands, then the packet is assigned the priority band
- * corresponding to the value returned by the packet filter. Otherwise, the
- * packet is assigned the priority band specified by the first element of the
- * priomap array.
+ * The queue disc keeps a bitmap of the nonempty bands, updated on enqueue
+ * and dequeue, so that the highest priority band is found with a single
+ * count-trailing-zeros and empty bands cost nothing on dequeue.
+ *
+ * As a starvation guard, a band can be given a rate cap (RateCap). A band
+ * that exceeds its cap loses its priority: it is only served when no band
+ * within its cap has packets, and the packets it sends then are not charged.
+ * The queue disc therefore stays work conserving.
  */
 class PrioQueueDscpDisc : public QueueDisc
 {
@@ -64,31 +69,82 @@ class PrioQueueDscpDisc : public QueueDisc
     ~PrioQueueDscpDisc() override;
 
     /**
-     * Set the band (class) assigned to packets with specified priority.
+     * Set the band (class) assigned to packets with the specified DSCP.
      *
-     * \param prio the priority of packets (a value between 0 and 15).
+     * \param dscp the DSCP of packets (a value between 0 and 63).
      * \param band the band assigned to packets.
      */
-    void SetBandForPriority(uint8_t prio, uint16_t band);
+    void SetBandForDscp(uint8_t dscp, uint8_t band);
 
     /**
-     * Get the band (class) assigned to packets with specified priority.
+     * Get the band (class) assigned to packets with the specified DSCP.
      *
-     * \param prio the priority of packets (a value between 0 and 15).
+     * \param dscp the DSCP of packets (a value between 0 and 63).
      * \returns the band assigned to packets.
      */
-    uint16_t GetBandForPriority(uint8_t prio) const;
+    uint8_t GetBandForDscp(uint8_t dscp) const;
 
-  private:
+    /// The maximum number of bands
+    static constexpr uint32_t MAX_BANDS = 8;
+
+  protected:
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
-    Ptr<QueueDiscItem> DoDequeue() override;
-    Ptr<const QueueDiscItem> DoPeek() override;
     bool CheckConfig() override;
     void InitializeParams() override;
 
-    
-};
+    /**
+     * \brief Dequeue from the highest priority band among the given ones
+     * \param bands bitmap of the candidate bands
+     * \return the item, or nullptr if no candidate band has a packet to send
+     */
+    Ptr<QueueDiscItem> DequeueFrom(uint32_t bands);
 
+    /**
+     * \brief Peek the item DequeueFrom would return
+     * \param bands bitmap of the candidate bands
+     * \return the item, or nullptr if no candidate band has a packet to send
+     */
+    Ptr<const QueueDiscItem> PeekFrom(uint32_t bands);
+
+    std::array<QueueDisc*, MAX_BANDS> m_bands; //!< the child queue disc of each band
+    uint32_t m_nonEmpty;                       //!< bitmap of the nonempty bands
+
+  private:
+    Ptr<QueueDiscItem> DoDequeue() override;
+    Ptr<const QueueDiscItem> DoPeek() override;
+
+    /**
+     * \brief Rate cap of a band
+     */
+    struct BandCap
+    {
+        DataRate rate;   //!< the rate, 0 if the band is not capped
+        double tokens;   //!< the bucket content, in bytes
+        Time lastRefill; //!< the last time tokens were added
+    };
+
+    /**
+     * \brief Refill the bucket of a band and check whether it is within its cap
+     * \param band the band
+     * \return true if the band is not capped or within its cap
+     */
+    bool WithinCap(uint32_t band);
+
+    /**
+     * \brief Find the band to serve among the given ones
+     * \param bands bitmap of the candidate bands
+     * \return the band, or MAX_BANDS if there is no candidate
+     */
+    uint32_t SelectBand(uint32_t bands);
+
+    MapQueue m_dscpMap;                    //!< the MapQueue attribute
+    uint32_t m_defaultBand;                //!< the band of the unlisted DSCPs
+    RateList m_rateCap;                    //!< the RateCap attribute
+    uint32_t m_capBurst;                   //!< the bucket size of the rate caps
+    std::array<uint8_t, 64> m_dscpToBand;  //!< the band of each DSCP
+    std::array<BandCap, MAX_BANDS> m_caps; //!< the rate cap of each band
+    uint32_t m_capped;                     //!< bitmap of the capped bands
+};
 
 } // namespace ns3
 
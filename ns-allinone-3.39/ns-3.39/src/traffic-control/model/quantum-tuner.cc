@@ -0,0 +1,292 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quantum-tuner.h"
+
+#include "ns3/double.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("QuantumTuner");
+
+NS_OBJECT_ENSURE_REGISTERED(QuantumTuner);
+
+TypeId
+QuantumTuner::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::QuantumTuner")
+            .SetParent<Object>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<QuantumTuner>()
+            .AddAttribute("Interval",
+                          "The interval between two updates of the quanta",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&QuantumTuner::m_interval),
+                          MakeTimeChecker(TimeStep(1)))
+            .AddAttribute("TargetShares",
+                          "The target share of the served bytes of each band. "
+                          "A band with a null (or no) share is not tuned for its share",
+                          ShareListValue(ShareList{}),
+                          MakeShareListAccessor(&QuantumTuner::m_targetShares),
+                          MakeShareListChecker())
+            .AddAttribute("DelayBudgets",
+                          "The target mean sojourn time of each band. A band with a null "
+                          "(or no) budget is tuned for its share, if it has one",
+                          TimeListValue(TimeList{}),
+                          MakeTimeListAccessor(&QuantumTuner::m_delayBudgets),
+                          MakeTimeListChecker())
+            .AddAttribute("MinQuantum",
+                          "The smallest quantum set on a band",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&QuantumTuner::m_minQuantum),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxQuantum",
+                          "The largest quantum set on a band",
+                          UintegerValue(1000000),
+                          MakeUintegerAccessor(&QuantumTuner::m_maxQuantum),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Gain",
+                          "The exponent of the correction applied at each update "
+                          "(1 to correct the whole error at once)",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&QuantumTuner::m_gain),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("Tolerance",
+                          "The largest relative change of the quantum of a stable band",
+                          DoubleValue(0.02),
+                          MakeDoubleAccessor(&QuantumTuner::m_tolerance),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("StableIntervals",
+                          "The number of consecutive stable intervals after which the "
+                          "quanta have converged",
+                          UintegerValue(5),
+                          MakeUintegerAccessor(&QuantumTuner::m_stableIntervals),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddTraceSource("Converged",
+                            "The quanta have converged",
+                            MakeTraceSourceAccessor(&QuantumTuner::m_convergedTrace),
+                            "ns3::QuantumTuner::ConvergedTracedCallback");
+    return tid;
+}
+
+QuantumTuner::QuantumTuner()
+    : m_nStable(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+QuantumTuner::~QuantumTuner()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+QuantumTuner::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_event.Cancel();
+    m_setQuantum = MakeNullCallback<void, uint32_t, uint32_t>();
+    Object::DoDispose();
+}
+
+void
+QuantumTuner::Start(const std::vector<int>& quantum, SetQuantumCallback setQuantum)
+{
+    NS_LOG_FUNCTION(this);
+
+    m_bands.assign(quantum.size(), Band());
+    for (uint32_t i = 0; i < quantum.size(); i++)
+    {
+        m_bands[i].quantum = quantum[i];
+        m_bands[i].applied = quantum[i];
+    }
+    m_setQuantum = setQuantum;
+    m_nStable = 0;
+    m_event.Cancel();
+    m_event = Simulator::Schedule(m_interval, &QuantumTuner::Update, this);
+}
+
+void
+QuantumTuner::Served(uint32_t index, uint32_t size, Time sojourn, bool backlogged)
+{
+    Band& band = m_bands[index];
+    band.bytes += size;
+    band.packets++;
+    band.backlogged += backlogged;
+    band.sojourn += sojourn;
+}
+
+bool
+QuantumTuner::IsConverged() const
+{
+    return m_nStable >= m_stableIntervals;
+}
+
+uint32_t
+QuantumTuner::GetQuantum(uint32_t index) const
+{
+    return m_bands[index].applied;
+}
+
+void
+QuantumTuner::Update()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Share of the bands tuned for their share, among the saturated ones
+    double targetSum = 0;
+    double bytesSum = 0;
+    double quantumSum = 0;
+    std::vector<bool> shareTuned(m_bands.size(), false);
+    for (uint32_t i = 0; i < m_bands.size(); i++)
+    {
+        const Band& band = m_bands[i];
+        bool hasBudget = i < m_delayBudgets.size() && m_delayBudgets[i].IsStrictlyPositive();
+        bool hasShare = i < m_targetShares.size() && m_targetShares[i] > 0;
+        if (!hasBudget && hasShare && band.packets > 0 && 2 * band.backlogged >= band.packets)
+        {
+            shareTuned[i] = true;
+            targetSum += m_targetShares[i];
+            bytesSum += band.bytes;
+            quantumSum += band.quantum;
+        }
+    }
+
+    std::vector<double> next(m_bands.size());
+    for (uint32_t i = 0; i < m_bands.size(); i++)
+    {
+        const Band& band = m_bands[i];
+        double ratio = 1;
+        if (shareTuned[i])
+        {
+            ratio = (m_targetShares[i] / targetSum) / (band.bytes / bytesSum);
+        }
+        else if (i < m_delayBudgets.size() && m_delayBudgets[i].IsStrictlyPositive() &&
+                 band.packets > 0)
+        {
+            double late =
+                band.sojourn.GetSeconds() / band.packets / m_delayBudgets[i].GetSeconds();
+            // an early band only gives up its quantum if it is backlogged
+            if (late > 1 || 2 * band.backlogged >= band.packets)
+            {
+                ratio = late;
+            }
+        }
+        next[i] = band.quantum * std::clamp(std::pow(ratio, m_gain), 0.5, 2.0);
+    }
+
+    // Scale the bands tuned for their share back to the same round length
+    double nextSum = 0;
+    for (uint32_t i = 0; i < m_bands.size(); i++)
+    {
+        nextSum += shareTuned[i] ? next[i] : 0;
+    }
+    for (uint32_t i = 0; i < m_bands.size(); i++)
+    {
+        if (shareTuned[i])
+        {
+            next[i] *= quantumSum / nextSum;
+        }
+    }
+
+    double maxChange = 0;
+    for (uint32_t i = 0; i < m_bands.size(); i++)
+    {
+        Band& band = m_bands[i];
+        next[i] = std::clamp(next[i], double(m_minQuantum), double(m_maxQuantum));
+        maxChange = std::max(maxChange, std::abs(next[i] - band.quantum) / band.quantum);
+        band.quantum = next[i];
+
+        auto applied = static_cast<uint32_t>(std::lround(band.quantum));
+        if (applied != band.applied)
+        {
+            NS_LOG_DEBUG("Band " << i << " quantum " << band.applied << " -> " << applied);
+            band.applied = applied;
+            m_setQuantum(i, applied);
+        }
+    }
+
+    // an idle interval tells nothing about the quanta
+    bool idle = std::all_of(m_bands.begin(), m_bands.end(), [](const Band& band) {
+        return band.packets == 0;
+    });
+    if (!idle)
+    {
+        m_nStable = maxChange <= m_tolerance ? m_nStable + 1 : 0;
+    }
+    if (!idle && m_nStable == m_stableIntervals)
+    {
+        std::vector<uint32_t> quanta;
+        std::ostringstream oss;
+        for (uint32_t i = 0; i < m_bands.size(); i++)
+        {
+            const Band& band = m_bands[i];
+            quanta.push_back(band.applied);
+            oss << " [band " << i << ": quantum " << band.applied << ", share "
+                << (bytesSum > 0 && shareTuned[i] ? band.bytes / bytesSum : 0) << ", avg size "
+                << (band.packets ? band.bytes / band.packets : 0) << "]";
+        }
+        NS_LOG_INFO("Quanta converged at " << Simulator::Now().As(Time::S) << ":" << oss.str());
+        m_convergedTrace(quanta);
+    }
+
+    for (auto& band : m_bands)
+    {
+        band.bytes = 0;
+        band.packets = 0;
+        band.backlogged = 0;
+        band.sojourn = Time(0);
+    }
+    m_event = Simulator::Schedule(m_interval, &QuantumTuner::Update, this);
+}
+
+ATTRIBUTE_HELPER_CPP(ShareList);
+
+std::ostream&
+operator<<(std::ostream& os, const ShareList& shares)
+{
+    for (auto it = shares.begin(); it != shares.end(); ++it)
+    {
+        os << (it == shares.begin() ? "" : " ") << *it;
+    }
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, ShareList& shares)
+{
+    double share;
+    while (!(is.eof()))
+    {
+        if (!(is >> share))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        shares.push_back(share);
+    }
+    return is;
+}
+
+} // namespace ns3
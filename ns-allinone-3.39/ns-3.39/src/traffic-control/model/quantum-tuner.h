@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUANTUM_TUNER_H
+#define QUANTUM_TUNER_H
+
+#include "band-attributes.h"
+
+#include "ns3/attribute-helper.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/traced-callback.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+/// Target share of the link of each band
+typedef std::vector<double> ShareList;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Closed-loop controller of the quantum of the bands of a WRR or WDRR queue disc
+ *
+ * The tuner is attached to a queue disc through its Tuner attribute. The
+ * queue disc reports every dequeued packet and, at every Interval, the tuner
+ * compares the share of the served bytes of each band with its target share
+ * (TargetShares) or the mean sojourn time of the band with its delay budget
+ * (DelayBudgets, which take precedence) and updates the quantum of the band:
+ *
+ * - a band with a target share gets its quantum multiplied by
+ *   (target / measured share) ^ Gain. Since the share of a saturated band
+ *   grows with its quantum times its average packet size (WRR) or with its
+ *   quantum (WDRR), a unit Gain jumps to the weights computed offline from the
+ *   average packet sizes, and a lower Gain damps the noise of the
+ *   measurements. Only the bands which were backlogged after most of their
+ *   dequeues are compared, as the share of the others is limited by their
+ *   traffic, and their quanta are scaled so that their sum (i.e., the length
+ *   of a round) is preserved;
+ * - a band with a delay budget gets its quantum multiplied by
+ *   (mean sojourn / budget) ^ Gain, which increases the quantum of a late band
+ *   and, if the band is backlogged, decreases the quantum of an early one.
+ *
+ * A step changes a quantum by a factor of 2 at most and the quanta are kept
+ * within [MinQuantum, MaxQuantum]. When no quantum has changed by more than
+ * Tolerance for StableIntervals intervals, the tuner logs the converged
+ * quanta, along with the measured shares and average packet sizes, and fires
+ * the Converged trace. It keeps tuning afterwards, so it follows changes of
+ * the traffic mix.
+ */
+class QuantumTuner : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    QuantumTuner();
+    ~QuantumTuner() override;
+
+    /// Callback to set the quantum of a band
+    typedef Callback<void, uint32_t, uint32_t> SetQuantumCallback;
+
+    /**
+     * \brief Start tuning the quanta of a queue disc
+     * \param quantum the initial quantum of each band
+     * \param setQuantum the callback to set the quantum of a band
+     */
+    void Start(const std::vector<int>& quantum, SetQuantumCallback setQuantum);
+
+    /**
+     * \brief Account for a dequeued packet
+     * \param index the band of the packet
+     * \param size the size of the packet
+     * \param sojourn the sojourn time of the packet
+     * \param backlogged whether the band still has packets
+     */
+    void Served(uint32_t index, uint32_t size, Time sojourn, bool backlogged);
+
+    /**
+     * \brief Check whether the quanta have converged
+     * \return true if no quantum has changed by more than Tolerance recently
+     */
+    bool IsConverged() const;
+
+    /**
+     * \brief Get the quantum currently set on a band
+     * \param index the band
+     * \return the quantum
+     */
+    uint32_t GetQuantum(uint32_t index) const;
+
+    /**
+     * TracedCallback signature for converged quanta.
+     *
+     * \param [in] quanta The quantum of each band.
+     */
+    typedef void (*ConvergedTracedCallback)(const std::vector<uint32_t>& quanta);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Measurements and state of a band
+    struct Band
+    {
+        double quantum;      //!< the quantum, before rounding
+        uint32_t applied;    //!< the quantum set on the queue disc
+        uint64_t bytes;      //!< bytes served in the interval
+        uint32_t packets;    //!< packets served in the interval
+        uint32_t backlogged; //!< packets after which the band was still backlogged
+        Time sojourn;        //!< total sojourn time of the packets served in the interval
+    };
+
+    /// Update the quanta from the measurements of the last interval
+    void Update();
+
+    Time m_interval;                 //!< the control interval
+    ShareList m_targetShares;        //!< the target share of each band
+    TimeList m_delayBudgets;         //!< the delay budget of each band
+    uint32_t m_minQuantum;           //!< the smallest quantum
+    uint32_t m_maxQuantum;           //!< the largest quantum
+    double m_gain;                   //!< the exponent of the correction
+    double m_tolerance;              //!< the relative change of a stable quantum
+    uint32_t m_stableIntervals;      //!< the stable intervals to converge
+    std::vector<Band> m_bands;       //!< the state of the bands
+    SetQuantumCallback m_setQuantum; //!< the callback to set a quantum
+    uint32_t m_nStable;              //!< the consecutive stable intervals
+    EventId m_event;                 //!< the next update
+
+    /// Traced callback: fired when the quanta have converged
+    TracedCallback<const std::vector<uint32_t>&> m_convergedTrace;
+};
+
+/**
+ * Serialize the shares to the given ostream
+ *
+ * \param os
+ * \param shares
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const ShareList& shares);
+
+/**
+ * Serialize from the given istream to these shares.
+ *
+ * \param is
+ * \param shares
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, ShareList& shares);
+
+ATTRIBUTE_HELPER_HEADER(ShareList);
+
+} // namespace ns3
+
+#endif /* QUANTUM_TUNER_H */
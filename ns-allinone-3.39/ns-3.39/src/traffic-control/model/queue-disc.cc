@@ -19,6 +19,7 @@
 #include "queue-disc.h"
 
 #include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/object-vector.h"
@@ -29,11 +30,106 @@
 #include "ns3/socket.h"
 #include "ns3/uinteger.h"
 
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("QueueDisc");
 
+namespace
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * The table of the interned drop and mark reasons, shared by all the queue discs
+ */
+struct ReasonTable
+{
+    /// Marker of a reason not interned yet
+    static constexpr QueueDisc::ReasonId NONE = std::numeric_limits<QueueDisc::ReasonId>::max();
+
+    std::deque<std::string> names;                                //!< the reasons, by identifier
+    std::unordered_map<std::string, QueueDisc::ReasonId> ids;     //!< the identifier of each reason
+    std::unordered_map<const char*, QueueDisc::ReasonId> byAddr;  //!< the last identifier of each address
+    std::vector<QueueDisc::ReasonId> childDrop; //!< the reason of a drop by a child queue disc
+    std::vector<QueueDisc::ReasonId> childMark; //!< the reason of a mark by a child queue disc
+
+    /**
+     * \brief Intern a reason
+     * \param reason the reason
+     * \return the identifier of the reason
+     */
+    QueueDisc::ReasonId Intern(const std::string& reason)
+    {
+        auto [it, inserted] = ids.try_emplace(reason, names.size());
+        if (inserted)
+        {
+            NS_ABORT_MSG_IF(names.size() >= NONE, "Too many drop and mark reasons");
+            names.push_back(reason);
+            childDrop.push_back(NONE);
+            childMark.push_back(NONE);
+            // the interned copy is itself a valid address of the reason
+            byAddr[names.back().c_str()] = it->second;
+        }
+        return it->second;
+    }
+
+    /**
+     * \brief Get the reason of a drop or mark notified by a child queue disc
+     * \param id the identifier of the reason given by the child queue disc
+     * \param mark true for a mark, false for a drop
+     * \return the identifier of the reason
+     */
+    QueueDisc::ReasonId Child(QueueDisc::ReasonId id, bool mark)
+    {
+        QueueDisc::ReasonId& child = (mark ? childMark : childDrop)[id];
+        if (child == NONE)
+        {
+            // Intern may grow the vectors, do not keep the reference across it
+            QueueDisc::ReasonId newId =
+                Intern((mark ? QueueDisc::CHILD_QUEUE_DISC_MARK : QueueDisc::CHILD_QUEUE_DISC_DROP) +
+                       names[id]);
+            (mark ? childMark : childDrop)[id] = newId;
+            return newId;
+        }
+        return child;
+    }
+};
+
+/**
+ * \brief Get the table of the interned reasons
+ * \return the table of the interned reasons
+ */
+ReasonTable&
+GetReasonTable()
+{
+    static ReasonTable table;
+    return table;
+}
+
+/**
+ * \brief Get the counters of a reason, creating them if needed
+ * \param counters the counters of the reasons
+ * \param id the identifier of the reason
+ * \return the counters of the reason
+ */
+QueueDisc::Stats::ReasonCounters&
+GetCounters(std::vector<QueueDisc::Stats::ReasonCounters>& counters, QueueDisc::ReasonId id)
+{
+    if (id >= counters.size())
+    {
+        counters.resize(id + 1);
+    }
+    return counters[id];
+}
+
+} // namespace
+
 NS_OBJECT_ENSURE_REGISTERED(QueueDiscClass);
 
 TypeId
@@ -102,11 +198,18 @@ QueueDisc::Stats::Stats()
       nTotalDroppedBytesAfterDequeue(0),
       nTotalRequeuedPackets(0),
       nTotalRequeuedBytes(0),
+      nTotalBypassedPackets(0),
       nTotalMarkedPackets(0),
       nTotalMarkedBytes(0)
 {
 }
 
+QueueDisc::Stats::ReasonCounters
+QueueDisc::Stats::GetReasonCounters(ReasonId id) const
+{
+    return id < reasonCounters.size() ? reasonCounters[id] : ReasonCounters();
+}
+
 uint32_t
 QueueDisc::Stats::GetNDroppedPackets(std::string reason) const
 {
@@ -190,6 +293,7 @@ QueueDisc::Stats::Print(std::ostream& os) const
        << std::endl
        << "Packets/Bytes requeued: " << nTotalRequeuedPackets << " / " << nTotalRequeuedBytes
        << std::endl
+       << "Packets bypassed: " << nTotalBypassedPackets << std::endl
        << "Packets/Bytes dropped: " << nTotalDroppedPackets << " / " << nTotalDroppedBytes
        << std::endl
        << "Packets/Bytes dropped before enqueue: " << nTotalDroppedPacketsBeforeEnqueue << " / "
@@ -236,6 +340,14 @@ QueueDisc::Stats::Print(std::ostream& os) const
         itb++;
     }
 
+    for (uint32_t i = 0; i < classSojourn.size(); i++)
+    {
+        if (classSojourn[i].GetCount())
+        {
+            os << std::endl << "Sojourn time class " << i << ": " << classSojourn[i];
+        }
+    }
+
     os << std::endl;
 }
 
@@ -260,6 +372,12 @@ QueueDisc::GetTypeId()
                           UintegerValue(DEFAULT_QUOTA),
                           MakeUintegerAccessor(&QueueDisc::SetQuota, &QueueDisc::GetQuota),
                           MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Bypass",
+                          "Whether packets are sent directly to the device when the queue disc "
+                          "is empty, if the queue disc supports it",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&QueueDisc::m_bypass),
+                          MakeBooleanChecker())
             .AddAttribute("InternalQueueList",
                           "The list of internal queues.",
                           ObjectVectorValue(),
@@ -322,7 +440,9 @@ QueueDisc::QueueDisc(QueueDiscSizePolicy policy)
     : m_nPackets(0),
       m_nBytes(0),
       m_maxSize(QueueSize("1p")), // to avoid that setting the mode at construction time is ignored
+      m_bypass(false),
       m_running(false),
+      m_parent(nullptr),
       m_peeked(false),
       m_sizePolicy(policy),
       m_prohibitChangeMode(false)
@@ -346,20 +466,16 @@ QueueDisc::QueueDisc(QueueDiscSizePolicy policy)
     // is connected to the DropBeforeEnqueue and DropAfterDequeue traces of the
     // child queue discs, the concatenation of the CHILD_QUEUE_DISC_DROP constant
     // and the second argument provided by such traces is passed as the reason why
-    // the packet is dropped.
+    // the packet is dropped. The concatenation is interned once per reason.
     m_childQueueDiscDbeFunctor = [this](Ptr<const QueueDiscItem> item, const char* r) {
-        return DropBeforeEnqueue(
-            item,
-            m_childQueueDiscDropMsg.assign(CHILD_QUEUE_DISC_DROP).append(r).data());
+        return DropBeforeEnqueue(item, GetReasonTable().Child(GetReasonId(r), false));
     };
     m_childQueueDiscDadFunctor = [this](Ptr<const QueueDiscItem> item, const char* r) {
-        return DropAfterDequeue(
-            item,
-            m_childQueueDiscDropMsg.assign(CHILD_QUEUE_DISC_DROP).append(r).data());
+        return DropAfterDequeue(item, GetReasonTable().Child(GetReasonId(r), false));
     };
     m_childQueueDiscMarkFunctor = [this](Ptr<const QueueDiscItem> item, const char* r) {
         return Mark(const_cast<QueueDiscItem*>(PeekPointer(item)),
-                    m_childQueueDiscMarkMsg.assign(CHILD_QUEUE_DISC_MARK).append(r).data());
+                    GetReasonTable().Child(GetReasonId(r), true));
     };
 }
 
@@ -381,7 +497,15 @@ QueueDisc::DoDispose()
     NS_LOG_FUNCTION(this);
     m_queues.clear();
     m_filters.clear();
+    for (auto& qdClass : m_classes)
+    {
+        if (qdClass->GetQueueDisc())
+        {
+            qdClass->GetQueueDisc()->m_parent = nullptr;
+        }
+    }
     m_classes.clear();
+    m_parent = nullptr;
     m_devQueueIface = nullptr;
     m_send = nullptr;
     m_requeued = nullptr;
@@ -412,6 +536,32 @@ QueueDisc::DoInitialize()
     Object::DoInitialize();
 }
 
+QueueDisc::ReasonId
+QueueDisc::GetReasonId(const char* reason)
+{
+    ReasonTable& table = GetReasonTable();
+    // reasons are usually string constants, which are looked up by address; the
+    // content is checked in case the address was reused for another string
+    auto it = table.byAddr.find(reason);
+    if (it != table.byAddr.end() &&
+        (table.names[it->second].c_str() == reason ||
+         std::strcmp(table.names[it->second].c_str(), reason) == 0))
+    {
+        return it->second;
+    }
+    ReasonId id = table.Intern(reason);
+    table.byAddr[reason] = id;
+    return id;
+}
+
+const char*
+QueueDisc::GetReasonName(ReasonId id)
+{
+    ReasonTable& table = GetReasonTable();
+    NS_ASSERT_MSG(id < table.names.size(), "Unknown reason " << id);
+    return table.names[id].c_str();
+}
+
 const QueueDisc::Stats&
 QueueDisc::GetStats()
 {
@@ -429,6 +579,35 @@ QueueDisc::GetStats()
                               (m_requeued ? m_requeued->GetSize() : 0) -
                               m_stats.nTotalDroppedBytesAfterDequeue;
 
+    // the string keyed maps are only built here, from the counters of the
+    // interned reasons
+    m_stats.nDroppedPacketsBeforeEnqueue.clear();
+    m_stats.nDroppedBytesBeforeEnqueue.clear();
+    m_stats.nDroppedPacketsAfterDequeue.clear();
+    m_stats.nDroppedBytesAfterDequeue.clear();
+    m_stats.nMarkedPackets.clear();
+    m_stats.nMarkedBytes.clear();
+    for (ReasonId id = 0; id < m_stats.reasonCounters.size(); id++)
+    {
+        const Stats::ReasonCounters& counters = m_stats.reasonCounters[id];
+        const char* reason = GetReasonName(id);
+        if (counters.nDroppedPacketsBeforeEnqueue)
+        {
+            m_stats.nDroppedPacketsBeforeEnqueue[reason] = counters.nDroppedPacketsBeforeEnqueue;
+            m_stats.nDroppedBytesBeforeEnqueue[reason] = counters.nDroppedBytesBeforeEnqueue;
+        }
+        if (counters.nDroppedPacketsAfterDequeue)
+        {
+            m_stats.nDroppedPacketsAfterDequeue[reason] = counters.nDroppedPacketsAfterDequeue;
+            m_stats.nDroppedBytesAfterDequeue[reason] = counters.nDroppedBytesAfterDequeue;
+        }
+        if (counters.nMarkedPackets)
+        {
+            m_stats.nMarkedPackets[reason] = counters.nMarkedPackets;
+            m_stats.nMarkedBytes[reason] = counters.nMarkedBytes;
+        }
+    }
+
     return m_stats;
 }
 
@@ -559,6 +738,18 @@ QueueDisc::GetSendCallback() const
     return m_send;
 }
 
+QueueDisc*
+QueueDisc::GetRootQueueDisc()
+{
+    NS_LOG_FUNCTION(this);
+    QueueDisc* root = this;
+    while (root->m_parent)
+    {
+        root = root->m_parent;
+    }
+    return root;
+}
+
 void
 QueueDisc::SetQuota(const uint32_t quota)
 {
@@ -651,6 +842,7 @@ QueueDisc::AddQueueDiscClass(Ptr<QueueDiscClass> qdClass)
     qdClass->GetQueueDisc()->TraceConnectWithoutContext(
         "Mark",
         MakeCallback(&ChildQueueDiscMarkFunctor::operator(), &m_childQueueDiscMarkFunctor));
+    qdClass->GetQueueDisc()->m_parent = this;
     m_classes.push_back(qdClass);
 }
 
@@ -725,74 +917,52 @@ QueueDisc::PacketDequeued(Ptr<const QueueDiscItem> item)
 void
 QueueDisc::DropBeforeEnqueue(Ptr<const QueueDiscItem> item, const char* reason)
 {
-    NS_LOG_FUNCTION(this << item << reason);
+    DropBeforeEnqueue(item, GetReasonId(reason));
+}
+
+void
+QueueDisc::DropBeforeEnqueue(Ptr<const QueueDiscItem> item, ReasonId reason)
+{
+    NS_LOG_FUNCTION(this << item << GetReasonName(reason));
 
     m_stats.nTotalDroppedPackets++;
     m_stats.nTotalDroppedBytes += item->GetSize();
     m_stats.nTotalDroppedPacketsBeforeEnqueue++;
     m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize();
 
-    // update the number of packets dropped for the given reason
-    std::map<std::string, uint32_t>::iterator itp =
-        m_stats.nDroppedPacketsBeforeEnqueue.find(reason);
-    if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end())
-    {
-        itp->second++;
-    }
-    else
-    {
-        m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-    // update the amount of bytes dropped for the given reason
-    std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find(reason);
-    if (itb != m_stats.nDroppedBytesBeforeEnqueue.end())
-    {
-        itb->second += item->GetSize();
-    }
-    else
-    {
-        m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize();
-    }
+    // update the number of packets and bytes dropped for the given reason
+    Stats::ReasonCounters& counters = GetCounters(m_stats.reasonCounters, reason);
+    counters.nDroppedPacketsBeforeEnqueue++;
+    counters.nDroppedBytesBeforeEnqueue += item->GetSize();
 
     NS_LOG_DEBUG("Total packets/bytes dropped before enqueue: "
                  << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
                  << m_stats.nTotalDroppedBytesBeforeEnqueue);
     NS_LOG_LOGIC("m_traceDropBeforeEnqueue (p)");
     m_traceDrop(item);
-    m_traceDropBeforeEnqueue(item, reason);
+    m_traceDropBeforeEnqueue(item, GetReasonName(reason));
 }
 
 void
 QueueDisc::DropAfterDequeue(Ptr<const QueueDiscItem> item, const char* reason)
 {
-    NS_LOG_FUNCTION(this << item << reason);
+    DropAfterDequeue(item, GetReasonId(reason));
+}
+
+void
+QueueDisc::DropAfterDequeue(Ptr<const QueueDiscItem> item, ReasonId reason)
+{
+    NS_LOG_FUNCTION(this << item << GetReasonName(reason));
 
     m_stats.nTotalDroppedPackets++;
     m_stats.nTotalDroppedBytes += item->GetSize();
     m_stats.nTotalDroppedPacketsAfterDequeue++;
     m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize();
 
-    // update the number of packets dropped for the given reason
-    std::map<std::string, uint32_t>::iterator itp =
-        m_stats.nDroppedPacketsAfterDequeue.find(reason);
-    if (itp != m_stats.nDroppedPacketsAfterDequeue.end())
-    {
-        itp->second++;
-    }
-    else
-    {
-        m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-    // update the amount of bytes dropped for the given reason
-    std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find(reason);
-    if (itb != m_stats.nDroppedBytesAfterDequeue.end())
-    {
-        itb->second += item->GetSize();
-    }
-    else
-    {
-        m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize();
-    }
+    // update the number of packets and bytes dropped for the given reason
+    Stats::ReasonCounters& counters = GetCounters(m_stats.reasonCounters, reason);
+    counters.nDroppedPacketsAfterDequeue++;
+    counters.nDroppedBytesAfterDequeue += item->GetSize();
 
     // if in the context of a peek request a dequeued packet is dropped, we need
     // to update the statistics and fire the dequeue trace before firing the drop
@@ -810,13 +980,19 @@ QueueDisc::DropAfterDequeue(Ptr<const QueueDiscItem> item, const char* reason)
                  << m_stats.nTotalDroppedBytesAfterDequeue);
     NS_LOG_LOGIC("m_traceDropAfterDequeue (p)");
     m_traceDrop(item);
-    m_traceDropAfterDequeue(item, reason);
+    m_traceDropAfterDequeue(item, GetReasonName(reason));
 }
 
 bool
 QueueDisc::Mark(Ptr<QueueDiscItem> item, const char* reason)
 {
-    NS_LOG_FUNCTION(this << item << reason);
+    return Mark(item, GetReasonId(reason));
+}
+
+bool
+QueueDisc::Mark(Ptr<QueueDiscItem> item, ReasonId reason)
+{
+    NS_LOG_FUNCTION(this << item << GetReasonName(reason));
 
     bool retval = item->Mark();
 
@@ -828,33 +1004,29 @@ QueueDisc::Mark(Ptr<QueueDiscItem> item, const char* reason)
     m_stats.nTotalMarkedPackets++;
     m_stats.nTotalMarkedBytes += item->GetSize();
 
-    // update the number of packets marked for the given reason
-    std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find(reason);
-    if (itp != m_stats.nMarkedPackets.end())
-    {
-        itp->second++;
-    }
-    else
-    {
-        m_stats.nMarkedPackets[reason] = 1;
-    }
-    // update the amount of bytes marked for the given reason
-    std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find(reason);
-    if (itb != m_stats.nMarkedBytes.end())
-    {
-        itb->second += item->GetSize();
-    }
-    else
-    {
-        m_stats.nMarkedBytes[reason] = item->GetSize();
-    }
+    // update the number of packets and bytes marked for the given reason
+    Stats::ReasonCounters& counters = GetCounters(m_stats.reasonCounters, reason);
+    counters.nMarkedPackets++;
+    counters.nMarkedBytes += item->GetSize();
 
     NS_LOG_DEBUG("Total packets/bytes marked: " << m_stats.nTotalMarkedPackets << " / "
                                                 << m_stats.nTotalMarkedBytes);
-    m_traceMark(item, reason);
+    m_traceMark(item, GetReasonName(reason));
     return true;
 }
 
+void
+QueueDisc::RecordClassSojourn(uint32_t index, Ptr<const QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << index << item);
+
+    if (index >= m_stats.classSojourn.size())
+    {
+        m_stats.classSojourn.resize(index + 1);
+    }
+    m_stats.classSojourn[index].Record(Simulator::Now() - item->GetTimeStamp());
+}
+
 bool
 QueueDisc::Enqueue(Ptr<QueueDiscItem> item)
 {
@@ -970,6 +1142,43 @@ QueueDisc::Run()
     }
 }
 
+bool
+QueueDisc::Bypass(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+
+    if (!m_bypass || m_nPackets.Get() > 0 || m_requeued || m_running || !m_send ||
+        (m_devQueueIface && m_devQueueIface->GetTxQueue(item->GetTxQueueIndex())->IsStopped()) ||
+        !DoBypass(item))
+    {
+        return false;
+    }
+
+    NS_LOG_LOGIC("Empty queue disc, send the packet directly to the device");
+    m_stats.nTotalReceivedPackets++;
+    m_stats.nTotalReceivedBytes += item->GetSize();
+    m_stats.nTotalBypassedPackets++;
+
+    // the item goes through the queue disc in no time
+    item->SetTimeStamp(Simulator::Now());
+    PacketEnqueued(item);
+    PacketDequeued(item);
+    item->AddHeader();
+
+    // the device queue is not stopped, hence the item is not requeued; as the
+    // queue disc is empty, there is nothing else to send afterwards
+    RunBegin();
+    Transmit(item);
+    RunEnd();
+    return true;
+}
+
+bool
+QueueDisc::DoBypass(Ptr<QueueDiscItem> item)
+{
+    return false;
+}
+
 bool
 QueueDisc::RunBegin()
 {
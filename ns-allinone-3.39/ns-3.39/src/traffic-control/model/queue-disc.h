@@ -20,6 +20,7 @@
 #define QUEUE_DISC_H
 
 #include "packet-filter.h"
+#include "sojourn-histogram.h"
 
 #include "ns3/object.h"
 #include "ns3/queue-fwd.h"
@@ -164,6 +165,13 @@ enum QueueDiscSizePolicy
  * - queued = enqueued - dequeued
  * - sent = dequeued - dropped after dequeue (- 1 if there is a requeued packet)
  *
+ * A queue disc that does no more than storing packets may advertise (by
+ * overriding DoBypass) that an empty instance can hand a packet straight to
+ * the device, as Linux does for the qdiscs flagged TCQ_F_CAN_BYPASS. When the
+ * Bypass attribute is also set, the traffic control layer skips the enqueue
+ * and dequeue of such packets. A bypassed packet is still counted as received,
+ * enqueued, dequeued and sent, and the Enqueue and Dequeue traces are fired.
+ *
  * Separate counters are also kept for each possible reason to drop a packet.
  * When a packet is dropped by an internal queue, e.g., because the queue is full,
  * the reason is "Dropped by internal queue". When a packet is dropped by a child
@@ -183,9 +191,23 @@ enum QueueDiscSizePolicy
 class QueueDisc : public Object
 {
   public:
+    /// Identifier of an interned drop or mark reason
+    typedef uint16_t ReasonId;
+
     /// \brief Structure that keeps the queue disc statistics
     struct Stats
     {
+        /// \brief Counters of a drop or mark reason
+        struct ReasonCounters
+        {
+            uint32_t nDroppedPacketsBeforeEnqueue{0}; //!< Packets dropped before enqueue
+            uint64_t nDroppedBytesBeforeEnqueue{0};   //!< Bytes dropped before enqueue
+            uint32_t nDroppedPacketsAfterDequeue{0};  //!< Packets dropped after dequeue
+            uint64_t nDroppedBytesAfterDequeue{0};    //!< Bytes dropped after dequeue
+            uint32_t nMarkedPackets{0};               //!< Marked packets
+            uint64_t nMarkedBytes{0};                 //!< Marked bytes
+        };
+
         /// Total received packets
         uint32_t nTotalReceivedPackets;
         /// Total received bytes
@@ -206,34 +228,41 @@ class QueueDisc : public Object
         uint32_t nTotalDroppedPackets;
         /// Total packets dropped before enqueue
         uint32_t nTotalDroppedPacketsBeforeEnqueue;
-        /// Packets dropped before enqueue, for each reason
+        /// Packets dropped before enqueue, for each reason -- filled from reasonCounters by GetStats
         std::map<std::string, uint32_t, std::less<>> nDroppedPacketsBeforeEnqueue;
         /// Total packets dropped after dequeue
         uint32_t nTotalDroppedPacketsAfterDequeue;
-        /// Packets dropped after dequeue, for each reason
+        /// Packets dropped after dequeue, for each reason -- filled from reasonCounters by GetStats
         std::map<std::string, uint32_t, std::less<>> nDroppedPacketsAfterDequeue;
         /// Total dropped bytes
         uint64_t nTotalDroppedBytes;
         /// Total bytes dropped before enqueue
         uint64_t nTotalDroppedBytesBeforeEnqueue;
-        /// Bytes dropped before enqueue, for each reason
+        /// Bytes dropped before enqueue, for each reason -- filled from reasonCounters by GetStats
         std::map<std::string, uint64_t, std::less<>> nDroppedBytesBeforeEnqueue;
         /// Total bytes dropped after dequeue
         uint64_t nTotalDroppedBytesAfterDequeue;
-        /// Bytes dropped after dequeue, for each reason
+        /// Bytes dropped after dequeue, for each reason -- filled from reasonCounters by GetStats
         std::map<std::string, uint64_t, std::less<>> nDroppedBytesAfterDequeue;
         /// Total requeued packets
         uint32_t nTotalRequeuedPackets;
         /// Total requeued bytes
         uint64_t nTotalRequeuedBytes;
+        /// Total packets that bypassed the queue disc (also counted as enqueued and dequeued)
+        uint32_t nTotalBypassedPackets;
         /// Total marked packets
         uint32_t nTotalMarkedPackets;
-        /// Marked packets, for each reason
+        /// Marked packets, for each reason -- filled from reasonCounters by GetStats
         std::map<std::string, uint32_t, std::less<>> nMarkedPackets;
         /// Total marked bytes
         uint32_t nTotalMarkedBytes;
-        /// Marked bytes, for each reason
+        /// Marked bytes, for each reason -- filled from reasonCounters by GetStats
         std::map<std::string, uint64_t, std::less<>> nMarkedBytes;
+        /// Drop and mark counters, indexed by ReasonId
+        std::vector<ReasonCounters> reasonCounters;
+        /// Sojourn time of the packets dequeued from each class, recorded by
+        /// the schedulers that call RecordClassSojourn
+        std::vector<SojournHistogram> classSojourn;
 
         /// constructor
         Stats();
@@ -262,6 +291,12 @@ class QueueDisc : public Object
          * \return the amount of bytes marked for the given reason
          */
         uint64_t GetNMarkedBytes(std::string reason) const;
+        /**
+         * \brief Get the counters of the given reason
+         * \param id the identifier of the reason
+         * \return the counters, all zero if the reason was never used
+         */
+        ReasonCounters GetReasonCounters(ReasonId id) const;
         /**
          * \brief Print the statistics.
          * \param os output stream in which the data should be printed.
@@ -343,6 +378,23 @@ class QueueDisc : public Object
      */
     const Stats& GetStats();
 
+    /**
+     * \brief Get the identifier of a drop or mark reason, interning it on first use
+     *
+     * Reasons are interned once per program run in a table shared by all the
+     * queue discs, so that the statistics can be kept in flat arrays.
+     * \param reason the reason
+     * \return the identifier of the reason
+     */
+    static ReasonId GetReasonId(const char* reason);
+
+    /**
+     * \brief Get the reason with the given identifier
+     * \param id the identifier of the reason
+     * \return the reason, which remains valid until the end of the program
+     */
+    static const char* GetReasonName(ReasonId id);
+
     /**
      * \param ndqi the NetDeviceQueueInterface aggregated to the receiving object.
      *
@@ -378,6 +430,16 @@ class QueueDisc : public Object
      */
     SendCallback GetSendCallback() const;
 
+    /**
+     * \return the root of the tree of queue discs this queue disc belongs to.
+     *
+     * A queue disc becomes the child of the queue disc it is added to as a
+     * class (see AddQueueDiscClass). Only the root queue disc sends packets,
+     * hence a child queue disc that has to run again at a later time (e.g.,
+     * to serve a shaped class) runs its root queue disc.
+     */
+    QueueDisc* GetRootQueueDisc();
+
     /**
      * \brief Set the maximum number of dequeue operations following a packet enqueue
      * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -424,6 +486,17 @@ class QueueDisc : public Object
      */
     void Run();
 
+    /**
+     * Modelled after the TCQ_F_CAN_BYPASS branch of the Linux function
+     * __dev_xmit_skb (net/core/dev.c). If bypass is enabled and supported, the
+     * queue disc is empty and not running, and the device queue of the item is
+     * not stopped, send the item to the device without storing it.
+     *
+     * \param item item to send
+     * \return true if the item was sent; false if it must be enqueued instead
+     */
+    bool Bypass(Ptr<QueueDiscItem> item);
+
     /// Internal queues store QueueDiscItem objects
     typedef Queue<QueueDiscItem> InternalQueue;
 
@@ -572,7 +645,71 @@ class QueueDisc : public Object
      */
     bool Mark(Ptr<QueueDiscItem> item, const char* reason);
 
+    /**
+     * \brief Same as DropBeforeEnqueue, with an interned reason
+     * \param item item that was dropped
+     * \param reason the identifier of the reason why the item was dropped
+     */
+    void DropBeforeEnqueue(Ptr<const QueueDiscItem> item, ReasonId reason);
+
+    /**
+     * \brief Same as DropAfterDequeue, with an interned reason
+     * \param item item that was dropped
+     * \param reason the identifier of the reason why the item was dropped
+     */
+    void DropAfterDequeue(Ptr<const QueueDiscItem> item, ReasonId reason);
+
+    /**
+     * \brief Same as Mark, with an interned reason
+     * \param item item that has to be marked
+     * \param reason the identifier of the reason why the item has to be marked
+     * \return true if the item was successfully marked, false otherwise
+     */
+    bool Mark(Ptr<QueueDiscItem> item, ReasonId reason);
+
+    /**
+     * \brief Record the sojourn time of an item dequeued from a class
+     * \param index the index of the class
+     * \param item the dequeued item, whose time stamp was set on enqueue
+     * Schedulers call this method to fill the per class sojourn histograms
+     * of the statistics
+     */
+    void RecordClassSojourn(uint32_t index, Ptr<const QueueDiscItem> item);
+
+    /**
+     * \brief Perform the actions required when the queue disc is notified of
+     *        a packet enqueue
+     * \param item item that was enqueued
+     * Besides being connected to the internal queues and to the child queue
+     * discs, this method is called by subclasses that store packets in their
+     * own containers
+     */
+    void PacketEnqueued(Ptr<const QueueDiscItem> item);
+
+    /**
+     * \brief Perform the actions required when the queue disc is notified of
+     *        a packet dequeue
+     * \param item item that was dequeued
+     * Besides being connected to the internal queues and to the child queue
+     * discs, this method is called by subclasses that store packets in their
+     * own containers
+     */
+    void PacketDequeued(Ptr<const QueueDiscItem> item);
+
   private:
+    /**
+     * \brief Prepare an item that bypasses the empty queue disc
+     *
+     * Queue discs that can send a packet directly to the device when they are
+     * empty override this method to apply the per packet processing they
+     * would do on enqueue (e.g., remarking) and return true. The default
+     * implementation returns false, i.e., bypass is not supported.
+     *
+     * \param item the item about to bypass the queue disc
+     * \return true if the item can bypass the queue disc
+     */
+    virtual bool DoBypass(Ptr<QueueDiscItem> item);
+
     /**
      * This function actually enqueues a packet into the queue disc.
      * \param item item to enqueue
@@ -670,20 +807,6 @@ class QueueDisc : public Object
      */
     bool Transmit(Ptr<QueueDiscItem> item);
 
-    /**
-     * \brief Perform the actions required when the queue disc is notified of
-     *        a packet enqueue
-     * \param item item that was enqueued
-     */
-    void PacketEnqueued(Ptr<const QueueDiscItem> item);
-
-    /**
-     * \brief Perform the actions required when the queue disc is notified of
-     *        a packet dequeue
-     * \param item item that was dequeued
-     */
-    void PacketDequeued(Ptr<const QueueDiscItem> item);
-
     /// Default quota (as in /proc/sys/net/core/dev_weight)
     static const uint32_t DEFAULT_QUOTA = 64;
 
@@ -698,15 +821,15 @@ class QueueDisc : public Object
 
     Stats m_stats;    //!< The collected statistics
     uint32_t m_quota; //!< Maximum number of packets dequeued in a qdisc run
+    bool m_bypass;    //!< Whether packets may bypass the queue disc when it is empty
     Ptr<NetDeviceQueueInterface> m_devQueueIface; //!< NetDevice queue interface
     SendCallback m_send;           //!< Callback used to send a packet to the receiving object
     bool m_running;                //!< The queue disc is performing multiple dequeue operations
+    QueueDisc* m_parent;           //!< The parent queue disc, if any (not owned)
     Ptr<QueueDiscItem> m_requeued; //!< The last packet that failed to be transmitted
     bool m_peeked;                 //!< A packet was dequeued because Peek was called
-    std::string m_childQueueDiscDropMsg; //!< Reason why a packet was dropped by a child queue disc
-    std::string m_childQueueDiscMarkMsg; //!< Reason why a packet was marked by a child queue disc
-    QueueDiscSizePolicy m_sizePolicy;    //!< The queue disc size policy
-    bool m_prohibitChangeMode;           //!< True if changing mode is prohibited
+    QueueDiscSizePolicy m_sizePolicy; //!< The queue disc size policy
+    bool m_prohibitChangeMode;        //!< True if changing mode is prohibited
 
     /// Traced callback: fired when a packet is enqueued
     TracedCallback<Ptr<const QueueDiscItem>> m_traceEnqueue;
@@ -18,15 +18,13 @@
  * Authors:  Stefano Avallone <stavallo@unina.it>
  *           Tom Henderson <tomhend@u.washington.edu>
  */
-#include <stdint.h>
+
 #include "sched-queue-disc.h"
 
 #include "ns3/log.h"
-#include "ns3/object-factory.h"
-#include "ns3/queue.h"
-#include "ns3/socket.h"
-#include "ns3/ipv4-header.h"
-#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -35,82 +33,6 @@ NS_LOG_COMPONENT_DEFINE("SchedQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(SchedQueueDisc);
 
-TypeId
-SchedFlow::GetTypeId()
-{
-    static TypeId tid = TypeId("ns3::FqCoDelFlow")
-                            .SetParent<QueueDiscClass>()
-                            .SetGroupName("TrafficControl")
-                            .AddConstructor<SchedFlow>();
-    return tid;
-}
-
-
-
-
-SchedFlow::SchedFlow()
-    : m_deficit(0),
-      m_status(INACTIVE),
-      m_index(0)
-{
-    NS_LOG_FUNCTION(this);
-}
-
-SchedFlow::~SchedFlow()
-{
-    NS_LOG_FUNCTION(this);
-}
-
-void
-SchedFlow::SetDeficit(uint32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit = deficit;
-}
-
-int32_t
-SchedFlow::GetDeficit() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_deficit;
-}
-
-void
-SchedFlow::IncreaseDeficit(int32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit += deficit;
-}
-
-void
-SchedFlow::SetStatus(FlowStatus status)
-{
-    NS_LOG_FUNCTION(this);
-    m_status = status;
-}
-
-SchedFlow::FlowStatus
-SchedFlow::GetStatus() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_status;
-}
-
-void
-SchedFlow::SetIndex(uint32_t index)
-{
-    NS_LOG_FUNCTION(this);
-    m_index = index;
-}
-
-uint32_t
-SchedFlow::GetIndex() const
-{
-    return m_index;
-}
-
-
-
 TypeId
 SchedQueueDisc::GetTypeId()
 {
@@ -124,29 +46,54 @@ SchedQueueDisc::GetTypeId()
                           QueueSizeValue(QueueSize("1000p")),
                           MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
                           MakeQueueSizeChecker())
+            .AddAttribute("DscpRanges",
+                          "The class of each range of DSCPs (first last class triples, the "
+                          "earlier ranges taking precedence)",
+                          DscpRangeListValue(DscpRangeList{{40, 47, 0}}),
+                          MakeDscpRangeListAccessor(&SchedQueueDisc::m_dscpRanges),
+                          MakeDscpRangeListChecker())
+            .AddAttribute("DefaultClass",
+                          "The class of the DSCPs outside the ranges and of non-IP packets",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&SchedQueueDisc::m_defaultClass),
+                          MakeUintegerChecker<uint32_t>(0, MAX_CLASSES - 1))
+            .AddAttribute("Quantum",
+                          "The number of bytes each flow queue gets to dequeue in a round",
+                          UintegerValue(1514),
+                          MakeUintegerAccessor(&SchedQueueDisc::SetQuantum,
+                                               &SchedQueueDisc::GetQuantum),
+                          MakeUintegerChecker<uint32_t>(1))
             .AddAttribute("Flows",
-                "The number of queues into which the incoming packets are classified",
-                UintegerValue(1024),
-                MakeUintegerAccessor(&SchedQueueDisc::m_flows),
-                MakeUintegerChecker<uint32_t>())
+                          "The number of flow queues of each class",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&SchedQueueDisc::m_flows),
+                          MakeUintegerChecker<uint32_t>(1))
             .AddAttribute("Perturbation",
-                "The salt used as an additional input to the hash function used to "
-                "classify packets",
-                UintegerValue(0),
-                MakeUintegerAccessor(&SchedQueueDisc::m_perturbation),
-                MakeUintegerChecker<uint32_t>())
+                          "The salt used as an additional input to the hash function used to "
+                          "classify packets",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SchedQueueDisc::m_perturbation),
+                          MakeUintegerChecker<uint32_t>())
             .AddAttribute("SetWays",
-                "The size of a set of queues (used by set associative hash)",
-                UintegerValue(8),
-                MakeUintegerAccessor(&SchedQueueDisc::m_setWays),
-                MakeUintegerChecker<uint32_t>());
+                          "The size of a set of flow queues (used by set associative hash)",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&SchedQueueDisc::m_setWays),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("DropBatchSize",
+                          "The maximum number of packets dropped from the fat flow",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&SchedQueueDisc::m_dropBatchSize),
+                          MakeUintegerChecker<uint32_t>(1));
     return tid;
 }
 
 SchedQueueDisc::SchedQueueDisc()
-    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS)
+    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+      m_quantum(0),
+      m_nonEmpty(0)
 {
     NS_LOG_FUNCTION(this);
+    m_dscpToClass.fill(0);
 }
 
 SchedQueueDisc::~SchedQueueDisc()
@@ -168,110 +115,99 @@ SchedQueueDisc::GetQuantum() const
 }
 
 uint32_t
-SchedQueueDisc::SetAssociativeHash(uint32_t flowHash)
+SchedQueueDisc::GetClassForDscp(uint8_t dscp) const
 {
-    NS_LOG_FUNCTION(this << flowHash);
+    NS_LOG_FUNCTION(this << +dscp);
 
-    uint32_t h = (flowHash % m_flows);
-    uint32_t innerHash = h % m_setWays;
-    uint32_t outerHash = h - innerHash;
+    NS_ASSERT_MSG(dscp < 64, "DSCP must be a value between 0 and 63");
+
+    return m_dscpToClass[dscp];
+}
+
+uint32_t
+SchedQueueDisc::SetAssociativeHash(uint32_t cls, uint32_t flowHash)
+{
+    NS_LOG_FUNCTION(this << cls << flowHash);
+
+    uint32_t outerHash = cls * m_flows + (flowHash % (m_flows / m_setWays)) * m_setWays;
+    uint32_t inactive = NO_FLOW;
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
-
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<SchedFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                SchedFlow::INACTIVE)
+        const Flow& flow = m_flowQueues[i];
+        if (flow.status == Flow::INACTIVE)
         {
-            // this queue has not been created yet or is associated with this flow
-            // or is inactive, hence we can use it
-            m_tags[i] = flowHash;
+            inactive = (inactive == NO_FLOW ? i : inactive);
+        }
+        else if (flow.tag == flowHash)
+        {
+            // this queue is in use by this flow
             return i;
         }
     }
 
-    // all the queues of the set are used. Use the first queue of the set
-    m_tags[outerHash] = flowHash;
-    return outerHash;
+    // use the first inactive queue of the set or, if all the queues of the
+    // set are used, the first queue of the set
+    uint32_t index = (inactive != NO_FLOW ? inactive : outerHash);
+    if (m_flowQueues[index].status == Flow::INACTIVE)
+    {
+        m_flowQueues[index].tag = flowHash;
+    }
+    return index;
 }
 
+void
+SchedQueueDisc::PushBack(FlowList& list, uint32_t index)
+{
+    m_flowQueues[index].next = NO_FLOW;
+    if (list.head == NO_FLOW)
+    {
+        list.head = index;
+    }
+    else
+    {
+        m_flowQueues[list.tail].next = index;
+    }
+    list.tail = index;
+}
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-const uint32_t SchedQueueDisc::prio2band[2] = {0,1};
+void
+SchedQueueDisc::PopFront(FlowList& list)
+{
+    list.head = m_flowQueues[list.head].next;
+}
 
 bool
 SchedQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 {
-    
-    // NS_LOG_FUNCTION(this << item);
-
-   
-    // uint32_t band;
-    
-
-
-    // SocketPriorityTag priorityTag;
-    // if (item->GetPacket()->PeekPacketTag(priorityTag))
-    // {
-    //     Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
-    //     const Ipv4Header ipHeader = ipItem->GetHeader();
-    //     if (static_cast<uint32_t>(ipHeader.GetProtocol()) == 6){
-    //         band = 0;
-    //         NS_LOG_LOGIC("Protocol TCP");
-    //     }else{
-    //         band = 1;
-    //         NS_LOG_LOGIC("Protocol UDP");
-    //     }
-
-        
-    // }
-    // else
-    // {
-    //     NS_LOG_DEBUG("Pkt is not filtered");
-
-       
-    // }
-
-    // if (m_flowsIndices.find(band) == m_flowsIndices.end())
-    // {
-       
-    //     AddQueueDiscClass(band);
-
-    //     m_flowsIndices[band] = GetNQueueDiscClasses() - 1;
-    // }
-
-    // NS_ASSERT_MSG(band < GetNQueueDiscClasses(), "Selected band out of range");
-    // bool retval = GetQueueDiscClass(band)->GetQueueDisc()->Enqueue(item);
-
-    // // If Queue::Enqueue fails, QueueDisc::Drop is called by the child queue disc
-    // // because QueueDisc::AddQueueDiscClass sets the drop callback
-
-    // NS_LOG_LOGIC("Number packets band " << band << ": "
-    //                                     << GetQueueDiscClass(band)->GetQueueDisc()->GetNPackets());
-
-    // return retval;
-
-
+    NS_LOG_FUNCTION(this << item);
 
+    uint32_t cls = m_defaultClass;
+    const QueueDiscItem::ClassKey& key = item->GetClassKey();
+    if (key.ip)
+    {
+        cls = m_dscpToClass[key.dscp];
+    }
+    uint32_t flowHash = m_perturbation ? item->Hash(m_perturbation) : key.flowHash;
+    uint32_t index = SetAssociativeHash(cls, flowHash);
+    NS_LOG_LOGIC("Packet assigned to class " << cls << ", flow queue " << index);
+
+    Flow& flow = m_flowQueues[index];
+    SchedClass& schedClass = m_classes[cls];
+    flow.ring.Push(item);
+    PacketEnqueued(item);
+    m_backlog.Update(index, flow.ring.GetNBytes());
+    schedClass.nPackets++;
+    m_nonEmpty |= 1U << cls;
+
+    if (flow.status == Flow::INACTIVE)
+    {
+        flow.status = Flow::NEW_FLOW;
+        flow.deficit = m_quantum;
+        PushBack(schedClass.newFlows, index);
+    }
 
+    NS_LOG_LOGIC("Number packets class " << cls << ": " << schedClass.nPackets);
 
     if (GetCurrentSize() > GetMaxSize())
     {
@@ -279,127 +215,71 @@ SchedQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         SchedDrop();
     }
 
-    NS_LOG_LOGIC("-- Proto item: " << item->GetProtocol());
-    uint8_t priority = 0;
-    SocketPriorityTag priorityTag;
-    
-    Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
-    const Ipv4Header ipHeader = ipItem->GetHeader();
-    
-    NS_LOG_LOGIC("--Header: " << ipHeader);
-    // NS_LOG_LOGIC("Protocol: " << static_cast<uint32_t>(ipHeader.GetProtocol()));
-    // Ipv4Header ipv4Header;
-    // item->GetPacket()->PeekHeader(ipv4Header);
-    // NS_LOG_LOGIC("--Header: " << ipv4Header);
-   
-    
-   
-    // NS_LOG_LOGsIC("Byte It: " << item->GetPacket()->GetByteTagIterator());
-    // uint8_t proto = ipv4Header.GetProtocol();
-    // NS_LOG_LOGIC("-- ++ IPV4 Proto Header: " << static_cast<uint32_t>(proto));
-    // SocketAddresTag tag;
-    // item->GetPacket()->PeekPacketTag(tag);
-     // Create a packet tag that can hold the transport protocol information
-   
-   
-    if (item->GetPacket()->PeekPacketTag(priorityTag)){
-        priority = priorityTag.GetPriority();
-    }
-    NS_LOG_LOGIC("--Type: " << priorityTag.GetTypeId());
-    uint32_t band;
-    
-    if (static_cast<uint32_t>(ipHeader.GetProtocol()) == 6){
-        band = 0;
-        NS_LOG_LOGIC("Protocol TCP");
-    }else{
-        band = 1;
-        NS_LOG_LOGIC("Protocol UDP");
-    }
-    
-    bool retval = GetInternalQueue(band)->Enqueue(item);
-    // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
-    // internal queue because QueueDisc::AddInternalQueue sets the trace callback
-
-    if (!retval)
-    {
-        NS_LOG_WARN("Packet enqueue failed. Check the size of the internal queues");
-    }
-
-    NS_LOG_LOGIC("Number packets band " << band << ": " << GetInternalQueue(band)->GetNPackets());
-
-    return retval;
+    return true;
 }
 
 Ptr<QueueDiscItem>
 SchedQueueDisc::DoDequeue()
 {
-    // NS_LOG_FUNCTION(this);
-
-    // Ptr<QueueDiscItem> item;
-
-    // uint32_t maxQueueSize = 0; // Track the maximum queue size
-    // uint32_t maxQueueIndex = 0; // Track the index of the queue with the maximum size
-
-    // // Iterate through internal queues to find the one with the maximum size
-    // for (uint32_t i = 0; i < GetNInternalQueues(); i++) {
-    //     uint32_t queueSize = GetInternalQueue(i)->GetNPackets(); // You might use GetSize() or GetNBytes() depending on your requirements
-
-    //     // If the current queue has a larger size, update the maximum size and index
-    //     if (queueSize > maxQueueSize) {
-    //         maxQueueSize = queueSize;
-    //         maxQueueIndex = i;
-    //     }
-    // }
-
-    // // Dequeue from the queue with the largest size
-    // if (maxQueueSize > 0) {
-    //     item = GetInternalQueue(maxQueueIndex)->Dequeue();
-    //     NS_LOG_LOGIC("Popped from band " << maxQueueIndex << ": " << item);
-    //     NS_LOG_LOGIC("Number packets band " << maxQueueIndex << ": " << GetInternalQueue(maxQueueIndex)->GetNPackets());
-    // }
-
-    // NS_LOG_LOGIC("Queue empty");
-    // return item;
-
+    NS_LOG_FUNCTION(this);
 
-     NS_LOG_FUNCTION(this);
+    if (!m_nonEmpty)
+    {
+        NS_LOG_LOGIC("Queue empty");
+        return nullptr;
+    }
 
-    Ptr<QueueDiscItem> item;
+    uint32_t cls = __builtin_ctz(m_nonEmpty);
+    SchedClass& schedClass = m_classes[cls];
 
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    // every flow queue with packets is in a list, so this ends with a packet
+    while (true)
     {
-        if ((item = GetQueueDiscClass(i)->GetQueueDisc()->Dequeue()))
+        bool isNew = schedClass.newFlows.head != NO_FLOW;
+        FlowList& list = isNew ? schedClass.newFlows : schedClass.oldFlows;
+        uint32_t index = list.head;
+        Flow& flow = m_flowQueues[index];
+
+        if (flow.deficit <= 0)
         {
-            NS_LOG_LOGIC("Popped from band " << i << ": " << item);
-            NS_LOG_LOGIC("Number packets band "
-                         << i << ": " << GetQueueDiscClass(i)->GetQueueDisc()->GetNPackets());
-            return item;
+            NS_LOG_LOGIC("Increase deficit for flow queue " << index);
+            flow.deficit += m_quantum;
+            flow.status = Flow::OLD_FLOW;
+            PopFront(list);
+            PushBack(schedClass.oldFlows, index);
+            continue;
         }
-    }
-
-    NS_LOG_LOGIC("Queue empty");
-    return item;
-}
 
-Ptr<const QueueDiscItem>
-SchedQueueDisc::DoPeek()
-{
-    NS_LOG_FUNCTION(this);
-
-    Ptr<const QueueDiscItem> item;
+        Ptr<QueueDiscItem> item = flow.ring.Pop();
+        if (!item)
+        {
+            PopFront(list);
+            if (isNew && schedClass.oldFlows.head != NO_FLOW)
+            {
+                NS_LOG_LOGIC("Move empty flow queue " << index << " to the old flows");
+                flow.status = Flow::OLD_FLOW;
+                PushBack(schedClass.oldFlows, index);
+            }
+            else
+            {
+                NS_LOG_LOGIC("Set empty flow queue " << index << " inactive");
+                flow.status = Flow::INACTIVE;
+            }
+            continue;
+        }
 
-    for (uint32_t i = 0; i < GetNInternalQueues(); i++)
-    {
-        if ((item = GetInternalQueue(i)->Peek()))
+        PacketDequeued(item);
+        m_backlog.Update(index, flow.ring.GetNBytes());
+        flow.deficit -= item->GetSize();
+        if (--schedClass.nPackets == 0)
         {
-            NS_LOG_LOGIC("Peeked from band " << i << ": " << item);
-            NS_LOG_LOGIC("Number packets band " << i << ": " << GetInternalQueue(i)->GetNPackets());
-            return item;
+            m_nonEmpty &= ~(1U << cls);
         }
-    }
+        RecordClassSojourn(cls, item);
 
-    NS_LOG_LOGIC("Queue empty");
-    return item;
+        NS_LOG_LOGIC("Popped from class " << cls << ", flow queue " << index << ": " << item);
+        return item;
+    }
 }
 
 bool
@@ -418,39 +298,38 @@ SchedQueueDisc::CheckConfig()
         return false;
     }
 
-    if (GetNInternalQueues() == 0)
+    if (GetNInternalQueues() > 0)
     {
-        // create 3 DropTail queues with GetLimit() packets each
-        ObjectFactory factory;
-        factory.SetTypeId("ns3::DropTailQueue<QueueDiscItem>");
-        factory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
-        AddInternalQueue(factory.Create<InternalQueue>());
-        AddInternalQueue(factory.Create<InternalQueue>());
-        AddInternalQueue(factory.Create<InternalQueue>());
-    }
-
-    if (GetNInternalQueues() != 3)
-    {
-        NS_LOG_ERROR("SchedQueueDisc needs 3 internal queues");
+        NS_LOG_ERROR("SchedQueueDisc cannot have internal queues");
         return false;
     }
 
-    if (GetInternalQueue(0)->GetMaxSize().GetUnit() != QueueSizeUnit::PACKETS ||
-        GetInternalQueue(1)->GetMaxSize().GetUnit() != QueueSizeUnit::PACKETS ||
-        GetInternalQueue(2)->GetMaxSize().GetUnit() != QueueSizeUnit::PACKETS)
+    if (m_flows % m_setWays != 0)
     {
-        NS_LOG_ERROR("SchedQueueDisc needs 3 internal queues operating in packet mode");
+        NS_LOG_ERROR("The number of flow queues must be a multiple of the set ways");
         return false;
     }
 
-    for (uint8_t i = 0; i < 2; i++)
+    uint32_t nClasses = std::max<uint32_t>(2, m_defaultClass + 1);
+    for (const auto& range : m_dscpRanges)
     {
-        if (GetInternalQueue(i)->GetMaxSize() < GetMaxSize())
+        if (range.first > range.last || range.last > 63 || range.band >= MAX_CLASSES)
         {
-            NS_LOG_ERROR(
-                "The capacity of some internal queue(s) is less than the queue disc capacity");
+            NS_LOG_ERROR("Invalid DSCP range " << range.first << " " << range.last << " "
+                                               << range.band);
             return false;
         }
+        nClasses = std::max<uint32_t>(nClasses, range.band + 1);
+    }
+    m_classes.resize(nClasses);
+
+    // fill the table backwards, so that the earlier ranges take precedence
+    m_dscpToClass.fill(m_defaultClass);
+    for (auto range = m_dscpRanges.rbegin(); range != m_dscpRanges.rend(); ++range)
+    {
+        std::fill(m_dscpToClass.begin() + range->first,
+                  m_dscpToClass.begin() + range->last + 1,
+                  range->band);
     }
 
     return true;
@@ -460,49 +339,58 @@ void
 SchedQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
-}
-
-
 
+    for (auto& schedClass : m_classes)
+    {
+        schedClass = {{NO_FLOW, NO_FLOW}, {NO_FLOW, NO_FLOW}, 0};
+    }
+    m_flowQueues.resize(m_classes.size() * m_flows);
+    for (auto& flow : m_flowQueues)
+    {
+        flow.ring.Clear();
+        flow.deficit = 0;
+        flow.status = Flow::INACTIVE;
+        flow.tag = 0;
+        flow.next = NO_FLOW;
+    }
+    m_nonEmpty = 0;
+    m_backlog.Reset(m_flowQueues.size());
+}
 
 uint32_t
 SchedQueueDisc::SchedDrop()
 {
     NS_LOG_FUNCTION(this);
 
-    uint32_t maxBacklog = 0;
-    uint32_t index = 0;
-    Ptr<QueueDisc> qd;
-
-    /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
-    {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
-        if (bytes > maxBacklog)
-        {
-            maxBacklog = bytes;
-            index = i;
-        }
-    }
+    /* Queue is full! Drop packet(s) from the fat flow, tracked by the backlog heap */
+    uint32_t index = m_backlog.GetFattest();
+    uint32_t maxBacklog = m_backlog.GetBacklog(index);
+    Flow& flow = m_flowQueues[index];
+    SchedClass& schedClass = m_classes[index / m_flows];
 
     /* Our goal is to drop half of this fat flow backlog */
     uint32_t len = 0;
     uint32_t count = 0;
     uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
     Ptr<QueueDiscItem> item;
 
     do
     {
         NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
                                                        << " threshold: " << threshold);
-        item = qd->GetInternalQueue(0)->Dequeue();
+        item = flow.ring.Pop();
+        PacketDequeued(item);
         DropAfterDequeue(item, OVERLIMIT_DROP);
         len += item->GetSize();
     } while (++count < m_dropBatchSize && len < threshold);
 
+    schedClass.nPackets -= count;
+    if (schedClass.nPackets == 0)
+    {
+        m_nonEmpty &= ~(1U << (index / m_flows));
+    }
+    m_backlog.Update(index, flow.ring.GetNBytes());
     return index;
 }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
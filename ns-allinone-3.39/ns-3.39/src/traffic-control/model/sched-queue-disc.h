@@ -22,8 +22,14 @@
 #ifndef SCHED_H
 #define SCHED_H
 
+#include "band-attributes.h"
+#include "class-backlog-heap.h"
+#include "class-item-ring.h"
+
 #include "ns3/queue-disc.h"
-#include "ns3/object-factory.h"
+
+#include <array>
+#include <vector>
 
 namespace ns3
 {
@@ -31,137 +37,28 @@ namespace ns3
 /**
  * \ingroup traffic-control
  *
- * Linux pfifo_fast is the default priority queue enabled on Linux
- * systems. Packets are enqueued in three FIFO droptail queues according
- * to three priority bands based on the packet priority.
+ * A two-level queue disc: strict priority among DSCP classes and deficit
+ * round robin among the flows of each class.
  *
- * The system behaves similar to three ns3::DropTail queues operating
- * together, in which packets from higher priority bands are always
- * dequeued before a packet from a lower priority band is dequeued.
+ * Packets are assigned a class through a DSCP table compiled from the
+ * DscpRanges attribute (class 0 being the highest priority); DSCPs outside
+ * every range, and non-IP packets, go to DefaultClass. A bitmap of the
+ * nonempty classes gives the class to serve with a single
+ * count-trailing-zeros.
  *
- * The queue disc capacity, i.e., the maximum number of packets that can
- * be enqueued in the queue disc, is set through the limit attribute, which
- * plays the same role as txqueuelen in Linux. If no internal queue is
- * provided, three DropTail queues having each a capacity equal to limit are
- * created by default. User is allowed to provide queues, but they must be
- * three, operate in packet mode and each have a capacity not less
- * than limit. No packet filter can be provided.
+ * Within a class, the packets of each 5-tuple are queued in a flow queue and
+ * the flow queues are served by DRR with the new and old flow lists of
+ * FqCoDel (without CoDel). The queue disc preallocates Flows flow queues per
+ * class, grouped in sets of SetWays queues: the hash of a flow selects a set,
+ * and the flow gets the queue of the set tagged with its hash or, if none, an
+ * inactive one (or the first of the set if they are all in use). The lookup
+ * hence takes at most SetWays comparisons and allocates nothing. The packets
+ * are stored in a ClassItemRing per flow queue, without child queue discs.
+ *
+ * When the queue disc exceeds its MaxSize, up to half the backlog of the
+ * fattest flow queue (found through a ClassBacklogHeap) is dropped, at most
+ * DropBatchSize packets.
  */
-
-
-
-class SchedFlow : public QueueDiscClass
-{
-  public:
-    /**
-     * \brief Get the type ID.
-     * \return the object TypeId
-     */
-    static TypeId GetTypeId();
-    /**
-     * \brief FqCoDelFlow constructor
-     */
-    SchedFlow();
-
-    ~SchedFlow() override;
-
-    /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
-     */
-    enum FlowStatus
-    {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
-
-    /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
-     */
-    void SetDeficit(uint32_t deficit);
-    /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
-     */
-    int32_t GetDeficit() const;
-    /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
-     */
-    void IncreaseDeficit(int32_t deficit);
-    /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
-     */
-    void SetStatus(FlowStatus status);
-    /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
-     */
-    FlowStatus GetStatus() const;
-    /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
-     */
-    void SetIndex(uint32_t index);
-    /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
-     */
-    uint32_t GetIndex() const;
-
-  private:
-       /**
-     * \brief Drop a packet from the head of the queue with the largest current byte count
-     * \return the index of the queue with the largest current byte count
-     */
-  
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
-    uint32_t m_setWays;  //!< size of a set of queues (used by set associative hash)
-};
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
 class SchedQueueDisc : public QueueDisc
 {
   public:
@@ -172,14 +69,12 @@ class SchedQueueDisc : public QueueDisc
     static TypeId GetTypeId();
     /**
      * \brief SchedQueueDisc constructor
-     *
-     * Creates a queue with a depth of 1000 packets per band by default
      */
     SchedQueueDisc();
 
     ~SchedQueueDisc() override;
 
-     /**
+    /**
      * \brief Set the quantum value.
      *
      * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling
@@ -195,56 +90,109 @@ class SchedQueueDisc : public QueueDisc
      */
     uint32_t GetQuantum() const;
 
+    /**
+     * Get the class assigned to packets with the specified DSCP.
+     *
+     * \param dscp the DSCP of packets (a value between 0 and 63).
+     * \returns the class assigned to packets.
+     */
+    uint32_t GetClassForDscp(uint8_t dscp) const;
 
-     // Reasons for dropping packets
-    static constexpr const char* UNCLASSIFIED_DROP =
-        "Unclassified drop"; //!< No packet filter able to classify packet
-    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    /// The maximum number of classes
+    static constexpr uint32_t MAX_CLASSES = 16;
 
     // Reasons for dropping packets
-    // static constexpr const char* LIMIT_EXCEEDED_DROP =
-    //     "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
+    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
 
   private:
+    /// Index of no flow queue, ending a flow list
+    static constexpr uint32_t NO_FLOW = UINT32_MAX;
+
+    /**
+     * \brief A flow queue
+     */
+    struct Flow
+    {
+        /// The list a flow queue is in
+        enum FlowStatus : uint8_t
+        {
+            INACTIVE,
+            NEW_FLOW,
+            OLD_FLOW
+        };
+
+        ClassItemRing ring; //!< the packets of the flow
+        int32_t deficit;    //!< the deficit of the flow
+        FlowStatus status;  //!< the status of the flow
+        uint32_t tag;       //!< the hash of the flow using the queue
+        uint32_t next;      //!< the next flow queue of the list
+    };
+
     /**
-     * Priority to band map. Values are taken from the prio2band array used by
-     * the Linux pfifo_fast queue disc.
+     * \brief An intrusive FIFO list of flow queues
      */
-    static const uint32_t prio2band[2];
-    
+    struct FlowList
+    {
+        uint32_t head; //!< the first flow queue
+        uint32_t tail; //!< the last flow queue
+    };
+
+    /**
+     * \brief The flow lists of a class
+     */
+    struct SchedClass
+    {
+        FlowList newFlows; //!< the new flows of the class
+        FlowList oldFlows; //!< the old flows of the class
+        uint32_t nPackets; //!< the packets of the class
+    };
+
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
-    Ptr<const QueueDiscItem> DoPeek() override;
     bool CheckConfig() override;
     void InitializeParams() override;
 
-    uint32_t SchedDrop();
     /**
      * Compute the index of the queue for the flow having the given flowHash,
      * according to the set associative hash approach.
      *
+     * \param cls the class of the flow
      * \param flowHash the hash of the flow 5-tuple
      * \return the index of the queue for the given flow
      */
-    uint32_t SetAssociativeHash(uint32_t flowHash);
-    uint32_t m_quantum;              //!< Deficit assigned to flows at each round
-    uint32_t m_flows;                //!< Number of flow queues
-    uint32_t m_setWays;              //!< size of a set of queues (used by set associative hash)
-    uint32_t m_perturbation;         //!< hash perturbation value
-    uint32_t m_dropBatchSize; //!< Max number of packets dropped from the fat flow
-    bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
-    
-    std::list<Ptr<SchedFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<SchedFlow>> m_oldFlows; //!< The list of old flows
-
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::map<uint32_t, uint32_t> m_tags;         //!< Tags used by set associative hash
+    uint32_t SetAssociativeHash(uint32_t cls, uint32_t flowHash);
 
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+    /**
+     * \brief Append a flow queue to a list
+     * \param list the list
+     * \param index the flow queue
+     */
+    void PushBack(FlowList& list, uint32_t index);
 
+    /**
+     * \brief Remove the first flow queue of a nonempty list
+     * \param list the list
+     */
+    void PopFront(FlowList& list);
 
+    /**
+     * \brief Drop packets from the head of the flow queue with the largest byte count
+     * \return the index of the flow queue with the largest byte count
+     */
+    uint32_t SchedDrop();
 
+    DscpRangeList m_dscpRanges;            //!< the DscpRanges attribute
+    uint32_t m_defaultClass;               //!< the class of the DSCPs outside the ranges
+    uint32_t m_quantum;                    //!< Deficit assigned to flows at each round
+    uint32_t m_flows;                      //!< Number of flow queues per class
+    uint32_t m_setWays;                    //!< size of a set of flow queues
+    uint32_t m_perturbation;               //!< hash perturbation value
+    uint32_t m_dropBatchSize;              //!< Max number of packets dropped from the fat flow
+    std::array<uint8_t, 64> m_dscpToClass; //!< the class of each DSCP
+    std::vector<SchedClass> m_classes;     //!< the classes
+    std::vector<Flow> m_flowQueues;        //!< the flow queues, m_flows per class
+    uint32_t m_nonEmpty;                   //!< bitmap of the nonempty classes
+    ClassBacklogHeap m_backlog;            //!< Byte backlog of the flow queues
 };
 
 } // namespace ns3
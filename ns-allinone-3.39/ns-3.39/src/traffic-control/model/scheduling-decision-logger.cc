@@ -0,0 +1,212 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "scheduling-decision-logger.h"
+
+#include "queue-disc.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SchedulingDecisionLogger");
+
+NS_OBJECT_ENSURE_REGISTERED(SchedulingDecisionLogger);
+
+TypeId
+SchedulingDecisionLogger::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SchedulingDecisionLogger")
+            .SetParent<Object>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<SchedulingDecisionLogger>()
+            .AddAttribute("FileName",
+                          "The name of the binary file the decisions are written to",
+                          StringValue("./sim_results/sched-decision.bin"),
+                          MakeStringAccessor(&SchedulingDecisionLogger::m_fileName),
+                          MakeStringChecker())
+            .AddAttribute("BufferSize",
+                          "The number of records of the ring buffer (two halves)",
+                          UintegerValue(1 << 20),
+                          MakeUintegerAccessor(&SchedulingDecisionLogger::m_bufferSize),
+                          MakeUintegerChecker<uint32_t>(2))
+            .AddAttribute("SamplingInterval",
+                          "Log one scheduling decision every N",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&SchedulingDecisionLogger::m_sampling),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+SchedulingDecisionLogger::SchedulingDecisionLogger()
+    : m_decisions(0),
+      m_half(0),
+      m_fill(0),
+      m_toWrite{0, 0},
+      m_file(nullptr),
+      m_stop(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SchedulingDecisionLogger::~SchedulingDecisionLogger()
+{
+    NS_LOG_FUNCTION(this);
+    // the writer thread must not outlive this object, even if it was never disposed
+    Stop();
+}
+
+bool
+SchedulingDecisionLogger::ConnectQueueDisc(Ptr<QueueDisc> qd)
+{
+    NS_LOG_FUNCTION(this << qd);
+    return qd->TraceConnectWithoutContext("SchedulingDecision",
+                                          MakeCallback(&SchedulingDecisionLogger::Log, this));
+}
+
+void
+SchedulingDecisionLogger::Log(uint32_t index, uint32_t size, int32_t deficit, Time timestamp)
+{
+    if (m_decisions++ % m_sampling != 0)
+    {
+        return;
+    }
+
+    if (!m_file)
+    {
+        Start();
+    }
+
+    uint32_t halfSize = m_bufferSize / 2;
+    m_buffer[m_half * halfSize + m_fill] = {timestamp.GetNanoSeconds(), index, size, deficit, 0};
+
+    if (++m_fill == halfSize)
+    {
+        Submit();
+    }
+}
+
+void
+SchedulingDecisionLogger::Flush()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_file)
+    {
+        return;
+    }
+
+    if (m_fill > 0)
+    {
+        Submit();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return m_toWrite[0] == 0 && m_toWrite[1] == 0; });
+    std::fflush(m_file);
+}
+
+void
+SchedulingDecisionLogger::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Stop();
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    Object::DoDispose();
+}
+
+void
+SchedulingDecisionLogger::Start()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_file = std::fopen(m_fileName.c_str(), "wb");
+    NS_ABORT_MSG_IF(!m_file, "Cannot open " << m_fileName);
+
+    m_buffer.resize(2 * (m_bufferSize / 2));
+    m_half = 0;
+    m_fill = 0;
+    m_stop = false;
+    m_writer = std::thread(&SchedulingDecisionLogger::WriterLoop, this);
+}
+
+void
+SchedulingDecisionLogger::Stop()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_file)
+    {
+        return;
+    }
+
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_writer.join();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void
+SchedulingDecisionLogger::Submit()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_toWrite[m_half] = m_fill;
+    m_cond.notify_all();
+
+    // switch to the other half, waiting for the writer thread to release it
+    m_half ^= 1;
+    m_fill = 0;
+    m_cond.wait(lock, [this] { return m_toWrite[m_half] == 0; });
+}
+
+void
+SchedulingDecisionLogger::WriterLoop()
+{
+    uint32_t halfSize = m_bufferSize / 2;
+    // halves are submitted alternately, starting from the first one
+    uint32_t next = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cond.wait(lock, [this, next] { return m_toWrite[next] > 0 || m_stop; });
+        if (m_toWrite[next] == 0)
+        {
+            break;
+        }
+
+        uint32_t count = m_toWrite[next];
+        lock.unlock();
+        std::fwrite(&m_buffer[next * halfSize], sizeof(Record), count, m_file);
+        lock.lock();
+
+        m_toWrite[next] = 0;
+        next ^= 1;
+        m_cond.notify_all();
+    }
+}
+
+} // namespace ns3
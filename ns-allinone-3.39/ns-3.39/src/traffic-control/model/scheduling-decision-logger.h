@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCHEDULING_DECISION_LOGGER_H
+#define SCHEDULING_DECISION_LOGGER_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+class QueueDisc;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Binary sink for the SchedulingDecision trace of the DSCP schedulers
+ *
+ * Every sampled decision is stored as a fixed-size Record in one half of a
+ * ring buffer. When a half is full it is handed to a background thread that
+ * writes it to the file, while the simulation keeps filling the other half.
+ * The simulation only blocks if both halves are full, i.e., if the disk
+ * cannot keep up. Pending records are written when the logger is disposed.
+ *
+ * The file is a plain sequence of Records in host byte order.
+ */
+class SchedulingDecisionLogger : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SchedulingDecisionLogger();
+    ~SchedulingDecisionLogger() override;
+
+    /**
+     * \brief A scheduling decision, as written to the file
+     */
+    struct Record
+    {
+        int64_t timestamp; //!< the time of the decision, in nanoseconds
+        uint32_t index;    //!< the index of the selected class
+        uint32_t size;     //!< the size of the dequeued packet, in bytes
+        int32_t deficit;   //!< the deficit (or weight) of the class after the decision
+        uint32_t reserved; //!< padding, always zero
+    };
+
+    /**
+     * \brief Connect this logger to the SchedulingDecision trace of a queue disc
+     * \param qd the queue disc
+     * \return true if the queue disc has a SchedulingDecision trace source
+     */
+    bool ConnectQueueDisc(Ptr<QueueDisc> qd);
+
+    /**
+     * \brief Trace sink for the SchedulingDecision trace source
+     * \param index the index of the selected class
+     * \param size the size of the dequeued packet
+     * \param deficit the deficit (or weight) of the class after the decision
+     * \param timestamp the time of the decision
+     */
+    void Log(uint32_t index, uint32_t size, int32_t deficit, Time timestamp);
+
+    /**
+     * \brief Write all the pending records and wait until they are on file
+     */
+    void Flush();
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * \brief Open the file and start the writer thread
+     */
+    void Start();
+    /**
+     * \brief Write the pending records, stop the writer thread and close the file
+     */
+    void Stop();
+    /**
+     * \brief Hand the half being filled to the writer thread
+     */
+    void Submit();
+    /**
+     * \brief Body of the writer thread
+     */
+    void WriterLoop();
+
+    std::string m_fileName;    //!< the name of the output file
+    uint32_t m_bufferSize;     //!< the number of records of the ring buffer
+    uint32_t m_sampling;       //!< one decision every m_sampling is logged
+    uint64_t m_decisions;      //!< number of decisions seen so far
+
+    std::vector<Record> m_buffer;   //!< the ring buffer, made of two halves
+    uint32_t m_half;                //!< the half being filled (0 or 1)
+    uint32_t m_fill;                //!< number of records in the half being filled
+    uint32_t m_toWrite[2];          //!< number of records submitted per half (0 if free)
+    std::FILE* m_file;              //!< the output file
+    std::thread m_writer;           //!< the writer thread
+    std::mutex m_mutex;             //!< protects m_toWrite and m_stop
+    std::condition_variable m_cond; //!< signals submitted and written halves
+    bool m_stop;                    //!< true when the writer thread has to exit
+};
+
+} // namespace ns3
+
+#endif /* SCHEDULING_DECISION_LOGGER_H */
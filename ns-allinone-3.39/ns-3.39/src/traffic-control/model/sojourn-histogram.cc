@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "sojourn-histogram.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+SojournHistogram::SojournHistogram()
+    : m_count(0),
+      m_max(0),
+      m_sum(0)
+{
+}
+
+void
+SojournHistogram::Record(Time sojourn)
+{
+    uint64_t value = sojourn.IsStrictlyPositive() ? sojourn.GetNanoSeconds() : 0;
+    uint32_t bucket = BucketOf(value);
+    if (bucket >= m_counts.size())
+    {
+        m_counts.resize(bucket + 1, 0);
+    }
+    m_counts[bucket]++;
+    m_count++;
+    m_max = std::max(m_max, value);
+    m_sum += value;
+}
+
+void
+SojournHistogram::Reset()
+{
+    m_counts.clear();
+    m_count = 0;
+    m_max = 0;
+    m_sum = 0;
+}
+
+uint64_t
+SojournHistogram::GetCount() const
+{
+    return m_count;
+}
+
+Time
+SojournHistogram::GetMax() const
+{
+    return NanoSeconds(m_max);
+}
+
+Time
+SojournHistogram::GetMean() const
+{
+    return m_count ? NanoSeconds(std::llround(m_sum / m_count)) : Time(0);
+}
+
+Time
+SojournHistogram::GetPercentile(double percentile) const
+{
+    NS_ASSERT_MSG(percentile >= 0 && percentile <= 100, "Percentile out of range");
+    if (!m_count)
+    {
+        return Time(0);
+    }
+
+    // the rank of the value, between 1 and m_count
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(percentile / 100 * m_count));
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < m_counts.size(); bucket++)
+    {
+        seen += m_counts[bucket];
+        if (seen >= rank)
+        {
+            return NanoSeconds(std::min(BucketMax(bucket), m_max));
+        }
+    }
+    return NanoSeconds(m_max);
+}
+
+void
+SojournHistogram::Print(std::ostream& os) const
+{
+    os << "count " << m_count << " mean " << GetMean().As(Time::US) << " p50 "
+       << GetPercentile(50).As(Time::US) << " p99 " << GetPercentile(99).As(Time::US)
+       << " p99.9 " << GetPercentile(99.9).As(Time::US) << " max " << GetMax().As(Time::US);
+}
+
+uint32_t
+SojournHistogram::BucketOf(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return value;
+    }
+    // the bits below the SUB_BITS most significant ones are dropped
+    uint32_t shift = 63 - __builtin_clzll(value) - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t
+SojournHistogram::BucketMax(uint32_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    uint32_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t mantissa = bucket % SUB_BUCKETS + SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const SojournHistogram& histogram)
+{
+    histogram.Print(os);
+    return os;
+}
+
+} // namespace ns3
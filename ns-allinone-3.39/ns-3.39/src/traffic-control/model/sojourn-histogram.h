@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SOJOURN_HISTOGRAM_H
+#define SOJOURN_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Log-linear (HDR style) histogram of the sojourn times of a class
+ *
+ * Sojourn times are recorded in nanoseconds. Values below 2^SUB_BITS have a
+ * bucket each; above, every power of two is split in 2^SUB_BITS linear
+ * buckets, so the relative error of a reported percentile is below
+ * 2^-SUB_BITS whatever the magnitude. The bucket array grows up to the
+ * largest recorded value, which keeps idle classes at no memory cost.
+ */
+class SojournHistogram
+{
+  public:
+    SojournHistogram();
+
+    /**
+     * \brief Record a sojourn time
+     * \param sojourn the sojourn time, negative values are recorded as zero
+     */
+    void Record(Time sojourn);
+
+    /**
+     * \brief Forget all the recorded values
+     */
+    void Reset();
+
+    /**
+     * \brief Get the number of recorded values
+     * \return the number of recorded values
+     */
+    uint64_t GetCount() const;
+
+    /**
+     * \brief Get the largest recorded value
+     * \return the exact maximum, zero if nothing was recorded
+     */
+    Time GetMax() const;
+
+    /**
+     * \brief Get the mean of the recorded values
+     * \return the exact mean, zero if nothing was recorded
+     */
+    Time GetMean() const;
+
+    /**
+     * \brief Get a percentile of the recorded values
+     * \param percentile the percentile, between 0 and 100
+     * \return the upper bound of the bucket holding the percentile, never
+     *         above the maximum; zero if nothing was recorded
+     */
+    Time GetPercentile(double percentile) const;
+
+    /**
+     * \brief Print count, mean, maximum and the main percentiles
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    static constexpr uint32_t SUB_BITS = 7;            //!< log2 of the buckets per power of two
+    static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BITS; //!< buckets per power of two
+
+    /**
+     * \brief Get the bucket of a value
+     * \param value the value in nanoseconds
+     * \return the index of the bucket
+     */
+    static uint32_t BucketOf(uint64_t value);
+
+    /**
+     * \brief Get the largest value of a bucket
+     * \param bucket the index of the bucket
+     * \return the value in nanoseconds
+     */
+    static uint64_t BucketMax(uint32_t bucket);
+
+    std::vector<uint64_t> m_counts; //!< the number of values in each bucket
+    uint64_t m_count;               //!< the number of recorded values
+    uint64_t m_max;                 //!< the largest recorded value, in ns
+    double m_sum;                   //!< the sum of the recorded values, in ns
+};
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param os the stream
+ * \param histogram the histogram
+ * \returns a reference to the stream
+ */
+std::ostream& operator<<(std::ostream& os, const SojournHistogram& histogram);
+
+} // namespace ns3
+
+#endif /* SOJOURN_HISTOGRAM_H */
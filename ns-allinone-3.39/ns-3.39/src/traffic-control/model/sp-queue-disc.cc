@@ -7,95 +7,19 @@
 
 #include "sp-queue-disc.h"
 
-
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/object-factory.h"
-#include "ns3/pointer.h"
-#include "ns3/socket.h"
-#include "ns3/ipv4-queue-disc-item.h"
-#include "ns3/net-device-queue-interface.h"
-
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
-#include <iterator>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("SpQueueDisc");
 
-NS_OBJECT_ENSURE_REGISTERED(SpFlow);
-
-TypeId
-SpFlow::GetTypeId()
-{
-    static TypeId tid = TypeId("ns3::SpFlow")
-                            .SetParent<QueueDiscClass>()
-                            .SetGroupName("TrafficControl")
-                            .AddConstructor<SpFlow>();
-    return tid;
-}
-
-SpFlow::SpFlow()
-    : m_deficit(0),
-      m_status(INACTIVE),
-      m_index(0)
-{
-    NS_LOG_FUNCTION(this);
-}
-
-SpFlow::~SpFlow()
-{
-    NS_LOG_FUNCTION(this);
-}
-
-void
-SpFlow::SetDeficit(uint32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit = deficit;
-}
-
-int32_t
-SpFlow::GetDeficit() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_deficit;
-}
-
-void
-SpFlow::IncreaseDeficit(int32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit += deficit;
-}
-
-void
-SpFlow::SetStatus(FlowStatus status)
-{
-    NS_LOG_FUNCTION(this);
-    m_status = status;
-}
-
-SpFlow::FlowStatus
-SpFlow::GetStatus() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_status;
-}
-
-void
-SpFlow::SetIndex(uint32_t index)
-{
-    NS_LOG_FUNCTION(this);
-    m_index = index;
-}
-
-uint32_t
-SpFlow::GetIndex() const
-{
-    return m_index;
-}
-
 NS_OBJECT_ENSURE_REGISTERED(SpQueueDisc);
 
 TypeId
@@ -106,53 +30,38 @@ SpQueueDisc::GetTypeId()
             .SetParent<QueueDisc>()
             .SetGroupName("TrafficControl")
             .AddConstructor<SpQueueDisc>()
-            .AddAttribute("UseEcn",
-                          "True to use ECN (packets are marked instead of being dropped)",
-                          BooleanValue(true),
-                          MakeBooleanAccessor(&SpQueueDisc::m_useEcn),
-                          MakeBooleanChecker())
-    
-            // .AddAttribute("Target",
-            //               "The CoDel algorithm target queue delay for each FQCoDel queue",
-            //               StringValue("5ms"),
-            //               MakeStringAccessor(&SpQueueDisc::m_target),
-            //               MakeStringChecker())
             .AddAttribute("MaxSize",
                           "The maximum number of packets accepted by this queue disc",
                           QueueSizeValue(QueueSize("10240p")),
                           MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
                           MakeQueueSizeChecker())
-            .AddAttribute("Flows",
-                          "The number of queues into which the incoming packets are classified",
-                          UintegerValue(1024),
-                          MakeUintegerAccessor(&SpQueueDisc::m_flows),
-                          MakeUintegerChecker<uint32_t>())
-            .AddAttribute("DropBatchSize",
-                          "The maximum number of packets dropped from the fat flow",
-                          UintegerValue(64),
-                          MakeUintegerAccessor(&SpQueueDisc::m_dropBatchSize),
-                          MakeUintegerChecker<uint32_t>())
-            .AddAttribute("Perturbation",
-                          "The salt used as an additional input to the hash function used to "
-                          "classify packets",
-                          UintegerValue(0),
-                          MakeUintegerAccessor(&SpQueueDisc::m_perturbation),
-                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DscpRanges",
+                          "The band of each range of DSCPs (first last band triples, the "
+                          "earlier ranges taking precedence)",
+                          DscpRangeListValue(DscpRangeList{{40, 47, 0}}),
+                          MakeDscpRangeListAccessor(&SpQueueDisc::m_dscpRanges),
+                          MakeDscpRangeListChecker())
+            .AddAttribute("DefaultBand",
+                          "The band of the DSCPs outside the ranges and of non-IP packets",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&SpQueueDisc::m_defaultBand),
+                          MakeUintegerChecker<uint32_t>(0, MAX_BANDS - 1))
+            .AddAttribute("UseEcn",
+                          "True to CE mark the packets whose sojourn time exceeds the CE "
+                          "threshold of their band",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&SpQueueDisc::m_useEcn),
+                          MakeBooleanChecker())
             .AddAttribute("CeThreshold",
-                          "The FqCoDel CE threshold for marking packets",
+                          "The CE threshold of the bands without their own",
                           TimeValue(Time::Max()),
                           MakeTimeAccessor(&SpQueueDisc::m_ceThreshold),
                           MakeTimeChecker())
-            .AddAttribute("EnableSetAssociativeHash",
-                          "Enable/Disable Set Associative Hash",
-                          BooleanValue(false),
-                          MakeBooleanAccessor(&SpQueueDisc::m_enableSetAssociativeHash),
-                          MakeBooleanChecker())
-            .AddAttribute("SetWays",
-                          "The size of a set of queues (used by set associative hash)",
-                          UintegerValue(8),
-                          MakeUintegerAccessor(&SpQueueDisc::m_setWays),
-                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("CeThresholds",
+                          "The CE threshold of each band, 0 or missing to use CeThreshold",
+                          TimeListValue(TimeList{}),
+                          MakeTimeListAccessor(&SpQueueDisc::m_ceThresholds),
+                          MakeTimeListChecker())
             .AddAttribute("UseL4s",
                           "True to use L4S (only ECT1 packets are marked at CE threshold)",
                           BooleanValue(false),
@@ -163,9 +72,12 @@ SpQueueDisc::GetTypeId()
 
 SpQueueDisc::SpQueueDisc()
     : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
-      m_quantum(0)
+      m_nonEmpty(0)
 {
     NS_LOG_FUNCTION(this);
+    m_dscpToBand.fill(0);
+    m_bands.fill(nullptr);
+    m_bandThresholds.fill(Time::Max());
 }
 
 SpQueueDisc::~SpQueueDisc()
@@ -173,56 +85,45 @@ SpQueueDisc::~SpQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
-void
-SpQueueDisc::SetQuantum(uint32_t quantum)
-{
-    NS_LOG_FUNCTION(this << quantum);
-    m_quantum = quantum;
-}
-
 uint32_t
-SpQueueDisc::GetQuantum() const
+SpQueueDisc::GetBandForDscp(uint8_t dscp) const
 {
-    return m_quantum;
+    NS_LOG_FUNCTION(this << +dscp);
+
+    NS_ASSERT_MSG(dscp < 64, "DSCP must be a value between 0 and 63");
+
+    return m_dscpToBand[dscp];
 }
 
 bool
 SpQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 {
-     NS_LOG_FUNCTION(this << item);
-
-    uint32_t band = 0;
+    NS_LOG_FUNCTION(this << item);
 
-    Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
-    Ipv4Header ipHeader = ipItem->GetHeader();
-
-    // Extract DSCP value from the IP header
-    int dscp = ipHeader.GetDscp();
-
-    // Map DSCP to band
-    // Implement logic for mapping DSCP to bands here according to some RFC
-    if (dscp >= 40 && dscp <= 47)
+    if (GetCurrentSize() + item > GetMaxSize())
     {
-        band = 0;
-       NS_LOG_INFO("DSCP value: " << dscp << " band 1");
-    }else{
-        band = 1;
-        NS_LOG_LOGIC("DSCP value: " << dscp << " band " << band << "- EF");
+        NS_LOG_LOGIC("Queue disc limit exceeded -- dropping packet");
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        return false;
     }
-    
-
 
-    // Ensure that the band is within the range
-    NS_ASSERT_MSG(band < GetNQueueDiscClasses(), "Selected band out of range");
-
-    // Enqueue the packet to the corresponding queue
-    bool retval = GetQueueDiscClass(band)->GetQueueDisc()->Enqueue(item);
+    uint32_t band = m_defaultBand;
+    const QueueDiscItem::ClassKey& key = item->GetClassKey();
+    if (key.ip)
+    {
+        band = m_dscpToBand[key.dscp];
+    }
+    NS_LOG_LOGIC("DSCP " << +key.dscp << " assigned to band " << band);
 
-    // If Queue::Enqueue fails, QueueDisc::Drop is called by the child queue disc
-    // because QueueDisc::AddQueueDiscClass sets the drop callback
+    // If the child queue disc drops the packet, QueueDisc::Drop is called by the
+    // child queue disc because QueueDisc::AddQueueDiscClass sets the drop callback
+    bool retval = m_bands[band]->Enqueue(item);
+    if (retval)
+    {
+        m_nonEmpty |= 1U << band;
+    }
 
-    NS_LOG_LOGIC("Number packets band " << band << ": "
-                                        << GetQueueDiscClass(band)->GetQueueDisc()->GetNPackets());
+    NS_LOG_LOGIC("Number packets band " << band << ": " << m_bands[band]->GetNPackets());
 
     return retval;
 }
@@ -232,47 +133,104 @@ SpQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<QueueDiscItem> item;
+    for (uint32_t bands = m_nonEmpty; bands;)
+    {
+        uint32_t band = __builtin_ctz(bands);
+        bands &= ~(1U << band);
+        Ptr<QueueDiscItem> item = m_bands[band]->Dequeue();
+        if (!m_bands[band]->GetNPackets())
+        {
+            m_nonEmpty &= ~(1U << band);
+        }
+        if (!item)
+        {
+            // the child queue disc holds packets it does not send yet
+            continue;
+        }
 
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+        MarkIfLate(band, item);
+        RecordClassSojourn(band, item);
+        NS_LOG_LOGIC("Popped from band " << band << ": " << item);
+        NS_LOG_LOGIC("Number packets band " << band << ": " << m_bands[band]->GetNPackets());
+        return item;
+    }
+
+    NS_LOG_LOGIC("Queue empty");
+    return nullptr;
+}
+
+Ptr<const QueueDiscItem>
+SpQueueDisc::DoPeek()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (uint32_t bands = m_nonEmpty; bands;)
     {
-    
-        if ((item = GetQueueDiscClass(i)->GetQueueDisc()->Dequeue()))
+        uint32_t band = __builtin_ctz(bands);
+        bands &= ~(1U << band);
+        Ptr<const QueueDiscItem> item = m_bands[band]->Peek();
+        if (item)
         {
-            NS_LOG_INFO("Send from band: "<< i );
-            NS_LOG_LOGIC("Popped from band " << i << ": " << item);
-            NS_LOG_LOGIC("Number packets band "
-                         << i << ": " << GetQueueDiscClass(i)->GetQueueDisc()->GetNPackets());
+            NS_LOG_LOGIC("Peeked from band " << band << ": " << item);
             return item;
         }
     }
 
     NS_LOG_LOGIC("Queue empty");
-   
+    return nullptr;
+}
 
+void
+SpQueueDisc::MarkIfLate(uint32_t band, Ptr<QueueDiscItem> item)
+{
+    if (!m_useEcn || Simulator::Now() - item->GetTimeStamp() <= m_bandThresholds[band])
+    {
+        return;
+    }
 
-    return item;
+    if (m_useL4s)
+    {
+        uint8_t tosByte = 0;
+        if (!item->GetUint8Value(QueueItem::IP_DSFIELD, tosByte) || (tosByte & 0x3) != 1)
+        {
+            return;
+        }
+    }
 
+    if (Mark(item, CE_THRESHOLD_EXCEEDED_MARK))
+    {
+        NS_LOG_LOGIC("Marking due to the CE threshold of band " << band);
+    }
 }
 
 bool
 SpQueueDisc::CheckConfig()
-{   
-
-
+{
     NS_LOG_FUNCTION(this);
     if (GetNInternalQueues() > 0)
     {
-        NS_LOG_ERROR("PrioQueueDisc cannot have internal queues");
+        NS_LOG_ERROR("SpQueueDisc cannot have internal queues");
         return false;
     }
 
+    uint32_t nBands = std::max<uint32_t>(2, m_defaultBand + 1);
+    for (const auto& range : m_dscpRanges)
+    {
+        if (range.first > range.last || range.last > 63 || range.band >= MAX_BANDS)
+        {
+            NS_LOG_ERROR("Invalid DSCP range " << range.first << " " << range.last << " "
+                                               << range.band);
+            return false;
+        }
+        nBands = std::max<uint32_t>(nBands, range.band + 1);
+    }
+
     if (GetNQueueDiscClasses() == 0)
     {
-        // create 3 fifo queue discs
+        // create one fifo queue disc per band
         ObjectFactory factory;
         factory.SetTypeId("ns3::FifoQueueDisc");
-        for (uint8_t i = 0; i < 2; i++)
+        for (uint32_t i = 0; i < nBands; i++)
         {
             Ptr<QueueDisc> qd = factory.Create<QueueDisc>();
             qd->Initialize();
@@ -282,13 +240,40 @@ SpQueueDisc::CheckConfig()
         }
     }
 
-    if (GetNQueueDiscClasses() < 2)
+    if (GetNQueueDiscClasses() < 2 || GetNQueueDiscClasses() > MAX_BANDS)
+    {
+        NS_LOG_ERROR("SpQueueDisc needs between 2 and " << MAX_BANDS << " classes");
+        return false;
+    }
+
+    if (nBands > GetNQueueDiscClasses())
     {
-        NS_LOG_ERROR("PrioQueueDisc needs at least 2 classes");
+        NS_LOG_ERROR("A DSCP is mapped to band " << nBands - 1 << " but there are only "
+                                                 << GetNQueueDiscClasses() << " classes");
         return false;
     }
 
-    
+    if (m_ceThresholds.size() > GetNQueueDiscClasses())
+    {
+        NS_LOG_ERROR("More CE thresholds than classes");
+        return false;
+    }
+
+    if (m_useL4s && !m_useEcn)
+    {
+        NS_LOG_ERROR("Enabling L4S requires ECN");
+        return false;
+    }
+
+    // fill the table backwards, so that the earlier ranges take precedence
+    m_dscpToBand.fill(m_defaultBand);
+    for (auto range = m_dscpRanges.rbegin(); range != m_dscpRanges.rend(); ++range)
+    {
+        std::fill(m_dscpToBand.begin() + range->first,
+                  m_dscpToBand.begin() + range->last + 1,
+                  range->band);
+    }
+
     return true;
 }
 
@@ -297,47 +282,16 @@ SpQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
 
-    m_flowFactory.SetTypeId("ns3::SpFlow");
+    m_nonEmpty = 0;
+    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    {
+        m_bands[i] = PeekPointer(GetQueueDiscClass(i)->GetQueueDisc());
+        m_bandThresholds[i] = m_ceThreshold;
+        if (i < m_ceThresholds.size() && m_ceThresholds[i].IsStrictlyPositive())
+        {
+            m_bandThresholds[i] = m_ceThresholds[i];
+        }
+    }
 }
 
-// uint32_t
-// SpQueueDisc::FqCoDelDrop()
-// {
-//     NS_LOG_FUNCTION(this);
-
-//     uint32_t maxBacklog = 0;
-//     uint32_t index = 0;
-//     Ptr<QueueDisc> qd;
-
-//     /* Queue is full! Find the fat flow and drop packet(s) from it */
-//     for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
-//     {
-//         qd = GetQueueDiscClass(i)->GetQueueDisc();
-//         uint32_t bytes = qd->GetNBytes();
-//         if (bytes > maxBacklog)
-//         {
-//             maxBacklog = bytes;
-//             index = i;
-//         }
-//     }
-
-//     /* Our goal is to drop half of this fat flow backlog */
-//     uint32_t len = 0;
-//     uint32_t count = 0;
-//     uint32_t threshold = maxBacklog >> 1;
-//     qd = GetQueueDiscClass(index)->GetQueueDisc();
-//     Ptr<QueueDiscItem> item;
-
-//     do
-//     {
-//         NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
-//                                                        << " threshold: " << threshold);
-//         item = qd->GetInternalQueue(0)->Dequeue();
-//         DropAfterDequeue(item, OVERLIMIT_DROP);
-//         len += item->GetSize();
-//     } while (++count < m_dropBatchSize && len < threshold);
-
-//     return index;
-// }
-
 } // namespace ns3
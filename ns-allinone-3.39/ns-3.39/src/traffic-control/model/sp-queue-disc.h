@@ -21,11 +21,12 @@
 #ifndef SP_QUEUE_DISC
 #define SP_QUEUE_DISC
 
-#include "ns3/object-factory.h"
+#include "band-attributes.h"
+
+#include "ns3/nstime.h"
 #include "ns3/queue-disc.h"
 
-#include <list>
-#include <map>
+#include <array>
 
 namespace ns3
 {
@@ -33,83 +34,25 @@ namespace ns3
 /**
  * \ingroup traffic-control
  *
- * \brief A flow queue used by the FqCoDel queue disc
- */
-
-class SpFlow : public QueueDiscClass
-{
-  public:
-    /**
-     * \brief Get the type ID.
-     * \return the object TypeId
-     */
-    static TypeId GetTypeId();
-    /**
-     * \brief FqCoDelFlow constructor
-     */
-    SpFlow();
-
-    ~SpFlow() override;
-
-    /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
-     */
-    enum FlowStatus
-    {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
-
-    /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
-     */
-    void SetDeficit(uint32_t deficit);
-    /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
-     */
-    int32_t GetDeficit() const;
-    /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
-     */
-    void IncreaseDeficit(int32_t deficit);
-    /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
-     */
-    void SetStatus(FlowStatus status);
-    /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
-     */
-    FlowStatus GetStatus() const;
-    /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
-     */
-    void SetIndex(uint32_t index);
-    /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
-     */
-    uint32_t GetIndex() const;
-
-  private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
-};
-
-/**
- * \ingroup traffic-control
+ * \brief An N-band strict priority queue disc with sojourn time CE marking
+ *
+ * Packets are assigned a band through a DSCP table compiled from the
+ * DscpRanges attribute (band 0 being the highest priority); DSCPs outside
+ * every range, and non-IP packets, go to DefaultBand. By default (DSCPs 40 to
+ * 47 to band 0, the rest to band 1) one Fifo queue disc is created per band,
+ * unless the user provides child queue discs.
+ *
+ * A bitmap of the nonempty bands is updated on enqueue and dequeue, so the
+ * band to serve is found with a single count-trailing-zeros.
  *
- * \brief A FqCoDel packet queue disc
+ * When UseEcn is true, a dequeued packet which spent more than the CE
+ * threshold of its band (CeThresholds, or CeThreshold for the bands without
+ * one) in the queue disc is CE marked, so that the ECN-capable flows of the
+ * lower bands back off before the higher bands see any queueing. The packet
+ * is sent anyway: packets which are not ECN-capable are neither marked nor
+ * dropped. If UseL4s is true, only the ECT(1) packets are marked. Packets are
+ * only dropped when the queue disc exceeds its MaxSize.
  */
-
 class SpQueueDisc : public QueueDisc
 {
   public:
@@ -119,76 +62,57 @@ class SpQueueDisc : public QueueDisc
      */
     static TypeId GetTypeId();
     /**
-     * \brief FqCoDelQueueDisc constructor
+     * \brief SpQueueDisc constructor
      */
-    SpQueueDisc();/*  */
+    SpQueueDisc();
 
     ~SpQueueDisc() override;
 
     /**
-     * \brief Set the quantum value.
+     * Get the band (class) assigned to packets with the specified DSCP.
      *
-     * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
+     * \param dscp the DSCP of packets (a value between 0 and 63).
+     * \returns the band assigned to packets.
      */
-    void SetQuantum(uint32_t quantum);
+    uint32_t GetBandForDscp(uint8_t dscp) const;
 
-    /**
-     * \brief Get the quantum value.
-     *
-     * \returns The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
-     */
-    uint32_t GetQuantum() const;
+    /// The maximum number of bands
+    static constexpr uint32_t MAX_BANDS = 16;
 
     // Reasons for dropping packets
-    static constexpr const char* UNCLASSIFIED_DROP =
-        "Unclassified drop"; //!< No packet filter able to classify packet
-    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    static constexpr const char* LIMIT_EXCEEDED_DROP =
+        "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
+    // Reasons for marking packets
+    static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
+        "CE threshold exceeded mark"; //!< Sojourn time above the CE threshold of the band
 
   private:
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
+    Ptr<const QueueDiscItem> DoPeek() override;
     bool CheckConfig() override;
     void InitializeParams() override;
 
     /**
-     * \brief Drop a packet from the head of the queue with the largest current byte count
-     * \return the index of the queue with the largest current byte count
+     * \brief CE mark a dequeued packet if it stayed too long in its band
+     * \param band the band of the packet
+     * \param item the packet
      */
-    uint32_t SpDrop();
+    void MarkIfLate(uint32_t band, Ptr<QueueDiscItem> item);
 
-    bool m_useEcn; //!< True if ECN is used (packets are marked instead of being dropped)
-    /**
-     * Compute the index of the queue for the flow having the given flowHash,
-     * according to the set associative hash approach.
-     *
-     * \param flowHash the hash of the flow 5-tuple
-     * \return the index of the queue for the given flow
-     */
-    uint32_t SetAssociativeHash(uint32_t flowHash);
-
-    std::string m_interval;          //!< CoDel interval attribute
-    std::string m_target;            //!< CoDel target attribute
-    uint32_t m_quantum;              //!< Deficit assigned to flows at each round
-    uint32_t m_flows;                //!< Number of flow queues
-    uint32_t m_setWays;              //!< size of a set of queues (used by set associative hash)
-    uint32_t m_dropBatchSize;        //!< Max number of packets dropped from the fat flow
-    uint32_t m_perturbation;         //!< hash perturbation value
-    Time m_ceThreshold;              //!< Threshold above which to CE mark
-    bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
-    bool m_useL4s; //!< True if L4S is used (ECT1 packets are marked at CE threshold)
-
-    std::list<Ptr<SpFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<SpFlow>> m_oldFlows; //!< The list of old flows
-
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::map<uint32_t, uint32_t> m_tags;         //!< Tags used by set associative hash
-
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+    DscpRangeList m_dscpRanges; //!< the DscpRanges attribute
+    uint32_t m_defaultBand;     //!< the band of the DSCPs outside the ranges
+    bool m_useEcn;              //!< True if packets are CE marked above the CE threshold
+    bool m_useL4s;              //!< True if only ECT1 packets are CE marked
+    Time m_ceThreshold;         //!< the CE threshold of the bands without their own
+    TimeList m_ceThresholds;    //!< the CeThresholds attribute
+
+    std::array<uint8_t, 64> m_dscpToBand;         //!< the band of each DSCP
+    std::array<QueueDisc*, MAX_BANDS> m_bands;    //!< the child queue disc of each band
+    std::array<Time, MAX_BANDS> m_bandThresholds; //!< the CE threshold of each band
+    uint32_t m_nonEmpty;                          //!< bitmap of the nonempty bands
 };
 
 } // namespace ns3
 
-#endif /* FQ_CODEL_QUEUE_DISC */
+#endif /* SP_QUEUE_DISC */
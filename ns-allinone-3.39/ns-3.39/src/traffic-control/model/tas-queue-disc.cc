@@ -0,0 +1,261 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tas-queue-disc.h"
+
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TasQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED(TasQueueDisc);
+
+ATTRIBUTE_HELPER_CPP(GateControlList);
+
+std::ostream&
+operator<<(std::ostream& os, const GateControlList& gcl)
+{
+    for (auto it = gcl.begin(); it != gcl.end(); ++it)
+    {
+        os << (it == gcl.begin() ? "" : " ") << it->first << " " << it->second;
+    }
+    return os;
+}
+
+std::istream&
+operator>>(std::istream& is, GateControlList& gcl)
+{
+    Time duration;
+    uint32_t open;
+    while (!(is.eof()))
+    {
+        if (!(is >> duration >> open))
+        {
+            NS_FATAL_ERROR("Incomplete specification ");
+        }
+        gcl.emplace_back(duration, open);
+    }
+    return is;
+}
+
+TypeId
+TasQueueDisc::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TasQueueDisc")
+            .SetParent<PrioQueueDscpDisc>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<TasQueueDisc>()
+            .AddAttribute("GateControlList",
+                          "The cyclic list of entry durations and open gates bitmaps",
+                          GateControlListValue(GateControlList{{MilliSeconds(1), 0xff}}),
+                          MakeGateControlListAccessor(&TasQueueDisc::m_gcl),
+                          MakeGateControlListChecker())
+            .AddAttribute("BaseTime",
+                          "The start time of a cycle of the gate control list",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&TasQueueDisc::m_baseTime),
+                          MakeTimeChecker())
+            .AddAttribute("LinkRate",
+                          "The rate of the link, used by the guard band (0 to disable it)",
+                          DataRateValue(DataRate(0)),
+                          MakeDataRateAccessor(&TasQueueDisc::m_linkRate),
+                          MakeDataRateChecker());
+    return tid;
+}
+
+TasQueueDisc::TasQueueDisc()
+    : m_current(0),
+      m_open(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TasQueueDisc::~TasQueueDisc()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+TasQueueDisc::GetOpenGates() const
+{
+    return m_open;
+}
+
+void
+TasQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_gateEvent.Cancel();
+    m_table.clear();
+    PrioQueueDscpDisc::DoDispose();
+}
+
+uint32_t
+TasQueueDisc::EligibleBands()
+{
+    uint32_t bands = m_nonEmpty & m_open;
+    if (!m_linkRate.GetBitRate())
+    {
+        return bands;
+    }
+
+    // guard band: the frame must be sent entirely before the gate closes
+    Time elapsed = Simulator::Now() - m_changeTime;
+    const GateChangeEntry& change = m_table[m_current];
+    for (uint32_t left = bands; left; left &= left - 1)
+    {
+        uint32_t band = __builtin_ctz(left);
+        if (change.untilClose[band] == Time::Max())
+        {
+            continue;
+        }
+        Ptr<const QueueDiscItem> head = m_bands[band]->Peek();
+        if (head &&
+            elapsed + m_linkRate.CalculateBytesTxTime(head->GetSize()) > change.untilClose[band])
+        {
+            NS_LOG_LOGIC("Band " << band << " held back by the guard band");
+            bands &= ~(1U << band);
+        }
+    }
+    return bands;
+}
+
+Ptr<QueueDiscItem>
+TasQueueDisc::DoDequeue()
+{
+    NS_LOG_FUNCTION(this);
+    return DequeueFrom(EligibleBands());
+}
+
+Ptr<const QueueDiscItem>
+TasQueueDisc::DoPeek()
+{
+    NS_LOG_FUNCTION(this);
+    return PeekFrom(EligibleBands());
+}
+
+bool
+TasQueueDisc::CheckConfig()
+{
+    NS_LOG_FUNCTION(this);
+    if (!PrioQueueDscpDisc::CheckConfig())
+    {
+        return false;
+    }
+
+    if (m_gcl.empty())
+    {
+        NS_LOG_ERROR("The gate control list cannot be empty");
+        return false;
+    }
+
+    uint32_t allBands = (1U << GetNQueueDiscClasses()) - 1;
+    m_table.clear();
+    m_cycle = Seconds(0);
+    for (const auto& [duration, open] : m_gcl)
+    {
+        if (!duration.IsStrictlyPositive())
+        {
+            NS_LOG_ERROR("Invalid gate control list entry duration " << duration);
+            return false;
+        }
+        // the gates of the bands that do not exist are ignored, and
+        // consecutive entries with the same gates make a single change
+        if (m_table.empty() || m_table.back().open != (open & allBands))
+        {
+            m_table.push_back({m_cycle, open & allBands, {}});
+        }
+        m_cycle += duration;
+    }
+
+    // time from each change until each gate closes, Time::Max () if it never does
+    uint32_t n = m_table.size();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        for (uint32_t band = 0; band < MAX_BANDS; band++)
+        {
+            Time until = Seconds(0);
+            uint32_t k = 0;
+            for (; k < n && (m_table[(i + k) % n].open & (1U << band)); k++)
+            {
+                uint32_t j = (i + k) % n;
+                until += (j + 1 < n ? m_table[j + 1].offset : m_cycle) - m_table[j].offset;
+            }
+            m_table[i].untilClose[band] = (k == n ? Time::Max() : until);
+        }
+    }
+
+    return true;
+}
+
+void
+TasQueueDisc::InitializeParams()
+{
+    NS_LOG_FUNCTION(this);
+    PrioQueueDscpDisc::InitializeParams();
+
+    // find the current change from the position in the cycle
+    Time now = Simulator::Now();
+    Time phase = (now - m_baseTime) % m_cycle;
+    if (phase.IsStrictlyNegative())
+    {
+        phase += m_cycle;
+    }
+    m_current = 0;
+    while (m_current + 1 < m_table.size() && m_table[m_current + 1].offset <= phase)
+    {
+        m_current++;
+    }
+    m_changeTime = now - (phase - m_table[m_current].offset);
+    m_open = m_table[m_current].open;
+
+    m_gateEvent.Cancel();
+    if (m_table.size() > 1)
+    {
+        Time next = (m_current + 1 < m_table.size() ? m_table[m_current + 1].offset : m_cycle);
+        m_gateEvent = Simulator::Schedule(next - phase, &TasQueueDisc::GateChange, this);
+    }
+}
+
+void
+TasQueueDisc::GateChange()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_current = (m_current + 1) % m_table.size();
+    m_changeTime = Simulator::Now();
+    uint32_t opened = m_table[m_current].open & ~m_open;
+    m_open = m_table[m_current].open;
+    NS_LOG_LOGIC("Open gates " << m_open);
+
+    Time duration = (m_current + 1 < m_table.size() ? m_table[m_current + 1].offset : m_cycle) -
+                    m_table[m_current].offset;
+    m_gateEvent = Simulator::Schedule(duration, &TasQueueDisc::GateChange, this);
+
+    // frames held back by a closed gate or by the guard band can go now that
+    // their gate opens again; only the root queue disc can restart the transmission
+    QueueDisc* root = GetRootQueueDisc();
+    if ((opened & m_nonEmpty) && root->GetSendCallback())
+    {
+        root->Run();
+    }
+}
+
+} // namespace ns3
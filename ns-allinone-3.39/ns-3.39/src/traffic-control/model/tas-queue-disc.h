@@ -0,0 +1,143 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TAS_QUEUE_DISC_H
+#define TAS_QUEUE_DISC_H
+
+#include "prio-queue-dscp-disc.h"
+
+#include "ns3/attribute-helper.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/// Gate control list: the duration of each entry and the bitmap of the open gates
+typedef std::vector<std::pair<Time, uint32_t>> GateControlList;
+
+/**
+ * \ingroup traffic-control
+ *
+ * The Tas qdisc is a time-aware shaper in the style of IEEE 802.1Qbv. It
+ * classifies packets in bands like PrioQueueDscpDisc, and each band has a
+ * gate that is opened and closed by a cyclic gate control list. The open
+ * bands are served in strict priority order.
+ *
+ * The list is given as pairs of entry duration and open gates bitmap (bit
+ * i for band i), e.g. "35.7us 1 464.3us 254" opens band 0 alone for the
+ * first symbol of a 500 us slot. The cycle starts at BaseTime, which allows
+ * to align it with the slot and symbol timing of the fronthaul traffic.
+ *
+ * The list is compiled into a cyclic table of gate changes: consecutive
+ * entries with the same gates are merged and, for each change and band, the
+ * time until the gate of the band closes is precomputed. A single event is
+ * pending at any time, at the next gate change.
+ *
+ * When LinkRate is set, a guard band prevents a frame from starting unless
+ * its transmission ends before the gate of its band closes; the frame is
+ * held back until the gate opens again.
+ */
+class TasQueueDisc : public PrioQueueDscpDisc
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    /**
+     * \brief TasQueueDisc constructor
+     */
+    TasQueueDisc();
+
+    ~TasQueueDisc() override;
+
+    /**
+     * \brief Get the bitmap of the bands whose gate is currently open
+     * \return the bitmap of the open gates
+     */
+    uint32_t GetOpenGates() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    Ptr<QueueDiscItem> DoDequeue() override;
+    Ptr<const QueueDiscItem> DoPeek() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+
+    /**
+     * \brief Get the open bands whose head frame fits before the gate closes
+     * \return the bitmap of the bands
+     */
+    uint32_t EligibleBands();
+
+    /**
+     * \brief Apply the current gate change and schedule the next one
+     */
+    void GateChange();
+
+    /**
+     * \brief A gate change of the compiled table
+     */
+    struct GateChangeEntry
+    {
+        Time offset;                                //!< the offset of the change in the cycle
+        uint32_t open;                              //!< the bitmap of the open gates
+        std::array<Time, MAX_BANDS> untilClose;     //!< time from the change until each gate closes
+    };
+
+    GateControlList m_gcl;                  //!< the GateControlList attribute
+    Time m_baseTime;                        //!< the start time of a cycle
+    DataRate m_linkRate;                    //!< the link rate, for the guard band
+    std::vector<GateChangeEntry> m_table;   //!< the compiled gate changes
+    Time m_cycle;                           //!< the cycle duration
+    uint32_t m_current;                     //!< the index of the current gate change
+    Time m_changeTime;                      //!< the time of the current gate change
+    uint32_t m_open;                        //!< the bitmap of the open gates
+    EventId m_gateEvent;                    //!< the event of the next gate change
+};
+
+/**
+ * Serialize the gate control list to the given ostream
+ *
+ * \param os
+ * \param gcl
+ *
+ * \return std::ostream
+ */
+std::ostream& operator<<(std::ostream& os, const GateControlList& gcl);
+
+/**
+ * Serialize from the given istream to this gate control list.
+ *
+ * \param is
+ * \param gcl
+ *
+ * \return std::istream
+ */
+std::istream& operator>>(std::istream& is, GateControlList& gcl);
+
+ATTRIBUTE_HELPER_HEADER(GateControlList);
+
+} // namespace ns3
+
+#endif /* TAS_QUEUE_DISC_H */
@@ -415,8 +415,12 @@ TrafficControlLayer::Send(Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
         Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
         NS_ASSERT(qDisc);
-        qDisc->Enqueue(item);
-        qDisc->Run();
+        // an empty queue disc may let the packet go straight to the device
+        if (!qDisc->Bypass(item))
+        {
+            qDisc->Enqueue(item);
+            qDisc->Run();
+        }
     }
 }
 
@@ -8,9 +8,12 @@
 #include "wdrr-queue-disc.h"
 
 
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/object-factory.h"
 #include "ns3/pointer.h"
+#include "ns3/simulator.h"
 #include "ns3/socket.h"
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/net-device-queue-interface.h"
@@ -19,6 +22,7 @@
 // #include "ns3/prio-queue-disc.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 
 namespace ns3
@@ -27,74 +31,6 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("WdrrQueueDisc");
 NS_OBJECT_ENSURE_REGISTERED(WdrrFlow);
 
-ATTRIBUTE_HELPER_CPP(Quantum);
-
-std::ostream&
-operator<<(std::ostream& os, const Quantum& Quantum)
-{
-    std::copy(Quantum.begin(), Quantum.end() - 1, std::ostream_iterator<uint16_t>(os, " "));
-    os << Quantum.back();
-    return os;
-}
-
-std::istream&
-operator>>(std::istream& is, Quantum& Quantum)
-{
-
-    int temp;
-    while(!(is.eof()))
-    {   
-        
-        if (!(is >> temp))
-        {
-            NS_FATAL_ERROR("Incomplete specification ");
-        }
-        
-        Quantum.push_back(temp);
-
-    }
-    return is;
-}
-
-ATTRIBUTE_HELPER_CPP(MapQueue);
-std::ostream&
-operator<<(std::ostream& os, const MapQueue& map2)
-{
-    // Copy all key-value pairs to the out stream except the last pair
-    for (auto it = map2.begin(); it != std::prev(map2.end()); ++it) {
-        std::cout << it->first << std::endl;
-        os << it->first << " " << it->second << " ";
-    }
-    
-    // Copy the last key-value pair
-    if (!map2.empty()) {
-        os << map2.rbegin()->first << " " << map2.rbegin()->second;
-    }
-
-    return os;
-}
-
-std::istream&
-operator>>(std::istream& is, MapQueue& map2)
-{
-
-    int key;
-    int value;
-
-    // Loop to read pairs of data into the map
-    while(!(is.eof())){
-        if(!(is >> key >> value)){
-            std::cout << "error" << std::endl;
-        }
-        map2.insert(std::pair<int, int>(key,value));
-    }
-
-    return is;
-}
-
-
-
-
 TypeId
 WdrrFlow::GetTypeId()
 {
@@ -106,9 +42,6 @@ WdrrFlow::GetTypeId()
 }
 
 WdrrFlow::WdrrFlow()
-    : m_deficit(0),
-      m_status(INACTIVE),
-      m_index(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -118,54 +51,6 @@ WdrrFlow::~WdrrFlow()
     NS_LOG_FUNCTION(this);
 }
 
-void
-WdrrFlow::SetDeficit(uint32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit = deficit;
-}
-
-int32_t
-WdrrFlow::GetDeficit() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_deficit;
-}
-
-void
-WdrrFlow::IncreaseDeficit(int32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit += deficit;
-}
-
-void
-WdrrFlow::SetStatus(FlowStatus status)
-{
-    NS_LOG_FUNCTION(this);
-    m_status = status;
-}
-
-WdrrFlow::FlowStatus
-WdrrFlow::GetStatus() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_status;
-}
-
-void
-WdrrFlow::SetIndex(uint32_t index)
-{
-    NS_LOG_FUNCTION(this);
-    m_index = index;
-}
-
-uint32_t
-WdrrFlow::GetIndex() const
-{
-    return m_index;
-}
-
 NS_OBJECT_ENSURE_REGISTERED(WdrrQueueDisc);
 
 TypeId
@@ -181,11 +66,6 @@ WdrrQueueDisc::GetTypeId()
                           QueueSizeValue(QueueSize("10240p")),
                           MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
                           MakeQueueSizeChecker())
-            .AddAttribute("Flows",
-                          "The number of queues into which the incoming packets are classified",
-                          UintegerValue(1024),
-                          MakeUintegerAccessor(&WdrrQueueDisc::m_flows),
-                          MakeUintegerChecker<uint32_t>())
             .AddAttribute("Quantum",
                           "The quantum to band mapping.",
                           QuantumValue(Quantum{{1486,20000,1486,1486,1486}}),
@@ -196,17 +76,66 @@ WdrrQueueDisc::GetTypeId()
                           UintegerValue(64),
                           MakeUintegerAccessor(&WdrrQueueDisc::m_dropBatchSize),
                           MakeUintegerChecker<uint32_t>())
+            .AddAttribute("ClassMaxSize",
+                          "The maximum size of the queue of each class. A class exceeding it "
+                          "drops the arriving packet. If null, the MaxSize of the queue disc is used",
+                          QueueSizeValue(QueueSize("0p")),
+                          MakeQueueSizeAccessor(&WdrrQueueDisc::m_classMaxSize),
+                          MakeQueueSizeChecker())
+            .AddAttribute("InlineClasses",
+                          "Whether the packets of each class are kept in a ring owned by the "
+                          "queue disc instead of a child FIFO queue disc",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&WdrrQueueDisc::m_inlineClasses),
+                          MakeBooleanChecker())
+            .AddAttribute("Tuner",
+                          "The controller which tunes the quanta at run time, if any",
+                          PointerValue(),
+                          MakePointerAccessor(&WdrrQueueDisc::m_tuner),
+                          MakePointerChecker<QuantumTuner>())
             .AddAttribute("MapQueue",
                           "It can be used in order to map dscp marking with the queues",
                           MapQueueValue(MapQueue{{1, 2},{2, 4}}),
                           MakeMapQueueAccessor(&WdrrQueueDisc::mapuca),
-                          MakeMapQueueChecker());
+                          MakeMapQueueChecker())
+            .AddAttribute("CommittedRate",
+                          "The committed rate of each band. A band with a null (or no) "
+                          "committed rate is not shaped",
+                          RateListValue(RateList{}),
+                          MakeRateListAccessor(&WdrrQueueDisc::m_committedRate),
+                          MakeRateListChecker())
+            .AddAttribute("CommittedBurst",
+                          "The size of the committed bucket of each band, in bytes. "
+                          "If null (or missing), the quantum of the band is used",
+                          QuantumValue(Quantum{}),
+                          MakeQuantumAccessor(&WdrrQueueDisc::m_committedBurst),
+                          MakeQuantumChecker())
+            .AddAttribute("PeakRate",
+                          "The peak rate of each shaped band. A null (or no) peak rate "
+                          "disables the peak bucket of the band",
+                          RateListValue(RateList{}),
+                          MakeRateListAccessor(&WdrrQueueDisc::m_peakRate),
+                          MakeRateListChecker())
+            .AddAttribute("PeakBurst",
+                          "The size of the peak bucket of each band, in bytes. "
+                          "If null (or missing), the quantum of the band is used",
+                          QuantumValue(Quantum{}),
+                          MakeQuantumAccessor(&WdrrQueueDisc::m_peakBurst),
+                          MakeQuantumChecker())
+            .AddAttribute("ShaperTick",
+                          "The granularity of the times at which shaped bands become eligible",
+                          TimeValue(MicroSeconds(1)),
+                          MakeTimeAccessor(&WdrrQueueDisc::m_shaperTick),
+                          MakeTimeChecker())
+            .AddTraceSource("SchedulingDecision",
+                            "Class selected by the scheduler and size of the dequeued packet",
+                            MakeTraceSourceAccessor(&WdrrQueueDisc::m_schedulingDecisionTrace),
+                            "ns3::WdrrQueueDisc::SchedulingDecisionTracedCallback");
     return tid;
 }
 
 WdrrQueueDisc::WdrrQueueDisc()
-    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
-      m_quantum(0)
+    : ClassfulSchedulerQueueDisc<WdrrPolicy>("WdrrQueueDisc", WdrrFlow::GetTypeId())
 {
     NS_LOG_FUNCTION(this);
 }
@@ -216,272 +145,175 @@ WdrrQueueDisc::~WdrrQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
-void
-WdrrQueueDisc::SetQuantum(uint32_t id, uint32_t quantum)
-{
-    NS_LOG_FUNCTION(this << quantum);
-    m_quantum[id] = quantum;
-}
-
-uint32_t
-WdrrQueueDisc::GetQuantum(uint32_t id) const
-{
-    return m_quantum[id];
-}
-
-
-
 bool
-WdrrQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+WdrrQueueDisc::CheckConfig()
 {
-     NS_LOG_FUNCTION(this << item);
-
-    uint32_t band = 0;
-
-    Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
-    Ipv4Header ipHeader = ipItem->GetHeader();
-
-    // Extract DSCP value from the IP header
-    int dscp = ipHeader.GetDscp();
-
-    auto it = mapuca.find(dscp);
-    // If the port is found in the map, assign the corresponding DSCP value
-    if (it != mapuca.end()) {
-        band = it->second;
-        NS_LOG_INFO(band);
-    }else{
-        NS_LOG_INFO("DSCP value unknown - not specified at configuration");
-    }
-
-    Ptr<WdrrFlow> flow;
-    if (m_flowsIndices.find(band) == m_flowsIndices.end())
-    {       
-        Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
-        qd->Initialize();
-        flow = m_flowFactory.Create<WdrrFlow>();
-        NS_LOG_DEBUG("Creating a new flow queue with index");
-        flow->SetIndex(band);
-        flow->SetQueueDisc(qd);
-        AddQueueDiscClass(flow);
-        flow->SetDeficit(m_quantum[flow->GetIndex()]);
-        m_flowsIndices[band] =  GetNQueueDiscClasses() - 1;
-    }
-    else
-    {
-        flow = StaticCast<WdrrFlow>(GetQueueDiscClass(m_flowsIndices[band]));
-    }
+    NS_LOG_FUNCTION(this);
 
-    if (flow->GetStatus() == WdrrFlow::INACTIVE)
+    if (!ClassfulSchedulerQueueDisc<WdrrPolicy>::CheckConfig())
     {
-        flow->SetStatus(WdrrFlow::NEW_FLOW);
-        flow->SetDeficit(m_quantum[flow->GetIndex()]);
-        m_newFlows.push_back(flow);
+        return false;
     }
 
-
-    bool retval = flow->GetQueueDisc()->Enqueue(item);
-
-    if (ipHeader.GetSource()  == "10.1.0.1"){
-        std::cout << "Error" << std::endl;
-    }
-    
-    if (GetCurrentSize() > GetMaxSize())
+    if (m_committedRate.size() > m_quantum.size() || m_peakRate.size() > m_quantum.size())
     {
-        NS_LOG_DEBUG("Overload; enter FqCobaltDrop ()");
-        WdrrDrop();
+        NS_LOG_ERROR("More shaper rates than bands");
+        return false;
     }
-    return retval;
-}
-
-Ptr<QueueDiscItem>
-WdrrQueueDisc::DoDequeue()
-{
-    NS_LOG_FUNCTION(this);
 
-    Ptr<WdrrFlow> flow;
-    Ptr<QueueDiscItem> item;
-    do
+    std::vector<WdrrPolicy::Shaper> shapers(m_quantum.size(), WdrrPolicy::Shaper());
+    bool shaped = false;
+    for (uint32_t band = 0; band < m_committedRate.size(); band++)
     {
-        bool found = false;
-
-        while (!found && !m_newFlows.empty())
-        {
-            flow = m_newFlows.front();
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum[flow->GetIndex()]);
-                flow->SetStatus(WdrrFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
-            }
-            else
-            {
-                NS_LOG_DEBUG("Found a new flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
-            Bufferlog << "New - Queue status: " <<flow->GetIndex() << " " << flow->GetQueueDisc()->GetNPackets()<<std::endl;
-        }
-
-        while (!found && !m_oldFlows.empty())
+        WdrrPolicy::Shaper& shaper = shapers[band];
+        shaper.committedRate = m_committedRate[band];
+        if (!shaper.committedRate.GetBitRate())
         {
-            flow = m_oldFlows.front();
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum[flow->GetIndex()]);
-                m_oldFlows.push_back(flow);
-                m_oldFlows.pop_front();
-            }
-            else
-            {  
-                NS_LOG_DEBUG("Found an old flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
-            Bufferlog << "Old - Queue status: "<<flow->GetIndex() << " " << flow->GetQueueDisc()->GetNPackets()<<std::endl;
+            continue;
         }
-
-        if (!found)
-        {
-            NS_LOG_DEBUG("No flow found to dequeue a packet");
-            return nullptr;
-        }
-
-        item = flow->GetQueueDisc()->Dequeue();
-
-        if (!item)
+        shaped = true;
+        shaper.committedBurst = band < m_committedBurst.size() && m_committedBurst[band] > 0
+                                    ? m_committedBurst[band]
+                                    : m_quantum[band];
+        shaper.peakRate = band < m_peakRate.size() ? m_peakRate[band] : DataRate(0);
+        shaper.peakBurst = band < m_peakBurst.size() && m_peakBurst[band] > 0 ? m_peakBurst[band]
+                                                                              : m_quantum[band];
+        if (shaper.peakRate.GetBitRate() && shaper.peakRate < shaper.committedRate)
         {
-            NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
-            {
-                flow->SetStatus(WdrrFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
-            }
-            else
-            {
-                flow->SetStatus(WdrrFlow::INACTIVE);
-                m_oldFlows.pop_front();
-            }
-        }
-        else
-        {   NS_LOG_INFO("Flow " << flow->GetIndex() << " has been select with deficit " << flow->GetDeficit());
-            NS_LOG_DEBUG("Dequeued packet " << item->GetPacket()->GetSize());
+            NS_LOG_ERROR("The peak rate of band " << band << " is below its committed rate");
+            return false;
         }
-    } while (!item);
-
-    Bufferlog << flow->GetIndex() << " " << item->GetSize() <<std::endl;
-    flow->IncreaseDeficit(item->GetSize() * -1);
-
-    return item;
-
-}
-
-bool
-WdrrQueueDisc::CheckConfig()
-{   
-
-    NS_LOG_FUNCTION(this);
-    if (GetNQueueDiscClasses() > 0)
-    {
-        NS_LOG_ERROR("FqCobaltQueueDisc cannot have classes");
-        return false;
+        NS_LOG_DEBUG("Band " << band << " shaped to " << shaper.committedRate << " ("
+                             << shaper.committedBurst << " B), peak " << shaper.peakRate << " ("
+                             << shaper.peakBurst << " B)");
     }
 
-
-    NS_LOG_FUNCTION(this);
-    if (GetNInternalQueues() > 0)
+    if (shaped && !m_shaperTick.IsStrictlyPositive())
     {
-        NS_LOG_ERROR("WdrrQueueDisc cannot have internal queues");
+        NS_LOG_ERROR("The shaper tick must be positive");
         return false;
     }
 
-     // we are at initialization time. If the user has not set a quantum value,
-    // set the quantum to the MTU of the device (if any)
-    for (int i = 0; i < (int)m_quantum.size(); i++){
-        if (!m_quantum[i])
-        {
-            Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface();
-            Ptr<NetDevice> dev;
-            // if the NetDeviceQueueInterface object is aggregated to a
-            // NetDevice, get the MTU of such NetDevice
-            if (ndqi && (dev = ndqi->GetObject<NetDevice>()))
-            {
-                m_quantum[i] = dev->GetMtu();
-                NS_LOG_DEBUG("Setting the quantum to the MTU of the device: " << m_quantum[i]);
-            }
-
-            if (!m_quantum[i])
-            {
-                NS_LOG_ERROR("The quantum parameter cannot be null");
-                return false;
-            }
-        }
-
-    }
-
-    
-
-
+    m_policy.SetShapers(shaped ? shapers : std::vector<WdrrPolicy::Shaper>(), m_shaperTick);
     return true;
 }
 
-
-uint32_t
-WdrrQueueDisc::WdrrDrop()
+void
+WdrrPolicy::SetShapers(const std::vector<Shaper>& shapers, Time tick)
 {
-    NS_LOG_FUNCTION(this);
+    m_shapers = shapers;
+    m_tick = tick;
+}
 
-    uint32_t maxBacklog = 0;
-    uint32_t index = 0;
-    Ptr<QueueDisc> qd;
+void
+WdrrPolicy::Reset(std::vector<SchedClass>& classes)
+{
+    m_newFlows.Reset(classes.size());
+    m_oldFlows.Reset(classes.size());
 
-    /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    if (m_shapers.empty())
     {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
-        if (bytes > maxBacklog)
-        {
-            maxBacklog = bytes;
-            index = i;
-        }
+        return;
     }
+    NS_ASSERT(m_shapers.size() == classes.size());
 
-    /* Our goal is to drop half of this fat flow backlog */
-    uint32_t len = 0;
-    uint32_t count = 0;
-    uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
-    Ptr<QueueDiscItem> item;
-
-    do
+    Time now = Simulator::Now();
+    for (auto& shaper : m_shapers)
     {
-        NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
-                                                       << " threshold: " << threshold);
-        item = qd->GetInternalQueue(0)->Dequeue();
-        DropAfterDequeue(item, OVERLIMIT_DROP);
-        len += item->GetSize();
-    } while (++count < m_dropBatchSize && len < threshold);
-
-    return index;
+        shaper.committedTokens = shaper.committedBurst;
+        shaper.peakTokens = shaper.peakBurst;
+        shaper.lastRefill = now;
+    }
+    m_wheel.Reset(classes.size(), now.GetTimeStep() / m_tick.GetTimeStep());
 }
 
+bool
+WdrrPolicy::Conforms(uint32_t index, SchedClass& cls)
+{
+    Ptr<const QueueDiscItem> head = cls.Peek();
+    if (!head)
+    {
+        // let the scheduler find out that the class is empty
+        return true;
+    }
 
+    Shaper& shaper = m_shapers[index];
+    Time now = Simulator::Now();
+    double elapsed = (now - shaper.lastRefill).GetSeconds();
+    shaper.lastRefill = now;
+    shaper.committedTokens =
+        std::min<double>(shaper.committedBurst,
+                         shaper.committedTokens + shaper.committedRate.GetBitRate() * elapsed / 8);
+    if (shaper.peakRate.GetBitRate())
+    {
+        shaper.peakTokens =
+            std::min<double>(shaper.peakBurst,
+                             shaper.peakTokens + shaper.peakRate.GetBitRate() * elapsed / 8);
+    }
 
-
+    // A full bucket always lets the head packet through, so that packets
+    // larger than the bucket are not stuck; the bucket then goes negative
+    uint32_t size = head->GetSize();
+    return (shaper.committedTokens >= size || shaper.committedTokens >= shaper.committedBurst) &&
+           (!shaper.peakRate.GetBitRate() || shaper.peakTokens >= size ||
+            shaper.peakTokens >= shaper.peakBurst);
+}
 
 void
-WdrrQueueDisc::InitializeParams()
+WdrrPolicy::Park(uint32_t index, SchedClass& cls)
 {
-    NS_LOG_FUNCTION(this);
+    if (!m_newFlows.IsEmpty() && m_newFlows.Front() == index)
+    {
+        m_newFlows.PopFront();
+    }
+    else
+    {
+        m_oldFlows.PopFront();
+    }
+    cls.status = SchedClass::SHAPED;
+
+    // the time the buckets need to hold the head packet (or to be full)
+    const Shaper& shaper = m_shapers[index];
+    uint32_t size = cls.Peek()->GetSize();
+    Time delay = Seconds(0);
+    double missing = std::min<double>(size, shaper.committedBurst) - shaper.committedTokens;
+    if (missing > 0)
+    {
+        delay = shaper.committedRate.CalculateBytesTxTime(std::ceil(missing));
+    }
+    missing = std::min<double>(size, shaper.peakBurst) - shaper.peakTokens;
+    if (shaper.peakRate.GetBitRate() && missing > 0)
+    {
+        delay = std::max(delay, shaper.peakRate.CalculateBytesTxTime(std::ceil(missing)));
+    }
 
-    m_flowFactory.SetTypeId("ns3::WdrrFlow");
-    m_queueDiscFactory.SetTypeId("ns3::FifoQueueDisc");
-    m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
-    Bufferlog.open("./sim_results/sched-wdrr-decision.log", std::fstream::out);
+    int64_t tick = m_tick.GetTimeStep();
+    m_wheel.Schedule(index, ((Simulator::Now() + delay).GetTimeStep() + tick - 1) / tick);
 }
 
+void
+WdrrPolicy::ReleaseShaped(std::vector<SchedClass>& classes)
+{
+    // the wheel is advanced even if empty, so that the classes parked next
+    // are filed relative to the current tick, not to a stale one
+    m_wheel.Advance(Simulator::Now().GetTimeStep() / m_tick.GetTimeStep());
+    for (uint32_t index = m_wheel.PopExpired(); index != ClassTimerWheel::NONE;
+         index = m_wheel.PopExpired())
+    {
+        // back in the round, with the deficit the class had
+        classes[index].status = SchedClass::OLD_CLASS;
+        m_oldFlows.PushBack(index);
+    }
+}
 
+Time
+WdrrPolicy::GetWakeTime() const
+{
+    if (m_shapers.empty() || m_wheel.IsEmpty())
+    {
+        return Time::Max();
+    }
+    return TimeStep(m_wheel.GetNextTick() * m_tick.GetTimeStep());
+}
 
 } // namespace ns3
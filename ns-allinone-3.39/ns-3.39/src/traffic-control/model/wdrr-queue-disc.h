@@ -21,31 +21,25 @@
 #ifndef WDRR_QUEUE_DISC
 #define WDRR_QUEUE_DISC
 
-#include "ns3/object-factory.h"
+#include "active-class-list.h"
+#include "class-timer-wheel.h"
+#include "classful-scheduler-queue-disc.h"
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
 #include "ns3/queue-disc.h"
-#include "ns3/vector.h"
-#include "ns3/attribute.h"
-#include "ns3/object-vector.h"
 
-#include <list>
-#include <map>
 #include <vector>
-#include <array>
-#include <iostream>
-#include <fstream>
 
 namespace ns3
 {
-//defining things
-typedef std::vector<int> Quantum;
-
-typedef std::map<int,int> MapQueue;
-
 
 /**
  * \ingroup traffic-control
  *
  * \brief A flow queue used by the Wdrr queue disc
+ *
+ * The scheduling state of the flow is kept by the queue disc.
  */
 
 class WdrrFlow : public QueueDiscClass
@@ -57,197 +51,257 @@ class WdrrFlow : public QueueDiscClass
      */
     static TypeId GetTypeId();
     /**
-     * \brief FqCoDelFlow constructor
+     * \brief WdrrFlow constructor
      */
     WdrrFlow();
 
     ~WdrrFlow() override;
+};
 
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Weighted deficit round robin scheduling policy
+ *
+ * Each backlogged class gets its quantum of bytes per round. Classes that
+ * become backlogged are served from the list of new classes first.
+ *
+ * A class can also be shaped by a two-rate token bucket: the committed
+ * bucket limits its long-term rate and the optional peak bucket the rate of
+ * its bursts. A class whose head packet does not conform leaves the round
+ * robin and is filed in a timer wheel at the time it conforms again, then
+ * joins the list of old classes with the deficit it had. The classes that are
+ * not shaped cost nothing more.
+ */
+class WdrrPolicy
+{
+  public:
     /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
+     * \brief Two-rate token bucket of a class
      */
-    enum FlowStatus
+    struct Shaper
     {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
+        DataRate committedRate;  //!< the committed rate, 0 if the class is not shaped
+        uint32_t committedBurst; //!< the committed bucket size, in bytes
+        DataRate peakRate;       //!< the peak rate, 0 for a single rate bucket
+        uint32_t peakBurst;      //!< the peak bucket size, in bytes
+        double committedTokens;  //!< the content of the committed bucket, in bytes
+        double peakTokens;       //!< the content of the peak bucket, in bytes
+        Time lastRefill;         //!< the last time tokens were added
     };
 
     /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
+     * \brief Set the shapers of the classes
+     * \param shapers the shaper of each class, or none if no class is shaped
+     * \param tick the granularity of the eligibility times of the classes
      */
-    void SetDeficit(uint32_t deficit);
+    void SetShapers(const std::vector<Shaper>& shapers, Time tick);
+
     /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
+     * \brief Get the quantum of a class configured with a null quantum
+     * \param mtu the MTU of the device, or 0 if unknown
+     * \return the quantum
      */
-    int32_t GetDeficit() const;
+    static uint32_t DefaultQuantum(uint32_t mtu)
+    {
+        return mtu;
+    }
+
     /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
+     * \brief Reset the policy at initialization time
+     * \param classes the classes
      */
-    void IncreaseDeficit(int32_t deficit);
+    void Reset(std::vector<SchedClass>& classes);
+
     /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
+     * \brief Notify the policy that the quantum of a class has changed
+     * \param classes the classes
      */
-    void SetStatus(FlowStatus status);
+    void UpdateWeights(std::vector<SchedClass>& classes)
+    {
+    }
+
     /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
+     * \brief Add a class that became backlogged to the list of new classes
+     * \param index the index of the class
+     * \param cls the class
      */
-    FlowStatus GetStatus() const;
+    void Activate(uint32_t index, SchedClass& cls)
+    {
+        cls.status = SchedClass::NEW_CLASS;
+        cls.deficit = cls.quantum;
+        m_newFlows.PushBack(index);
+    }
+
     /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
+     * \brief Select the class to serve
+     * \param classes the classes
+     * \param index the index of the selected class
+     * \return false if no class is backlogged and eligible
      */
-    void SetIndex(uint32_t index);
+    bool Select(std::vector<SchedClass>& classes, uint32_t& index)
+    {
+        if (m_shapers.empty())
+        {
+            return NextInRound(classes, index);
+        }
+
+        ReleaseShaped(classes);
+        while (NextInRound(classes, index))
+        {
+            if (!m_shapers[index].committedRate.GetBitRate() || Conforms(index, classes[index]))
+            {
+                return true;
+            }
+            Park(index, classes[index]);
+        }
+        return false;
+    }
+
     /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
+     * \brief Handle a selected class that had no packet
+     * \param index the index of the class
+     * \param cls the class
      */
-    uint32_t GetIndex() const;
-
-  private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
-};
-
-/**
- * \ingroup traffic-control
- *
- * \brief A Wdrr packet queue disc
- */
+    void Emptied(uint32_t index, SchedClass& cls)
+    {
+        if (!m_newFlows.IsEmpty())
+        {
+            cls.status = SchedClass::OLD_CLASS;
+            m_oldFlows.PushBack(index);
+            m_newFlows.PopFront();
+        }
+        else
+        {
+            cls.status = SchedClass::INACTIVE;
+            m_oldFlows.PopFront();
+        }
+    }
 
-class WdrrQueueDisc : public QueueDisc
-{
-  public:
     /**
-     * \brief Get the type ID.
-     * \return the object TypeId
+     * \brief Charge a dequeued packet to the deficit of its class
+     * \param index the index of the class
+     * \param cls the class
+     * \param size the size of the packet
      */
-    static TypeId GetTypeId();
+    void Served(uint32_t index, SchedClass& cls, uint32_t size)
+    {
+        cls.deficit -= size;
+        if (!m_shapers.empty())
+        {
+            // the buckets were refilled when the class was selected
+            m_shapers[index].committedTokens -= size;
+            m_shapers[index].peakTokens -= size;
+        }
+    }
+
     /**
-     * \brief FqCoDelQueueDisc constructor
+     * \brief Get the time at which a shaped class may become eligible
+     * \return the time, or Time::Max () if no class is waiting for tokens
      */
-    WdrrQueueDisc();/*  */
-
-    ~WdrrQueueDisc() override;
+    Time GetWakeTime() const;
 
+  private:
     /**
-     * \brief Set the quantum value.
-     *
-     * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
+     * \brief Find the class with a positive deficit at the head of the round
+     * \param classes the classes
+     * \param index the index of the class
+     * \return false if no class is backlogged
      */
-    void SetQuantum(uint32_t id, uint32_t quantum);
-    // uint32_t GetSize (void) const;
-
+    bool NextInRound(std::vector<SchedClass>& classes, uint32_t& index)
+    {
+        while (!m_newFlows.IsEmpty())
+        {
+            SchedClass& cls = classes[m_newFlows.Front()];
+            if (cls.deficit > 0)
+            {
+                index = m_newFlows.Front();
+                return true;
+            }
+            cls.deficit += cls.quantum;
+            cls.status = SchedClass::OLD_CLASS;
+            m_oldFlows.PushBack(m_newFlows.Front());
+            m_newFlows.PopFront();
+        }
+
+        while (!m_oldFlows.IsEmpty())
+        {
+            SchedClass& cls = classes[m_oldFlows.Front()];
+            if (cls.deficit > 0)
+            {
+                index = m_oldFlows.Front();
+                return true;
+            }
+            cls.deficit += cls.quantum;
+            m_oldFlows.RotateFront();
+        }
+        return false;
+    }
 
-    void SetInitialValues(std::vector<int> values);
-  
     /**
-     * \brief Get the quantum value.
-     *
-     * \returns The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
+     * \brief Refill the buckets of a class and check its head packet against them
+     * \param index the index of the class
+     * \param cls the class
+     * \return true if the head packet can be sent
      */
-    uint32_t GetQuantum(uint32_t id) const;
-
-    // Reasons for dropping packets
-    static constexpr const char* UNCLASSIFIED_DROP =
-        "Unclassified drop"; //!< No packet filter able to classify packet
-    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
-
-  private:
-    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
-    Ptr<QueueDiscItem> DoDequeue() override;
-    bool CheckConfig() override;
-    void InitializeParams() override;
+    bool Conforms(uint32_t index, SchedClass& cls);
 
     /**
-     * \brief Drop a packet from the head of the queue with the largest current byte count
-     * \return the index of the queue with the largest current byte count
+     * \brief Take a class at the head of the round out of it until it conforms
+     * \param index the index of the class
+     * \param cls the class
      */
+    void Park(uint32_t index, SchedClass& cls);
 
-    bool m_useEcn; //!< True if ECN is used (packets are marked instead of being dropped)
     /**
-     * Compute the index of the queue for the flow having the given flowHash,
-     * according to the set associative hash approach.
-     *
-     * \param flowHash the hash of the flow 5-tuple
-     * \return the index of the queue for the given flow
+     * \brief Put the classes that conform again back in the round
+     * \param classes the classes
      */
+    void ReleaseShaped(std::vector<SchedClass>& classes);
 
-    std::ofstream Bufferlog;
- 
-    uint32_t WdrrDrop();
-   
-    uint32_t m_flows;                //!< Number of flow queues
-    std::list<Ptr<WdrrFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<WdrrFlow>> m_oldFlows; //!< The list of old flows
-
-    uint32_t m_dropBatchSize;        //!< Max number of packets dropped from the fat flow
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
-
-    Quantum m_quantum; //!< Deficit assigned to flows at each round
-    MapQueue mapuca;
+    ActiveClassList m_newFlows;    //!< The list of new flows
+    ActiveClassList m_oldFlows;    //!< The list of old flows
+    std::vector<Shaper> m_shapers; //!< The shaper of each class, empty if none is shaped
+    ClassTimerWheel m_wheel;       //!< The shaped classes waiting for tokens
+    Time m_tick;                   //!< The granularity of the timer wheel
 };
 
-
 /**
- * Serialize the priomap to the given ostream
- *
- * \param os
- * \param priomap
- *
- * \return std::ostream
- */
-std::ostream& operator<<(std::ostream& os, const Quantum& Quantum);
-
-/**
- * Serialize from the given istream to this priomap.
+ * \ingroup traffic-control
  *
- * \param is
- * \param priomap
+ * \brief A Wdrr packet queue disc
  *
- * \return std::istream
+ * Bands can be shaped with the CommittedRate, CommittedBurst, PeakRate and
+ * PeakBurst attributes (see WdrrPolicy). All the shaped bands share one timer
+ * wheel, so the queue disc has at most one pending event, whatever the number
+ * of shaped bands.
  */
-std::istream& operator>>(std::istream& is, Quantum& Quantum);
-
-ATTRIBUTE_HELPER_HEADER(Quantum);
-
-
 
-/**
- * Serialize the priomap to the given ostream
- *
- * \param os
- * \param priomap
- *
- * \return std::ostream
- */
-std::ostream& operator<<(std::ostream& os, const MapQueue& map2);
+class WdrrQueueDisc : public ClassfulSchedulerQueueDisc<WdrrPolicy>
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    /**
+     * \brief WdrrQueueDisc constructor
+     */
+    WdrrQueueDisc();
 
-/**
- * Serialize from the given istream to this priomap.
- *
- * \param is
- * \param priomap
- *
- * \return std::istream
- */
-std::istream& operator>>(std::istream& is, MapQueue& map2);
+    ~WdrrQueueDisc() override;
 
-ATTRIBUTE_HELPER_HEADER(MapQueue);
+  private:
+    bool CheckConfig() override;
 
+    RateList m_committedRate; //!< the committed rate of each band, 0 if not shaped
+    Quantum m_committedBurst; //!< the committed bucket size of each band
+    RateList m_peakRate;      //!< the peak rate of each band, 0 if none
+    Quantum m_peakBurst;      //!< the peak bucket size of each band
+    Time m_shaperTick;        //!< the granularity of the eligibility times
+};
 
 } // namespace ns3
 
-#endif /* FQ_CODEL_QUEUE_DISC */
+#endif /* WDRR_QUEUE_DISC */
@@ -21,33 +21,22 @@
 #ifndef WFQ_QUEUE_DISC
 #define WFQ_QUEUE_DISC
 
-#include "ns3/object-factory.h"
-#include "ns3/queue-disc.h"
-#include "ns3/vector.h"
-#include "ns3/attribute.h"
-#include "ns3/object-vector.h"
+#include "classful-scheduler-queue-disc.h"
 
+#include "ns3/queue-disc.h"
 
-#include <list>
-#include <map>
+#include <algorithm>
 #include <vector>
-#include <array>
-#include <iostream>
-#include <fstream>
-
 
 namespace ns3
 {
-//defining things
-typedef std::vector<int> Quantum;
-
-typedef std::map<int,int> MapQueue;
-
 
 /**
  * \ingroup traffic-control
  *
  * \brief A flow queue used by the Wfq queue disc
+ *
+ * The scheduling state of the flow is kept by the queue disc.
  */
 
 class WfqFlow : public QueueDiscClass
@@ -59,72 +48,262 @@ class WfqFlow : public QueueDiscClass
      */
     static TypeId GetTypeId();
     /**
-     * \brief FqCoDelFlow constructor
+     * \brief WfqFlow constructor
      */
     WfqFlow();
 
     ~WfqFlow() override;
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Weighted fair queueing scheduling policy
+ *
+ * Every backlogged class carries the virtual start and finish tags of its
+ * head packet. Tags are stamped once, when a packet reaches the head of its
+ * class, using an integer fixed-point step per byte derived from the class
+ * weight (quantum). Backlogged classes are kept in a min-heap keyed by their
+ * head finish tag, so a dequeue costs O(log n) in the number of classes.
+ *
+ * In WFQ mode the smallest finish tag is served and the virtual clock
+ * advances to the finish tag in service (self-clocked WFQ). In WF2Q+ mode
+ * the choice is restricted to classes whose start tag does not exceed the
+ * virtual clock, keeping ineligible classes in a second heap keyed by start
+ * tag. Ties are broken on the class index, so the same input always yields
+ * the same schedule.
+ */
+class WfqPolicy
+{
+  public:
+    /// Fixed-point shift of the virtual tags
+    static constexpr uint32_t TAG_SHIFT = 12;
+
+    WfqPolicy()
+        : m_wf2qPlus(false),
+          m_virtualTime(0)
+    {
+    }
 
     /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
+     * \brief Select WF2Q+ instead of self-clocked WFQ
+     * \param wf2qPlus true for WF2Q+
      */
-    enum FlowStatus
+    void SetWf2qPlus(bool wf2qPlus)
     {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
+        m_wf2qPlus = wf2qPlus;
+    }
 
     /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
+     * \brief Get the quantum of a class configured with a null quantum
+     * \param mtu the MTU of the device, or 0 if unknown
+     * \return the quantum
      */
-    void SetDeficit(uint32_t deficit);
+    static uint32_t DefaultQuantum(uint32_t mtu)
+    {
+        return mtu;
+    }
+
     /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
+     * \brief Reset the policy at initialization time
+     * \param classes the classes
      */
-    int32_t GetDeficit() const;
+    void Reset(std::vector<SchedClass>& classes)
+    {
+        m_virtualTime = 0;
+        m_eligible.clear();
+        m_pending.clear();
+        m_eligible.reserve(classes.size());
+        m_pending.reserve(classes.size());
+        UpdateWeights(classes);
+    }
+
     /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
+     * \brief Compute the tag step of every class from the weights
+     * \param classes the classes
      */
-    void IncreaseDeficit(int32_t deficit);
+    void UpdateWeights(std::vector<SchedClass>& classes)
+    {
+        // Each band advances its virtual clock by (sum of weights / weight) per
+        // byte, so that a band holding the whole link advances it by one per byte
+        uint64_t weightSum = 0;
+        for (const auto& cls : classes)
+        {
+            weightSum += cls.quantum;
+        }
+        for (auto& cls : classes)
+        {
+            cls.tagStep = (weightSum << TAG_SHIFT) / cls.quantum;
+        }
+    }
+
+    /**
+     * \brief Stamp the head packet of a class that became backlogged and schedule it
+     * \param index the index of the class
+     * \param cls the class
+     */
+    void Activate(uint32_t index, SchedClass& cls)
+    {
+        // the head packet starts no earlier than the virtual clock and no
+        // earlier than the last packet of the class
+        cls.status = SchedClass::NEW_CLASS;
+        cls.deficit = cls.quantum;
+        StampHead(cls, std::max(m_virtualTime, cls.finishTag));
+        Schedule(index, cls);
+    }
+
     /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
+     * \brief Select the class to serve and remove it from the heaps
+     * \param classes the classes
+     * \param index the index of the selected class
+     * \return false if no class is backlogged
      */
-    void SetStatus(FlowStatus status);
+    bool Select(std::vector<SchedClass>& classes, uint32_t& index)
+    {
+        if (m_wf2qPlus)
+        {
+            if (m_eligible.empty() && !m_pending.empty())
+            {
+                // the system is never idle while a class is backlogged
+                m_virtualTime = std::max(m_virtualTime, m_pending.front().tag);
+            }
+            while (!m_pending.empty() && m_pending.front().tag <= m_virtualTime)
+            {
+                uint32_t i = m_pending.front().index;
+                std::pop_heap(m_pending.begin(), m_pending.end(), &WfqPolicy::HeapGreater);
+                m_pending.pop_back();
+                m_eligible.push_back({classes[i].finishTag, i});
+                std::push_heap(m_eligible.begin(), m_eligible.end(), &WfqPolicy::HeapGreater);
+            }
+        }
+
+        if (m_eligible.empty())
+        {
+            return false;
+        }
+
+        index = m_eligible.front().index;
+        std::pop_heap(m_eligible.begin(), m_eligible.end(), &WfqPolicy::HeapGreater);
+        m_eligible.pop_back();
+        return true;
+    }
+
     /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
+     * \brief Handle a selected class whose backlog was dropped while waiting
+     * \param index the index of the class
+     * \param cls the class
      */
-    FlowStatus GetStatus() const;
+    void Emptied(uint32_t index, SchedClass& cls)
+    {
+        cls.status = SchedClass::INACTIVE;
+    }
+
     /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
+     * \brief Advance the virtual clock and reschedule the class, if still backlogged
+     * \param index the index of the class
+     * \param cls the class
+     * \param size the size of the packet
      */
-    void SetIndex(uint32_t index);
+    void Served(uint32_t index, SchedClass& cls, uint32_t size)
+    {
+        if (m_wf2qPlus)
+        {
+            m_virtualTime += uint64_t(size) << TAG_SHIFT;
+        }
+        else
+        {
+            m_virtualTime = cls.finishTag;
+        }
+
+        if (cls.GetNPackets() > 0)
+        {
+            // the next packet of the class starts when the previous one finishes
+            StampHead(cls, cls.finishTag);
+            Schedule(index, cls);
+        }
+        else
+        {
+            cls.status = SchedClass::INACTIVE;
+        }
+    }
+
     /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
+     * \brief Get the time at which a class may become eligible
+     * \return Time::Max (), backlogged classes are always eligible
      */
-    uint32_t GetIndex() const;
+    Time GetWakeTime() const
+    {
+        return Time::Max();
+    }
 
   private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
+    /**
+     * \brief Entry of the scheduling heaps
+     */
+    struct HeapEntry
+    {
+        uint64_t tag;   //!< the tag the heap is ordered by
+        uint32_t index; //!< the index of the queue disc class
+    };
+
+    /**
+     * \brief Min-heap ordering on the tag, ties broken on the class index
+     * \param a the first entry
+     * \param b the second entry
+     * \return true if a must be served after b
+     */
+    static bool HeapGreater(const HeapEntry& a, const HeapEntry& b)
+    {
+        return a.tag > b.tag || (a.tag == b.tag && a.index > b.index);
+    }
+
+    /**
+     * \brief Stamp the tags of the head packet of a class
+     * \param cls the class, which must be backlogged
+     * \param start the virtual start tag of the head packet
+     */
+    void StampHead(SchedClass& cls, uint64_t start)
+    {
+        Ptr<const QueueDiscItem> head = cls.Peek();
+        NS_ASSERT(head);
+        cls.startTag = start;
+        cls.finishTag = start + head->GetSize() * cls.tagStep;
+    }
+
+    /**
+     * \brief Insert a backlogged class in the heap it belongs to
+     * \param index the index of the class
+     * \param cls the class
+     */
+    void Schedule(uint32_t index, const SchedClass& cls)
+    {
+        if (m_wf2qPlus && cls.startTag > m_virtualTime)
+        {
+            m_pending.push_back({cls.startTag, index});
+            std::push_heap(m_pending.begin(), m_pending.end(), &WfqPolicy::HeapGreater);
+        }
+        else
+        {
+            m_eligible.push_back({cls.finishTag, index});
+            std::push_heap(m_eligible.begin(), m_eligible.end(), &WfqPolicy::HeapGreater);
+        }
+    }
+
+    bool m_wf2qPlus;                   //!< True for WF2Q+, false for self-clocked WFQ
+    uint64_t m_virtualTime;            //!< Virtual clock, in fixed-point bytes
+    std::vector<HeapEntry> m_eligible; //!< Backlogged classes keyed by finish tag
+    std::vector<HeapEntry> m_pending;  //!< WF2Q+ ineligible classes keyed by start tag
 };
 
 /**
  * \ingroup traffic-control
  *
  * \brief A Wfq packet queue disc
+ *
+ * See WfqPolicy for the scheduling algorithm.
  */
 
-class WfqQueueDisc : public QueueDisc
+class WfqQueueDisc : public ClassfulSchedulerQueueDisc<WfqPolicy>
 {
   public:
     /**
@@ -133,77 +312,28 @@ class WfqQueueDisc : public QueueDisc
      */
     static TypeId GetTypeId();
     /**
-     * \brief FqCoDelQueueDisc constructor
+     * \brief WfqQueueDisc constructor
      */
-    WfqQueueDisc();/*  */
+    WfqQueueDisc();
 
     ~WfqQueueDisc() override;
 
     /**
-     * \brief Set the quantum value.
-     *
-     * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
-     */
-    void SetQuantum(uint32_t id, uint32_t quantum);
-    // uint32_t GetSize (void) const;
-
-
-    void SetInitialValues(std::vector<int> values);
-  
-    /**
-     * \brief Get the quantum value.
-     *
-     * \returns The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
+     * \brief Scheduling mode
      */
-    uint32_t GetQuantum(uint32_t id) const;
-
-    // Reasons for dropping packets
-    static constexpr const char* UNCLASSIFIED_DROP =
-        "Unclassified drop"; //!< No packet filter able to classify packet
-    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    enum WfqMode
+    {
+        WFQ,      //!< Self-clocked WFQ: smallest finish tag first
+        WF2Q_PLUS //!< WF2Q+: smallest finish tag among eligible classes
+    };
 
   private:
-    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
-    Ptr<QueueDiscItem> DoDequeue() override;
     bool CheckConfig() override;
-    void InitializeParams() override;
-
-    /**
-     * \brief Drop a packet from the head of the queue with the largest current byte count
-     * \return the index of the queue with the largest current byte count
-     */
-
-    bool m_useEcn; //!< True if ECN is used (packets are marked instead of being dropped)
-    /**
-     * Compute the index of the queue for the flow having the given flowHash,
-     * according to the set associative hash approach.
-     *
-     * \param flowHash the hash of the flow 5-tuple
-     * \return the index of the queue for the given flow
-     */
 
-    std::ofstream Bufferlog;
-    uint32_t WfqDrop();
-   
-    uint32_t m_flows;                //!< Number of flow queues
-    std::list<Ptr<WfqFlow>> m_Flows; //!< The list of new flows
-    // std::list<Ptr<WfqFlow>> m_oldFlows; //!< The list of old flows
-
-    uint32_t m_dropBatchSize;        //!< Max number of packets dropped from the fat flow
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::vector<Time> queue_tail_time;
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
-
-    Quantum m_quantum; //!< Deficit assigned to flows at each round
-    double m_dataRate;
-    MapQueue mapuca;
+    WfqMode m_mode;    //!< Scheduling mode
+    double m_dataRate; //!< Unused by the virtual clock, kept for configuration compatibility
 };
 
-
-
 } // namespace ns3
 
-#endif /* FQ_CODEL_QUEUE_DISC */
+#endif /* WFQ_QUEUE_DISC */
@@ -21,32 +21,19 @@
 #ifndef WRR_QUEUE_DISC
 #define WRR_QUEUE_DISC
 
-#include "ns3/object-factory.h"
-#include "ns3/queue-disc.h"
-#include "ns3/vector.h"
-#include "ns3/attribute.h"
-#include "ns3/object-vector.h"
-
+#include "wdrr-queue-disc.h"
 
-#include <list>
-#include <map>
-#include <vector>
-#include <array>
-#include <iostream>
-#include <fstream>
+#include "ns3/queue-disc.h"
 
 namespace ns3
 {
-//defining things
-typedef std::vector<int> Quantum;
-
-typedef std::map<int,int> MapQueue;
-
 
 /**
  * \ingroup traffic-control
  *
  * \brief A flow queue used by the Wrr queue disc
+ *
+ * The scheduling state of the flow is kept by the queue disc.
  */
 
 class WrrFlow : public QueueDiscClass
@@ -58,63 +45,43 @@ class WrrFlow : public QueueDiscClass
      */
     static TypeId GetTypeId();
     /**
-     * \brief FqCoDelFlow constructor
+     * \brief WrrFlow constructor
      */
     WrrFlow();
 
     ~WrrFlow() override;
+};
 
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Weighted round robin scheduling policy
+ *
+ * Same rounds as WDRR, but the quantum of a class is a number of packets.
+ */
+class WrrPolicy : public WdrrPolicy
+{
+  public:
     /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
+     * \brief Get the quantum of a class configured with a null quantum
+     * \param mtu the MTU of the device, or 0 if unknown
+     * \return the quantum
      */
-    enum FlowStatus
+    static uint32_t DefaultQuantum(uint32_t mtu)
     {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
+        return 1;
+    }
 
     /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
-     */
-    void SetDeficit(uint32_t deficit);
-    /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
-     */
-    int32_t GetDeficit() const;
-    /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
-     */
-    void IncreaseDeficit(int32_t deficit);
-    /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
-     */
-    void SetStatus(FlowStatus status);
-    /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
+     * \brief Charge a dequeued packet to the deficit of its class
+     * \param index the index of the class
+     * \param cls the class
+     * \param size the size of the packet
      */
-    FlowStatus GetStatus() const;
-    /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
-     */
-    void SetIndex(uint32_t index);
-    /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
-     */
-    uint32_t GetIndex() const;
-
-  private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
+    void Served(uint32_t index, SchedClass& cls, uint32_t size)
+    {
+        cls.deficit -= 1;
+    }
 };
 
 /**
@@ -123,7 +90,7 @@ class WrrFlow : public QueueDiscClass
  * \brief A Wrr packet queue disc
  */
 
-class WrrQueueDisc : public QueueDisc
+class WrrQueueDisc : public ClassfulSchedulerQueueDisc<WrrPolicy>
 {
   public:
     /**
@@ -132,76 +99,13 @@ class WrrQueueDisc : public QueueDisc
      */
     static TypeId GetTypeId();
     /**
-     * \brief FqCoDelQueueDisc constructor
+     * \brief WrrQueueDisc constructor
      */
-    WrrQueueDisc();/*  */
+    WrrQueueDisc();
 
     ~WrrQueueDisc() override;
-
-    /**
-     * \brief Set the quantum value.
-     *
-     * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
-     */
-    void SetQuantum(uint32_t id, uint32_t quantum);
-    // uint32_t GetSize (void) const;
-
-
-    void SetInitialValues(std::vector<int> values);
-  
-    /**
-     * \brief Get the quantum value.
-     *
-     * \returns The number of bytes each queue gets to dequeue on each round of the scheduling
-     * algorithm
-     */
-    uint32_t GetQuantum(uint32_t id) const;
-
-    // Reasons for dropping packets
-    static constexpr const char* UNCLASSIFIED_DROP =
-        "Unclassified drop"; //!< No packet filter able to classify packet
-    static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
-
-  private:
-    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
-    Ptr<QueueDiscItem> DoDequeue() override;
-    bool CheckConfig() override;
-    void InitializeParams() override;
-
-    /**
-     * \brief Drop a packet from the head of the queue with the largest current byte count
-     * \return the index of the queue with the largest current byte count
-     */
-
-    bool m_useEcn; //!< True if ECN is used (packets are marked instead of being dropped)
-    /**
-     * Compute the index of the queue for the flow having the given flowHash,
-     * according to the set associative hash approach.
-     *
-     * \param flowHash the hash of the flow 5-tuple
-     * \return the index of the queue for the given flow
-     */
-
-    std::ofstream Bufferlog;
-    uint32_t WrrDrop();
-   
-    uint32_t m_flows;                //!< Number of flow queues
-    std::list<Ptr<WrrFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<WrrFlow>> m_oldFlows; //!< The list of old flows
-
-    uint32_t m_dropBatchSize;        //!< Max number of packets dropped from the fat flow
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
-
-    Quantum m_quantum; //!< Deficit assigned to flows at each round
-    MapQueue mapuca;
 };
 
-
-
 } // namespace ns3
 
-#endif /* FQ_CODEL_QUEUE_DISC */
+#endif /* WRR_QUEUE_DISC */
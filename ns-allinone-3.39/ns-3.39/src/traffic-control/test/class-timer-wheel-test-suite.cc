@@ -0,0 +1,234 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/class-timer-wheel.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Pop all the expired classes of a wheel.
+ * \param wheel The wheel.
+ * \return The indexes of the classes, in the order they were popped.
+ */
+static std::vector<uint32_t>
+PopAll(ClassTimerWheel& wheel)
+{
+    std::vector<uint32_t> expired;
+    for (uint32_t index = wheel.PopExpired(); index != ClassTimerWheel::NONE;
+         index = wheel.PopExpired())
+    {
+        expired.push_back(index);
+    }
+    return expired;
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * Checks that the classes expire in order, at their expiry, and that the
+ * classes filed in the higher levels are cascaded at the start of their slot.
+ */
+class ClassTimerWheelCascadeTestCase : public TestCase
+{
+  public:
+    ClassTimerWheelCascadeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ClassTimerWheelCascadeTestCase::ClassTimerWheelCascadeTestCase()
+    : TestCase("Check the expiry and the cascading of the classes")
+{
+}
+
+void
+ClassTimerWheelCascadeTestCase::DoRun()
+{
+    ClassTimerWheel wheel;
+    wheel.Reset(4, 1000);
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), ClassTimerWheel::NEVER, "The wheel is empty");
+
+    // level 0 (less than 64 ticks away), level 1 and level 2
+    wheel.Schedule(0, 1010);
+    wheel.Schedule(1, 1000 + 200);
+    wheel.Schedule(2, 1000 + 10000);
+    // an expiry which is not in the future expires at the next Advance
+    wheel.Schedule(3, 1000);
+    NS_TEST_EXPECT_MSG_EQ(wheel.IsScheduled(3), true, "An expired class is still in the wheel");
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), 1010, "The first expiry is the next tick");
+
+    wheel.Advance(1005);
+    std::vector<uint32_t> expired = PopAll(wheel);
+    NS_TEST_ASSERT_MSG_EQ(expired.size(), 1, "Only the class due now expires");
+    NS_TEST_EXPECT_MSG_EQ(expired[0], 3, "Wrong expired class");
+
+    wheel.Advance(1010);
+    expired = PopAll(wheel);
+    NS_TEST_ASSERT_MSG_EQ(expired.size(), 1, "The level 0 class expires");
+    NS_TEST_EXPECT_MSG_EQ(expired[0], 0, "Wrong expired class");
+
+    // 1200 is in the level 1 slot starting at 1152, where it is cascaded
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), 1152, "The level 1 slot has to be cascaded");
+    wheel.Advance(1152);
+    NS_TEST_EXPECT_MSG_EQ(PopAll(wheel).size(), 0, "Cascading does not expire the class");
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), 1200, "The class is in level 0 now");
+    wheel.Advance(1199);
+    NS_TEST_EXPECT_MSG_EQ(PopAll(wheel).size(), 0, "No class is due yet");
+    wheel.Advance(1200);
+    expired = PopAll(wheel);
+    NS_TEST_ASSERT_MSG_EQ(expired.size(), 1, "The level 1 class expires");
+    NS_TEST_EXPECT_MSG_EQ(expired[0], 1, "Wrong expired class");
+
+    // a single Advance cascades the level 2 class down and expires it
+    wheel.Advance(20000);
+    expired = PopAll(wheel);
+    NS_TEST_ASSERT_MSG_EQ(expired.size(), 1, "The level 2 class expires");
+    NS_TEST_EXPECT_MSG_EQ(expired[0], 2, "Wrong expired class");
+    NS_TEST_EXPECT_MSG_EQ(wheel.IsEmpty(), true, "The wheel should be empty");
+
+    // an empty wheel follows the time it is advanced to, so that classes
+    // scheduled next are filed relative to it
+    wheel.Advance(50000);
+    wheel.Schedule(0, 50012);
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), 50012, "The wheel clock should be current");
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * Checks that a class beyond the reach of the wheel is parked in the top
+ * level, then filed again until it expires at its expiry.
+ */
+class ClassTimerWheelBeyondReachTestCase : public TestCase
+{
+  public:
+    ClassTimerWheelBeyondReachTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ClassTimerWheelBeyondReachTestCase::ClassTimerWheelBeyondReachTestCase()
+    : TestCase("Check a class beyond the reach of the wheel")
+{
+}
+
+void
+ClassTimerWheelBeyondReachTestCase::DoRun()
+{
+    // four levels of 64 slots reach 2^24 ticks
+    const uint64_t expiry = uint64_t(1) << 30;
+    ClassTimerWheel wheel;
+    wheel.Reset(2, 0);
+    wheel.Schedule(0, expiry);
+    wheel.Schedule(1, 100);
+
+    // the farthest slot of the top level starts at 63 * 2^18 ticks
+    wheel.Advance(100);
+    NS_TEST_EXPECT_MSG_EQ(wheel.PopExpired(), 1, "The near class expires");
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(),
+                          uint64_t(63) << 18,
+                          "The far class is parked in the farthest top slot");
+
+    wheel.Advance(uint64_t(63) << 18);
+    NS_TEST_EXPECT_MSG_EQ(wheel.PopExpired(), ClassTimerWheel::NONE, "Parking does not expire");
+    NS_TEST_EXPECT_MSG_GT(wheel.GetNextTick(), uint64_t(63) << 18, "The class is filed again");
+
+    wheel.Advance(expiry - 1);
+    NS_TEST_EXPECT_MSG_EQ(wheel.PopExpired(), ClassTimerWheel::NONE, "The class is not due yet");
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), expiry, "The class is in the wheel's reach now");
+    wheel.Advance(expiry);
+    NS_TEST_EXPECT_MSG_EQ(wheel.PopExpired(), 0, "The far class expires at its expiry");
+    NS_TEST_EXPECT_MSG_EQ(wheel.IsEmpty(), true, "The wheel should be empty");
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * Checks that cancelled classes, scheduled or already expired, leave the
+ * wheel and can be scheduled again.
+ */
+class ClassTimerWheelCancelTestCase : public TestCase
+{
+  public:
+    ClassTimerWheelCancelTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ClassTimerWheelCancelTestCase::ClassTimerWheelCancelTestCase()
+    : TestCase("Check the cancellation of classes")
+{
+}
+
+void
+ClassTimerWheelCancelTestCase::DoRun()
+{
+    ClassTimerWheel wheel;
+    wheel.Reset(4, 0);
+    // three classes in the same slot, one in a level 1 slot
+    wheel.Schedule(0, 10);
+    wheel.Schedule(1, 10);
+    wheel.Schedule(2, 10);
+    wheel.Schedule(3, 500);
+
+    wheel.Cancel(1);
+    NS_TEST_EXPECT_MSG_EQ(wheel.IsScheduled(1), false, "The cancelled class left the wheel");
+    wheel.Cancel(1);
+    NS_TEST_EXPECT_MSG_EQ(wheel.IsEmpty(), false, "Cancelling twice is harmless");
+
+    // the only class of its slot: the slot is no longer of interest
+    wheel.Cancel(3);
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), 10, "The next tick is the remaining slot");
+
+    wheel.Advance(10);
+    wheel.Cancel(0);
+    std::vector<uint32_t> expired = PopAll(wheel);
+    NS_TEST_ASSERT_MSG_EQ(expired.size(), 1, "A cancelled expired class is not popped");
+    NS_TEST_EXPECT_MSG_EQ(expired[0], 2, "Wrong expired class");
+    NS_TEST_EXPECT_MSG_EQ(wheel.IsEmpty(), true, "The wheel should be empty");
+    NS_TEST_EXPECT_MSG_EQ(wheel.GetNextTick(), ClassTimerWheel::NEVER, "No slot is occupied");
+
+    // a cancelled class can be scheduled again
+    wheel.Schedule(3, 20);
+    wheel.Advance(20);
+    NS_TEST_EXPECT_MSG_EQ(wheel.PopExpired(), 3, "The class scheduled again expires");
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * ClassTimerWheel TestSuite
+ */
+class ClassTimerWheelTestSuite : public TestSuite
+{
+  public:
+    ClassTimerWheelTestSuite();
+};
+
+ClassTimerWheelTestSuite::ClassTimerWheelTestSuite()
+    : TestSuite("class-timer-wheel", UNIT)
+{
+    AddTestCase(new ClassTimerWheelCascadeTestCase, TestCase::QUICK);
+    AddTestCase(new ClassTimerWheelBeyondReachTestCase, TestCase::QUICK);
+    AddTestCase(new ClassTimerWheelCancelTestCase, TestCase::QUICK);
+}
+
+static ClassTimerWheelTestSuite g_classTimerWheelTestSuite; //!< Static variable for test initialization
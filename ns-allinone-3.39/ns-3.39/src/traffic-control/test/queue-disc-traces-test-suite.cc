@@ -24,7 +24,9 @@
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <cstring>
 #include <map>
+#include <string>
 
 using namespace ns3;
 
@@ -583,6 +585,292 @@ QueueDiscTracesTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief Queue Disc Test Item that can be marked
+ */
+class QdMarkableTestItem : public QdTestItem
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param p the packet
+     * \param addr the address
+     */
+    QdMarkableTestItem(Ptr<Packet> p, const Address& addr);
+    bool Mark() override;
+};
+
+QdMarkableTestItem::QdMarkableTestItem(Ptr<Packet> p, const Address& addr)
+    : QdTestItem(p, addr)
+{
+}
+
+bool
+QdMarkableTestItem::Mark()
+{
+    return true;
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief Test Queue Disc that marks every packet and drops the packets
+ *        arriving when two are queued, for a reason held in a buffer
+ */
+class TestReasonQueueDisc : public QueueDisc
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param dropReason the reason why packets are dropped, copied
+     */
+    TestReasonQueueDisc(const char* dropReason);
+    ~TestReasonQueueDisc() override;
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+
+    static constexpr const char* MARK = "Marked on enqueue"; //!< Mark on enqueue
+
+  private:
+    char m_dropReason[32]; //!< the reason why packets are dropped
+};
+
+TestReasonQueueDisc::TestReasonQueueDisc(const char* dropReason)
+    : QueueDisc(QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+{
+    std::strncpy(m_dropReason, dropReason, sizeof(m_dropReason) - 1);
+    m_dropReason[sizeof(m_dropReason) - 1] = '\0';
+}
+
+TestReasonQueueDisc::~TestReasonQueueDisc()
+{
+}
+
+bool
+TestReasonQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+    Mark(item, MARK);
+    if (GetNPackets() >= 2)
+    {
+        DropBeforeEnqueue(item, m_dropReason);
+        return false;
+    }
+    return GetInternalQueue(0)->Enqueue(item);
+}
+
+Ptr<QueueDiscItem>
+TestReasonQueueDisc::DoDequeue()
+{
+    return GetInternalQueue(0)->Dequeue();
+}
+
+bool
+TestReasonQueueDisc::CheckConfig()
+{
+    AddInternalQueue(CreateObject<DropTailQueue<QueueDiscItem>>());
+    return true;
+}
+
+void
+TestReasonQueueDisc::InitializeParams()
+{
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief Test Queue Disc that forwards the packets to the single child queue
+ *        disc added to it
+ */
+class TestForwardingQueueDisc : public QueueDisc
+{
+  public:
+    /**
+     * Constructor
+     */
+    TestForwardingQueueDisc();
+    ~TestForwardingQueueDisc() override;
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+};
+
+TestForwardingQueueDisc::TestForwardingQueueDisc()
+    : QueueDisc(QueueDiscSizePolicy::SINGLE_CHILD_QUEUE_DISC)
+{
+}
+
+TestForwardingQueueDisc::~TestForwardingQueueDisc()
+{
+}
+
+bool
+TestForwardingQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+    return GetQueueDiscClass(0)->GetQueueDisc()->Enqueue(item);
+}
+
+Ptr<QueueDiscItem>
+TestForwardingQueueDisc::DoDequeue()
+{
+    return GetQueueDiscClass(0)->GetQueueDisc()->Dequeue();
+}
+
+bool
+TestForwardingQueueDisc::CheckConfig()
+{
+    return GetNQueueDiscClasses() == 1;
+}
+
+void
+TestForwardingQueueDisc::InitializeParams()
+{
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief Queue Disc Reasons Test Case
+ *
+ * This test case checks the interning of the drop and mark reasons: reasons
+ * passed in buffers map to the identifiers of the same text, and the
+ * statistics of a queue disc, its parent and its grandparent report the drops
+ * and marks through the string getters, with the reason prefixed once per level.
+ */
+class QueueDiscReasonsTestCase : public TestCase
+{
+  public:
+    QueueDiscReasonsTestCase();
+    void DoRun() override;
+
+    /**
+     * Check the drop and mark statistics of a queue disc for given reasons
+     * \param qd the queue disc
+     * \param dropReason the reason of the drops
+     * \param markReason the reason of the marks
+     * \param pktSize the size of the packets
+     */
+    void CheckReasons(Ptr<QueueDisc> qd,
+                      const std::string& dropReason,
+                      const std::string& markReason,
+                      uint32_t pktSize);
+};
+
+QueueDiscReasonsTestCase::QueueDiscReasonsTestCase()
+    : TestCase("Sanity check on the drop and mark reasons")
+{
+}
+
+void
+QueueDiscReasonsTestCase::CheckReasons(Ptr<QueueDisc> qd,
+                                       const std::string& dropReason,
+                                       const std::string& markReason,
+                                       uint32_t pktSize)
+{
+    const QueueDisc::Stats& stats = qd->GetStats();
+
+    NS_TEST_EXPECT_MSG_EQ(stats.GetNDroppedPackets(dropReason),
+                          1,
+                          "Wrong number of packets dropped for " << dropReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.GetNDroppedBytes(dropReason),
+                          pktSize,
+                          "Wrong number of bytes dropped for " << dropReason);
+    NS_TEST_ASSERT_MSG_EQ(stats.nDroppedPacketsBeforeEnqueue.count(dropReason),
+                          1,
+                          "No packet dropped before enqueue for " << dropReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.nDroppedPacketsBeforeEnqueue.at(dropReason),
+                          1,
+                          "Wrong number of packets dropped before enqueue for " << dropReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.nDroppedBytesBeforeEnqueue.at(dropReason),
+                          pktSize,
+                          "Wrong number of bytes dropped before enqueue for " << dropReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.nDroppedPacketsAfterDequeue.count(dropReason),
+                          0,
+                          "No packet was dropped after dequeue for " << dropReason);
+
+    NS_TEST_EXPECT_MSG_EQ(stats.GetNMarkedPackets(markReason),
+                          3,
+                          "Wrong number of packets marked for " << markReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.GetNMarkedBytes(markReason),
+                          3 * pktSize,
+                          "Wrong number of bytes marked for " << markReason);
+    NS_TEST_ASSERT_MSG_EQ(stats.nMarkedPackets.count(markReason),
+                          1,
+                          "No packet marked for " << markReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.nMarkedPackets.at(markReason),
+                          3,
+                          "Wrong number of packets marked for " << markReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.nMarkedBytes.at(markReason),
+                          3 * pktSize,
+                          "Wrong number of bytes marked for " << markReason);
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalMarkedPackets, 3, "Wrong total number of marked packets");
+}
+
+void
+QueueDiscReasonsTestCase::DoRun()
+{
+    Address dest;
+    uint32_t pktSize = 100;
+
+    // a reason held in a buffer maps to the identifier of the same text,
+    // also after the buffer is reused for another reason
+    char buffer[32];
+    std::strcpy(buffer, "Leaf full");
+    QueueDisc::ReasonId id = QueueDisc::GetReasonId("Leaf full");
+    NS_TEST_EXPECT_MSG_EQ(QueueDisc::GetReasonId(buffer), id, "Same text, different identifier");
+    std::strcpy(buffer, "Leaf busy");
+    NS_TEST_EXPECT_MSG_NE(QueueDisc::GetReasonId(buffer), id, "Reused buffer, same identifier");
+    NS_TEST_EXPECT_MSG_EQ(std::string(QueueDisc::GetReasonName(QueueDisc::GetReasonId(buffer))),
+                          "Leaf busy",
+                          "Wrong text of the reason in the reused buffer");
+    std::strcpy(buffer, "Leaf full");
+    NS_TEST_EXPECT_MSG_EQ(QueueDisc::GetReasonId(buffer), id, "Restored buffer, new identifier");
+
+    // root -> mid -> leaf, the leaf dropping for the reason copied from the buffer
+    Ptr<QueueDisc> leaf = CreateObject<TestReasonQueueDisc>(buffer);
+    Ptr<QueueDisc> mid = CreateObject<TestForwardingQueueDisc>();
+    Ptr<QueueDisc> root = CreateObject<TestForwardingQueueDisc>();
+    Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass>();
+    c->SetQueueDisc(leaf);
+    mid->AddQueueDiscClass(c);
+    c = CreateObject<QueueDiscClass>();
+    c->SetQueueDisc(mid);
+    root->AddQueueDiscClass(c);
+    root->Initialize();
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        root->Enqueue(Create<QdMarkableTestItem>(Create<Packet>(pktSize), dest));
+    }
+    NS_TEST_EXPECT_MSG_EQ(root->GetNPackets(), 2, "The third packet should be dropped");
+
+    std::string drop = "Leaf full";
+    std::string mark = TestReasonQueueDisc::MARK;
+    CheckReasons(leaf, drop, mark, pktSize);
+
+    drop = QueueDisc::CHILD_QUEUE_DISC_DROP + drop;
+    mark = QueueDisc::CHILD_QUEUE_DISC_MARK + mark;
+    CheckReasons(mid, drop, mark, pktSize);
+
+    drop = QueueDisc::CHILD_QUEUE_DISC_DROP + drop;
+    mark = QueueDisc::CHILD_QUEUE_DISC_MARK + mark;
+    CheckReasons(root, drop, mark, pktSize);
+    NS_TEST_EXPECT_MSG_EQ(root->GetStats().GetNDroppedPackets(QueueDisc::CHILD_QUEUE_DISC_DROP +
+                                                              std::string("Leaf full")),
+                          0,
+                          "The root should only report the drops with two prefixes");
+
+    root->Dispose();
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup traffic-control-test
  *
@@ -595,5 +883,6 @@ static class QueueDiscTracesTestSuite : public TestSuite
         : TestSuite("queue-disc-traces", UNIT)
     {
         AddTestCase(new QueueDiscTracesTestCase(), TestCase::QUICK);
+        AddTestCase(new QueueDiscReasonsTestCase(), TestCase::QUICK);
     }
 } g_queueDiscTracesTestSuite; ///< the test suite
@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the DSCP classification of the
+// DSCP-mapped schedulers (WDRR, WRR, WFQ), comparing the former two-map lookup
+// against the flat DSCP to class table, read from the IPv4 header or from the
+// classification key cached in the item, and the full enqueue/dequeue path.
+// The traffic mix follows the HQoS scenarios: mostly fronthaul U-plane (CS1),
+// plus EF (46), CS2 and CS3.
+// Sample usage:  ./ns3 run 'bench-dscp-classify --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/string.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/wdrr-queue-disc.h"
+#include "ns3/wfq-queue-disc.h"
+#include "ns3/wrr-queue-disc.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdlib.h> // for exit ()
+#include <vector>
+
+using namespace ns3;
+
+/// DSCP of the packets in the benchmark mix, in arrival order
+static const uint8_t g_dscpMix[] = {46, 8, 8, 8, 8, 8, 8, 16, 16, 24};
+
+/// The MapQueue configured on the schedulers
+static const char* g_mapQueue = "46 0 8 1 16 2 24 3";
+
+/// Packets enqueued before they are all dequeued again
+static const uint32_t g_burst = 64;
+
+/// Sink for computed values, so that the compiler cannot drop the work
+static uint64_t g_sink = 0;
+
+/**
+ * Build a burst of IPv4 queue disc items following the DSCP mix
+ * \return the items
+ */
+static std::vector<Ptr<Ipv4QueueDiscItem>>
+MakeItems()
+{
+    std::vector<Ptr<Ipv4QueueDiscItem>> items;
+    for (uint32_t i = 0; i < g_burst; i++)
+    {
+        Ipv4Header hdr;
+        hdr.SetPayloadSize(1464);
+        hdr.SetProtocol(17);
+        hdr.SetDscp(Ipv4Header::DscpType(g_dscpMix[i % sizeof(g_dscpMix)]));
+        items.push_back(Create<Ipv4QueueDiscItem>(Create<Packet>(1464), Address(), 0, hdr));
+    }
+    return items;
+}
+
+/**
+ * Classify with a DSCP to band map and a band to class map, as the
+ * schedulers did before the flat table
+ * \param n number of packets
+ */
+static void
+benchMapClassify(uint32_t n)
+{
+    std::map<int, int> mapuca = {{46, 0}, {8, 1}, {16, 2}, {24, 3}};
+    std::map<uint32_t, uint32_t> flowsIndices = {{0, 0}, {1, 1}, {2, 2}, {3, 3}};
+    std::vector<Ptr<Ipv4QueueDiscItem>> items = MakeItems();
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<const Ipv4QueueDiscItem> ipItem =
+            DynamicCast<const Ipv4QueueDiscItem>(items[i % g_burst]);
+        Ipv4Header ipHeader = ipItem->GetHeader();
+        uint32_t band = 0;
+        auto it = mapuca.find(ipHeader.GetDscp());
+        if (it != mapuca.end())
+        {
+            band = it->second;
+        }
+        if (flowsIndices.find(band) != flowsIndices.end())
+        {
+            g_sink += flowsIndices[band];
+        }
+    }
+}
+
+/**
+ * Classify with the flat DSCP to class table
+ * \param n number of packets
+ */
+static void
+benchTableClassify(uint32_t n)
+{
+    DscpClassMap table;
+    table.fill(0);
+    table[46] = 0;
+    table[8] = 1;
+    table[16] = 2;
+    table[24] = 3;
+    std::vector<Ptr<Ipv4QueueDiscItem>> items = MakeItems();
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<const Ipv4QueueDiscItem> ipItem =
+            DynamicCast<const Ipv4QueueDiscItem>(items[i % g_burst]);
+        g_sink += table[ipItem->GetHeader().GetDscp()];
+    }
+}
+
+/**
+ * Classify with the flat DSCP to class table, reading the DSCP from the
+ * classification key cached in the item, as every level of a hierarchy does
+ * \param n number of packets
+ */
+static void
+benchKeyClassify(uint32_t n)
+{
+    DscpClassMap table;
+    table.fill(0);
+    table[46] = 0;
+    table[8] = 1;
+    table[16] = 2;
+    table[24] = 3;
+    std::vector<Ptr<Ipv4QueueDiscItem>> items = MakeItems();
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<const QueueDiscItem> item = items[i % g_burst];
+        g_sink += table[item->GetClassKey().dscp];
+    }
+}
+
+/**
+ * Push packets through a scheduler, in bursts
+ * \param qd the queue disc
+ * \param n number of packets
+ */
+static void
+benchQueueDisc(Ptr<QueueDisc> qd, uint32_t n)
+{
+    qd->Initialize();
+    std::vector<Ptr<Ipv4QueueDiscItem>> items = MakeItems();
+
+    for (uint32_t i = 0; i < n; i += g_burst)
+    {
+        for (uint32_t j = 0; j < g_burst; j++)
+        {
+            qd->Enqueue(items[j]);
+        }
+        while (Ptr<QueueDiscItem> item = qd->Dequeue())
+        {
+            g_sink += item->GetSize();
+        }
+    }
+}
+
+/**
+ * Push packets through a WDRR queue disc
+ * \param n number of packets
+ */
+static void
+benchWdrr(uint32_t n)
+{
+    benchQueueDisc(CreateObjectWithAttributes<WdrrQueueDisc>("Quantum",
+                                                             StringValue("1500 9000 3000 1500"),
+                                                             "MapQueue",
+                                                             StringValue(g_mapQueue)),
+                   n);
+}
+
+/**
+ * Push packets through a WRR queue disc
+ * \param n number of packets
+ */
+static void
+benchWrr(uint32_t n)
+{
+    benchQueueDisc(CreateObjectWithAttributes<WrrQueueDisc>("Quantum",
+                                                            StringValue("1 6 2 1"),
+                                                            "MapQueue",
+                                                            StringValue(g_mapQueue)),
+                   n);
+}
+
+/**
+ * Push packets through a WFQ queue disc
+ * \param n number of packets
+ */
+static void
+benchWfq(uint32_t n)
+{
+    benchQueueDisc(CreateObjectWithAttributes<WfqQueueDisc>("Quantum",
+                                                            StringValue("10 60 20 10"),
+                                                            "MapQueue",
+                                                            StringValue(g_mapQueue)),
+                   n);
+}
+
+/**
+ * Run a benchmark and print the cost per packet
+ * \param bench the benchmark function
+ * \param n number of packets
+ * \param minIterations number of runs, the fastest one is reported
+ * \param name the name of the benchmark
+ */
+static void
+runBench(void (*bench)(uint32_t), uint32_t n, uint32_t minIterations, const char* name)
+{
+    uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+    for (uint32_t i = 0; i < minIterations; i++)
+    {
+        SystemWallClockMs time;
+        time.Start();
+        (*bench)(n);
+        minDelay = std::min(minDelay, static_cast<uint64_t>(time.End()));
+    }
+    double nsPerPacket = minDelay * 1e6 / n;
+    std::cout << nsPerPacket << " ns/packet"
+              << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 0;
+    uint32_t minIterations = 1;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark DSCP classification of the DSCP-mapped schedulers");
+    cmd.AddValue("n", "number of packets", n);
+    cmd.AddValue("min-iterations",
+                 "number of subiterations to minimize iteration time over",
+                 minIterations);
+    cmd.Parse(argc, argv);
+
+    if (n == 0)
+    {
+        std::cerr << "Error-- number of packets must be specified "
+                  << "by command-line argument --n=(number of packets)" << std::endl;
+        exit(1);
+    }
+    std::cout << "Running bench-dscp-classify with n=" << n << std::endl;
+
+    runBench(&benchMapClassify, n, minIterations, "Classify: MapQueue + class index maps");
+    runBench(&benchTableClassify, n, minIterations, "Classify: flat DSCP table");
+    runBench(&benchKeyClassify, n, minIterations, "Classify: flat DSCP table, cached key");
+    runBench(&benchWdrr, n, minIterations, "WdrrQueueDisc enqueue/dequeue");
+    runBench(&benchWrr, n, minIterations, "WrrQueueDisc enqueue/dequeue");
+    runBench(&benchWfq, n, minIterations, "WfqQueueDisc enqueue/dequeue");
+
+    std::cout << "(checksum " << g_sink << ")" << std::endl;
+    return 0;
+}
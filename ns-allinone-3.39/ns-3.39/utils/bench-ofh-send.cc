@@ -0,0 +1,276 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the packet creation of the
+// OfhApplication send path: a new packet per send against a copy of a
+// prototype payload, with and without SeqTsSizeHeader, alone and through a
+// UDP/IPv4 stack. It counts the heap allocations per packet (by replacing the
+// global operator new) as well as the time per packet.
+// Sample usage:  ./ns3 run 'bench-ofh-send --n=100000'
+
+#include "ns3/application-container.h"
+#include "ns3/boolean.h"
+#include "ns3/command-line.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ofh-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-size-header.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/uinteger.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// Heap allocations made by the program so far
+static uint64_t g_allocations = 0;
+
+void*
+operator new(std::size_t size)
+{
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/// The size of the U-plane packets
+static const uint32_t g_pktSize = 1464;
+
+/// Sink for computed values, so that the compiler cannot drop the work
+static uint64_t g_sink = 0;
+
+/**
+ * Create a new packet per send
+ * \param n number of packets
+ * \return the number of packets sent
+ */
+static uint64_t
+benchCreate(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> packet = Create<Packet>(g_pktSize);
+        g_sink += packet->GetSize();
+    }
+    return n;
+}
+
+/**
+ * Copy a prototype packet per send
+ * \param n number of packets
+ * \return the number of packets sent
+ */
+static uint64_t
+benchPrototype(uint32_t n)
+{
+    Ptr<Packet> prototype = Create<Packet>(g_pktSize);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> packet = prototype->Copy();
+        g_sink += packet->GetSize();
+    }
+    return n;
+}
+
+/**
+ * Create a new packet with a SeqTsSizeHeader per send
+ * \param n number of packets
+ * \return the number of packets sent
+ */
+static uint64_t
+benchCreateSeqTs(uint32_t n)
+{
+    SeqTsSizeHeader header;
+    header.SetSize(g_pktSize);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        header.SetSeq(i);
+        Ptr<Packet> packet = Create<Packet>(g_pktSize - header.GetSerializedSize());
+        packet->AddHeader(header);
+        g_sink += packet->GetSize();
+    }
+    return n;
+}
+
+/**
+ * Copy a prototype payload and add a SeqTsSizeHeader per send
+ * \param n number of packets
+ * \return the number of packets sent
+ */
+static uint64_t
+benchPrototypeSeqTs(uint32_t n)
+{
+    SeqTsSizeHeader header;
+    header.SetSize(g_pktSize);
+    Ptr<Packet> prototype = Create<Packet>(g_pktSize - header.GetSerializedSize());
+    for (uint32_t i = 0; i < n; i++)
+    {
+        header.SetSeq(i);
+        Ptr<Packet> packet = prototype->Copy();
+        packet->AddHeader(header);
+        g_sink += packet->GetSize();
+    }
+    return n;
+}
+
+/**
+ * Count a packet sent
+ * \param count the counter
+ * \param packet the packet
+ */
+static void
+CountTx(uint64_t* count, Ptr<const Packet> packet)
+{
+    (*count)++;
+}
+
+/**
+ * Send packets from an OfhApplication to a PacketSink through UDP/IPv4
+ * \param n number of packets
+ * \param prototype whether the application sends prototype copies
+ * \return the number of packets sent
+ */
+static uint64_t
+benchApplication(uint32_t n, bool prototype)
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+
+    InetSocketAddress uPlane(interfaces.GetAddress(1), 8080);
+    InetSocketAddress cPlane(interfaces.GetAddress(1), 9090);
+    PacketSinkHelper sinkHelper("ns3::UdpSocketFactory", uPlane);
+    sinkHelper.Install(nodes.Get(1));
+    sinkHelper.SetAttribute("Local", AddressValue(cPlane));
+    sinkHelper.Install(nodes.Get(1));
+
+    // 1 Gb/s of U-plane packets, no C-plane traffic
+    OfhHelper ofhHelper("ns3::UdpSocketFactory");
+    ofhHelper.SetAttribute("U-Plane", AddressValue(uPlane));
+    ofhHelper.SetAttribute("C-Plane", AddressValue(cPlane));
+    ofhHelper.SetAttribute("U-DataRate", StringValue("1Gbps"));
+    ofhHelper.SetAttribute("U-PacketSize", UintegerValue(g_pktSize));
+    ofhHelper.SetAttribute("C-DataRate", StringValue("1bps"));
+    ofhHelper.SetAttribute("PrototypePackets", BooleanValue(prototype));
+    ApplicationContainer apps = ofhHelper.Install(nodes.Get(0));
+    uint64_t count = 0;
+    apps.Get(0)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&CountTx, &count));
+
+    Simulator::Stop(DataRate("1Gbps").CalculateBytesTxTime(g_pktSize) * n);
+    Simulator::Run();
+    Simulator::Destroy();
+    return count;
+}
+
+/**
+ * Send packets created per send through UDP/IPv4
+ * \param n number of packets
+ * \return the number of packets sent
+ */
+static uint64_t
+benchApplicationCreate(uint32_t n)
+{
+    return benchApplication(n, false);
+}
+
+/**
+ * Send prototype copies through UDP/IPv4
+ * \param n number of packets
+ * \return the number of packets sent
+ */
+static uint64_t
+benchApplicationPrototype(uint32_t n)
+{
+    return benchApplication(n, true);
+}
+
+/**
+ * Run a benchmark and print the cost and the allocations per packet
+ * \param bench the benchmark function
+ * \param n number of packets
+ * \param name the name of the benchmark
+ */
+static void
+runBench(uint64_t (*bench)(uint32_t), uint32_t n, const char* name)
+{
+    SystemWallClockMs time;
+    time.Start();
+    uint64_t allocations = g_allocations;
+    uint64_t packets = (*bench)(n);
+    allocations = g_allocations - allocations;
+    uint64_t delay = time.End();
+    std::cout << delay * 1e6 / packets << " ns/packet, "
+              << static_cast<double>(allocations) / packets << " allocations/packet"
+              << " (" << packets << " packets)\t" << name << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the packet creation of the OfhApplication send path");
+    cmd.AddValue("n", "number of packets", n);
+    cmd.Parse(argc, argv);
+
+    if (n == 0)
+    {
+        std::cerr << "Error-- number of packets must be specified "
+                  << "by command-line argument --n=(number of packets)" << std::endl;
+        exit(1);
+    }
+    std::cout << "Running bench-ofh-send with n=" << n << std::endl;
+
+    runBench(&benchCreate, n, "Create<Packet> per send");
+    runBench(&benchPrototype, n, "Prototype copy per send");
+    runBench(&benchCreateSeqTs, n, "Create<Packet> + SeqTsSizeHeader per send");
+    runBench(&benchPrototypeSeqTs, n, "Prototype copy + SeqTsSizeHeader per send");
+    runBench(&benchApplicationCreate, n, "OfhApplication over UDP/IPv4, Create<Packet>");
+    runBench(&benchApplicationPrototype, n, "OfhApplication over UDP/IPv4, PrototypePackets");
+
+    std::cout << "(checksum " << g_sink << ")" << std::endl;
+    return 0;
+}